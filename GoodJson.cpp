@@ -3,11 +3,15 @@
 #include <cstdlib>
 #include <cstring>
 #include <stdio.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
 
 #ifdef _WIN32
 
 #include <windows.h>
 #include <intrin.h>
+#include <io.h>
 
 #pragma intrinsic(_BitScanReverse64)
 
@@ -19,6 +23,207 @@ inline uint32_t gj_Bsr( uint64_t val )
   return found ? (uint32_t)idx : (uint32_t)-1;
 }
 
+//---------------------------------------------------------------------------------
+// val must not be 0
+inline uint32_t gj_Bsf( uint32_t val )
+{
+  DWORD idx;
+  _BitScanForward( &idx, val );
+  return (uint32_t)idx;
+}
+
+//---------------------------------------------------------------------------------
+// returns the low half of a * b, and the high half in out_hi
+inline uint64_t gj_Mul128( uint64_t a, uint64_t b, uint64_t* out_hi )
+{
+#ifdef _M_X64
+  return _umul128( a, b, out_hi );
+#else
+  *out_hi = __umulh( a, b );
+  return a * b;
+#endif
+}
+
+//---------------------------------------------------------------------------------
+// Maps a file read-only. returns nullptr if it can't be opened
+const char* gj_mapFile( const char* path, size_t* out_size )
+{
+  HANDLE file = CreateFileA( path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+  if ( file == INVALID_HANDLE_VALUE )
+  {
+    return nullptr;
+  }
+
+  LARGE_INTEGER file_size;
+  const char*   data = nullptr;
+  if ( GetFileSizeEx( file, &file_size ) && (uint64_t)file_size.QuadPart <= SIZE_MAX )
+  {
+    *out_size = (size_t)file_size.QuadPart;
+
+    // an empty file can't be mapped, but it's still a file
+    HANDLE mapping = *out_size > 0 ? CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr ) : nullptr;
+    if ( mapping != nullptr )
+    {
+      data = (const char*)MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+      CloseHandle( mapping );
+    }
+    else if ( *out_size == 0 )
+    {
+      data = "";
+    }
+  }
+
+  CloseHandle( file );
+  return data;
+}
+
+//---------------------------------------------------------------------------------
+void gj_unmapFile( const char* data, size_t size )
+{
+  if ( size > 0 )
+  {
+    UnmapViewOfFile( data );
+  }
+}
+
+//---------------------------------------------------------------------------------
+// Writes all of data to fd. returns false on an error
+bool gj_writeFd( int fd, const char* data, size_t data_len )
+{
+  while ( data_len > 0 )
+  {
+    const unsigned chunk_len = data_len < INT_MAX ? (unsigned)data_len : INT_MAX;
+    const int      written   = _write( fd, data, chunk_len );
+    if ( written <= 0 )
+    {
+      return false;
+    }
+    data     += written;
+    data_len -= written;
+  }
+  return true;
+}
+
+//---------------------------------------------------------------------------------
+inline void gj_debugBreak()
+{
+  __debugbreak();
+}
+
+#else
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//---------------------------------------------------------------------------------
+inline uint32_t gj_Bsr( uint64_t val )
+{
+  return val != 0 ? 63 - (uint32_t)__builtin_clzll( val ) : (uint32_t)-1;
+}
+
+//---------------------------------------------------------------------------------
+// val must not be 0
+inline uint32_t gj_Bsf( uint32_t val )
+{
+  return (uint32_t)__builtin_ctz( val );
+}
+
+//---------------------------------------------------------------------------------
+// returns the low half of a * b, and the high half in out_hi
+inline uint64_t gj_Mul128( uint64_t a, uint64_t b, uint64_t* out_hi )
+{
+  const unsigned __int128 product = (unsigned __int128)a * b;
+  *out_hi = (uint64_t)( product >> 64 );
+  return (uint64_t)product;
+}
+
+//---------------------------------------------------------------------------------
+// Maps a file read-only. returns nullptr if it can't be opened
+const char* gj_mapFile( const char* path, size_t* out_size )
+{
+  const int file = open( path, O_RDONLY );
+  if ( file < 0 )
+  {
+    return nullptr;
+  }
+
+  struct stat file_stat;
+  const char* data = nullptr;
+  if ( fstat( file, &file_stat ) == 0 && (uint64_t)file_stat.st_size <= SIZE_MAX )
+  {
+    *out_size = (size_t)file_stat.st_size;
+
+    // an empty file can't be mapped, but it's still a file
+    void* mapping = *out_size > 0 ? mmap( nullptr, *out_size, PROT_READ, MAP_PRIVATE, file, 0 ) : MAP_FAILED;
+    if ( mapping != MAP_FAILED )
+    {
+      madvise( mapping, *out_size, MADV_SEQUENTIAL );
+      data = (const char*)mapping;
+    }
+    else if ( *out_size == 0 )
+    {
+      data = "";
+    }
+  }
+
+  close( file );
+  return data;
+}
+
+//---------------------------------------------------------------------------------
+void gj_unmapFile( const char* data, size_t size )
+{
+  if ( size > 0 )
+  {
+    munmap( (void*)data, size );
+  }
+}
+
+//---------------------------------------------------------------------------------
+// Writes all of data to fd. returns false on an error
+bool gj_writeFd( int fd, const char* data, size_t data_len )
+{
+  while ( data_len > 0 )
+  {
+    const ssize_t written = write( fd, data, data_len );
+    if ( written < 0 && errno == EINTR )
+    {
+      continue;
+    }
+    if ( written <= 0 )
+    {
+      return false;
+    }
+    data     += written;
+    data_len -= written;
+  }
+  return true;
+}
+
+//---------------------------------------------------------------------------------
+inline void gj_debugBreak()
+{
+  raise( SIGTRAP );
+}
+
+#endif
+
+// x64 always has sse2. avx2 is checked for at runtime in gj_init
+#if defined( _M_X64 ) || defined( __x86_64__ )
+
+#define GJ_SIMD_X64
+#include <immintrin.h>
+
+#ifdef _MSC_VER
+#define GJ_TARGET_AVX2
+#else
+#define GJ_TARGET_AVX2 __attribute__(( target( "avx2" ) ))
+#endif
+
 #endif
 
 //---------------------------------------------------------------------------------
@@ -28,11 +233,8 @@ static constexpr size_t kUnreasonablyLargeStringSize = 1 * 1024 * 1024; // 1 MB
 // including null terminator
 size_t gj_StrLen( const char* str )
 {
-  // todo: vectorize this?
-  uint32_t idx = 0;
-  while ( str[ idx ] != '\0' && idx != kUnreasonablyLargeStringSize) { idx++; }
-  
-  return idx == kUnreasonablyLargeStringSize ? (size_t)-1 : idx;
+  const size_t len = strnlen( str, kUnreasonablyLargeStringSize );
+  return len == kUnreasonablyLargeStringSize ? (size_t)-1 : len;
 }
 
 // Crc32 functionality from https://github.com/stbrumme/crc32 under zlib license
@@ -73,10 +275,8 @@ constexpr uint32_t kCrc32Lookup[256] = {
 };
 
 //---------------------------------------------------------------------------------
-uint32_t gj_crc32( const char* str )
+uint32_t gj_crc32( const char* str, size_t length )
 {
-  uint32_t length = (uint32_t)gj_StrLen( str );
-
   uint32_t crc = 0;
   const uint8_t* current = (const uint8_t*)str;
 
@@ -86,6 +286,12 @@ uint32_t gj_crc32( const char* str )
   return ~crc; // same as crc ^ 0xFFFFFFFF
 }
 
+//---------------------------------------------------------------------------------
+uint32_t gj_crc32( const char* str )
+{
+  return gj_crc32( str, gj_StrLen( str ) );
+}
+
 //---------------------------------------------------------------------------------
 static gjMallocFn s_MallocFn = nullptr;
 static gjFreeFn   s_FreeFn   = nullptr;
@@ -140,7 +346,7 @@ void gj_assert( const char* message )
   {
     printf( message );
     printf( "\n\n" );
-    __debugbreak();
+    gj_debugBreak();
   }
 }
 
@@ -152,32 +358,78 @@ struct _gjMemberHandle
 };
 
 //---------------------------------------------------------------------------------
+// Open addressing table from key hash to member, for objects that have grown too
+// large to search by walking their members. New entries only ever go in empty
+// slots, never erased ones, so members sharing a hash are probed in list order.
+struct _gjMemberIndex
+{
+  uint32_t m_Mask;
+  uint32_t m_UsedCount; // live and erased entries, since both lengthen probes
+  uint32_t m_LiveCount;
+  uint32_t m_Pad;
+};
+
+//---------------------------------------------------------------------------------
+struct _gjMemberIndexEntry
+{
+  uint32_t m_KeyHash;   // with no member, tells an empty slot from an erased one
+  uint32_t m_MemberIdx;
+};
+
+//---------------------------------------------------------------------------------
+// An object's members are a doubly linked list hanging off a header entry in the
+// member pool. The header's m_Next is the first member, and the first member's
+// m_Prev is the header. The header keeps the last member and the member count in
+// the fields a member uses for its key, so appending and counting don't walk.
 static constexpr uint32_t kMemberIdxTail = (uint32_t)-1;
 struct _gjMember
 {
-  char*    m_KeyStr;
+  union
+  {
+    char*           m_KeyStr;
+    _gjMemberIndex* m_Index; // headers only, nullptr until the object gets an index
+  };
   gjValue  m_Value;
-  uint32_t m_KeyHash;
+  union
+  {
+    uint32_t m_KeyHash;
+    uint32_t m_MemberCount; // headers only
+  };
   uint32_t m_Gen;
   uint32_t m_Next;
+  union
+  {
+    uint32_t m_Prev;
+    uint32_t m_LastIdx; // headers only, the header itself while there are no members
+  };
 };
 
 //---------------------------------------------------------------------------------
-struct _gjArrayHandle
+static constexpr uint32_t kMemberIndexEmpty  = 0;
+static constexpr uint32_t kMemberIndexErased = 1;
+
+//---------------------------------------------------------------------------------
+// An array's elements sit side by side in one run of the array pool, so indexing is
+// an offset from the start of the run. The first entry of a run is a header holding
+// the run's length, and the elements follow it.
+struct _gjArrayStorage
 {
-  uint32_t m_Idx;
-  uint32_t m_Gen;
+  uint32_t m_Idx;   // header of the run, kArrayIdxTail until the array has one
+  uint32_t m_Count;
 };
 
 //---------------------------------------------------------------------------------
-static constexpr uint32_t kArrayIdxTail = (uint32_t)-1;
+static constexpr uint32_t kArrayIdxTail       = (uint32_t)-1;
+static constexpr uint32_t kArrayRunClassCount = 32;
 struct _gjArrayElem
 {
-  gjValue  m_Value;
-  uint32_t m_Gen;
-  uint32_t m_Next;
+  gjValue  m_Value; // in a header, idx is the run length and gen links free runs together
 };
 
+// A free run is linked both ways so its neighbours can take it off its list when they
+// merge with it. The entry after the header holds the previous run in idx, and the last
+// entry holds the run's header in gen.
+
 //---------------------------------------------------------------------------------
 enum gjSubValueType : uint8_t
 {
@@ -205,3119 +457,9441 @@ struct _gjValue
     int             m_Int;
     char*           m_Str;
     bool            m_Bool;
-    _gjArrayHandle  m_ArrayStart;
+    _gjArrayStorage m_Array;
     _gjMemberHandle m_ObjectStart;
+    uint32_t        m_NextFree; // only valid while the slot is on the free list
   };
   uint32_t       m_Gen;
   uint8_t        m_TypeGroup;
+  uint8_t        m_Flags;
 };
 
 //---------------------------------------------------------------------------------
-void*         s_InitialDynamicBacking;
-_gjValue*     s_ValuePool;
-uint64_t*     s_ValueBitset;
-uint32_t      s_ValueBitsetWordCount;
-_gjArrayElem* s_ArrayPool;
-uint32_t      s_ArrayPoolHead;
-_gjMember*    s_MemberPool;
-uint32_t      s_MemberPoolHead;
+// Values made by gj_parseInsitu point into the caller's buffer rather than owning
+// their strings, so these mark what mustn't be freed
+static constexpr uint8_t kValueFlagBorrowedStr  = 0x01; // m_Str
+static constexpr uint8_t kValueFlagBorrowedKeys = 0x02; // the keys of every member
 
 //---------------------------------------------------------------------------------
-gjConfig gj_getDefaultConfig()
+static constexpr uint32_t kValueIdxTail = (uint32_t)-1;
+
+//---------------------------------------------------------------------------------
+// Each pool is a table of equally sized chunks, so an index finds its entry with a
+// shift and a mask. Adding a chunk never moves existing entries, which is what keeps
+// idx/gen handles valid when a pool grows.
+struct _gjPool
 {
-  gjConfig config;
-  config.max_value_count  =  4096;
-  return config;
-}
+  void**   m_Chunks;
+  void**   m_Allocations;     // blocks to free at shutdown, shares the chunk table's allocation
+  uint32_t m_ChunkCount;
+  uint32_t m_ChunkTableSize;
+  uint32_t m_AllocationCount;
+  uint32_t m_ChunkShift;
+  uint32_t m_ChunkMask;
+  uint32_t m_Capacity;
+  uint32_t m_BumpIdx;         // entries from here on have never been handed out
+  uint32_t m_ElemSize;
+  uint32_t m_UsedCount;
+  uint32_t m_PeakUsedCount;
+};
 
 //---------------------------------------------------------------------------------
-void gj_init( const gjConfig* config )
+static constexpr uint32_t kPoolIdxInvalid  = (uint32_t)-1;
+static constexpr uint64_t kPoolMaxCapacity = (uint64_t)kPoolIdxInvalid; // the last index doubles as the list tail
+static constexpr uint32_t kPoolMinChunkShift = 6;  // keeps value chunks aligned to bitset words
+static constexpr uint32_t kPoolMaxChunkShift = 30;
+
+//---------------------------------------------------------------------------------
+// Where array runs are handed out from. The array pool has one, and so does each
+// worker parsing on another thread
+struct _gjArrayArena
 {
-  s_Config = *config;
-  
-  s_ValueBitsetWordCount = ( config->max_value_count >> 6 ) + ((config->max_value_count & 0x0000003f) != 0);
+  uint32_t m_RunHeads[ kArrayRunClassCount ]; // free runs, listed by the log2 of their length
+  uint32_t m_BumpIdx;                         // entries from here to m_EndIdx have never been handed out
+  uint32_t m_EndIdx;
+  uint32_t m_RegionStart;                     // first entry of the newest block, which runs can't reach back past
+};
 
-  const size_t value_pool_sz   = config->max_value_count * sizeof ( *s_ValuePool );
-  const size_t value_bitset_sz = s_ValueBitsetWordCount  * sizeof( uint64_t );
-  const size_t array_pool_sz   = config->max_value_count * sizeof( *s_ArrayPool );
-  const size_t member_pool_sz  = config->max_value_count * sizeof( *s_MemberPool );
+//---------------------------------------------------------------------------------
+// A worker's share of the value or member pool
+struct _gjPartitionList
+{
+  uint32_t m_FreeHead;
+  uint32_t m_BumpIdx; // entries from here to m_EndIdx have never been handed out
+  uint32_t m_EndIdx;
+};
 
-  const size_t total_sz = value_pool_sz
-                        + value_bitset_sz
-                        + array_pool_sz
-                        + member_pool_sz;
+//---------------------------------------------------------------------------------
+// While documents are parsed on several threads, the entries the pools haven't handed
+// out yet are set aside for the workers, and the pools don't grow. Each worker takes
+// blocks of them into its own partition and allocates and frees there, so workers only
+// wait on each other to take another block. A value block is a multiple of 64 entries,
+// so no two workers share a word of the value bitset. Once those run out, workers take
+// recycled members and array runs from the pools' free lists. Recycled values are dealt
+// out before the workers start instead, a whole bitset word to one worker.
+// Running out of room isn't reported from a partition, the caller just parses that
+// document again once the workers are done and the pools can grow.
+static constexpr uint32_t kPartitionBlockSize = 1024;
 
-  s_InitialDynamicBacking = (_gjValue*)gj_malloc( total_sz, "gj: initial bookkeepping alloc" );
-  void* cursor = s_InitialDynamicBacking;
+//---------------------------------------------------------------------------------
+struct _gjPartition
+{
+  _gjPartitionList m_Values;
+  _gjPartitionList m_Members;
+  _gjArrayArena    m_Arrays;
+  uint32_t         m_UsedValues;
+  uint32_t         m_UsedArrayElems;
+  uint32_t         m_UsedMembers;
+  bool             m_OutOfRoom;
+};
 
-  s_ValuePool   = (_gjValue*)    cursor; cursor = ((uint8_t*)cursor + value_pool_sz  );
-  s_ValueBitset = (uint64_t*)    cursor; cursor = ((uint8_t*)cursor + value_bitset_sz);
-  s_ArrayPool   = (_gjArrayElem*)cursor; cursor = ((uint8_t*)cursor + array_pool_sz  );
-  s_MemberPool  = (_gjMember*)   cursor; cursor = ((uint8_t*)cursor + member_pool_sz );
+//---------------------------------------------------------------------------------
+// the entries set aside for the workers, from m_NextIdx to m_EndIdx
+struct _gjPartitionSource
+{
+  uint32_t m_NextIdx;
+  uint32_t m_EndIdx;
+};
 
-  memset( s_ValuePool,   0, value_pool_sz   );
-  memset( s_ValueBitset, 0, value_bitset_sz );
-  memset( s_ArrayPool,   0, array_pool_sz   );
-  memset( s_MemberPool,  0, member_pool_sz  );
+//---------------------------------------------------------------------------------
+void*         s_InitialDynamicBacking;
+_gjPool       s_ValuePool;
+uint64_t*     s_ValueBitset;
+uint32_t      s_ValueBitsetWordCount;
+bool          s_ValueBitsetOwned;
+uint32_t      s_ValuePoolHead;
+_gjPool       s_ArrayPool;
+_gjArrayArena s_ArrayArena;
+uint64_t*     s_ArrayRunEdges;         // the first and last entry of each free run in s_ArrayArena
+uint32_t      s_ArrayRunEdgeWordCount;
+_gjPool       s_MemberPool;
+uint32_t      s_MemberPoolHead;
 
-  for ( uint32_t i_elem = 0; i_elem < config->max_value_count; ++i_elem )
-  {
-    s_ArrayPool [ i_elem ].m_Next = i_elem + 1;
-    s_MemberPool[ i_elem ].m_Next = i_elem + 1;
-  }
-  s_ArrayPool [ config->max_value_count - 1 ].m_Next = kArrayIdxTail;
-  s_MemberPool[ config->max_value_count - 1 ].m_Next = kMemberIdxTail;
-  s_ArrayPoolHead  = 0;
-  s_MemberPoolHead = 0;
-}
+//---------------------------------------------------------------------------------
+static thread_local _gjPartition* s_Partition = nullptr; // set on worker threads
+_gjPartitionSource                s_ValueSource;
+_gjPartitionSource                s_ArraySource;
+_gjPartitionSource                s_MemberSource;
+std::mutex                        s_PartitionMutex;
 
 //---------------------------------------------------------------------------------
-void gj_shutdown()
+inline _gjValue* gj_getValueSlot( uint32_t idx )
 {
-  gj_free( s_InitialDynamicBacking );
+  return (_gjValue*)s_ValuePool.m_Chunks[ idx >> s_ValuePool.m_ChunkShift ] + ( idx & s_ValuePool.m_ChunkMask );
 }
 
 //---------------------------------------------------------------------------------
-_gjValue* gj_allocValue( uint32_t* out_idx )
+inline _gjArrayElem* gj_getArrayElemSlot( uint32_t idx )
 {
-  *out_idx = (uint32_t)-1;
-  for ( uint32_t i_word = 0; i_word < s_ValueBitsetWordCount; ++i_word )
-  {
-    const uint32_t first_bit = gj_Bsr( ~s_ValueBitset[ i_word ] );
-    if ( first_bit != (uint32_t)-1 )
-    {
-      *out_idx = i_word * 64 + 63 - first_bit;
-      break;
-    }
-  }
+  return (_gjArrayElem*)s_ArrayPool.m_Chunks[ idx >> s_ArrayPool.m_ChunkShift ] + ( idx & s_ArrayPool.m_ChunkMask );
+}
 
-  if ( *out_idx != (uint32_t)-1 && *out_idx < s_Config.max_value_count )
-  {
-    const uint32_t set_idx = (*out_idx) >> 0x6;
-    const uint64_t bit = ( 0x8000000000000000 >> ( (*out_idx) & 0x3f));
-    s_ValueBitset[ set_idx ] |= bit;
-    return &s_ValuePool[ *out_idx ];
-  }
+//---------------------------------------------------------------------------------
+inline _gjMember* gj_getMemberSlot( uint32_t idx )
+{
+  return (_gjMember*)s_MemberPool.m_Chunks[ idx >> s_MemberPool.m_ChunkShift ] + ( idx & s_MemberPool.m_ChunkMask );
+}
 
-  gj_assert( "Ran out of slots for values" );
-  return nullptr;
+//---------------------------------------------------------------------------------
+gjConfig gj_getDefaultConfig()
+{
+  gjConfig config;
+  config.max_value_count      = 4096;
+  config.max_array_elem_count = 0;
+  config.max_member_count     = 0;
+  config.growth_policy        = gjPoolGrowthPolicy::kFixed;
+  config.growth_chunk_size    = 4096;
+  config.lazy_pool_init       = false;
+  config.member_index_threshold = 32;
+  config.max_depth              = 0;
+  config.serialize_cache_budget = 0;
+  return config;
 }
 
 //---------------------------------------------------------------------------------
-void gj_freeValue( uint32_t idx )
+// points the chunk table at the initial entries, which all live in one block
+void gj_initPool( _gjPool* pool, void* backing, uint32_t elem_size, uint32_t capacity, uint32_t chunk_shift )
 {
-  if ( idx < s_Config.max_value_count )
+  const uint32_t chunk_size  = 1u << chunk_shift;
+  const uint32_t chunk_count = ( capacity >> chunk_shift ) + ( ( capacity & ( chunk_size - 1 ) ) != 0 );
+
+  pool->m_ChunkTableSize  = chunk_count > 4 ? chunk_count : 4;
+  pool->m_Chunks          = (void**)gj_malloc( pool->m_ChunkTableSize * 2 * sizeof( *pool->m_Chunks ), "gj: pool chunk table" );
+  pool->m_Allocations     = pool->m_Chunks + pool->m_ChunkTableSize;
+  pool->m_ChunkCount      = chunk_count;
+  pool->m_AllocationCount = 0;
+  pool->m_ChunkShift      = chunk_shift;
+  pool->m_ChunkMask       = chunk_size - 1;
+  pool->m_Capacity        = capacity;
+  pool->m_BumpIdx         = 0;
+  pool->m_ElemSize        = elem_size;
+  pool->m_UsedCount       = 0;
+  pool->m_PeakUsedCount   = 0;
+
+  for ( uint32_t i_chunk = 0; i_chunk < chunk_count; ++i_chunk )
   {
-    const uint32_t set_idx = idx >> 0x6;
-    const uint64_t bit = ( 0x8000000000000000 >> ( idx & 0x3f ) );
-    s_ValueBitset[ set_idx ] &= ~bit;
-    s_ValuePool[ idx ].m_Gen++;
+    pool->m_Chunks[ i_chunk ] = (uint8_t*)backing + (size_t)i_chunk * chunk_size * elem_size;
   }
 }
 
 //---------------------------------------------------------------------------------
-_gjArrayElem* gj_allocArrayElem( uint32_t* inout_head_idx, uint32_t array_idx= kArrayIndexEnd )
+// Adds chunk_count chunks to the end of the pool. They share one allocation, so
+// entries running across them are contiguous in memory.
+// returns the index of the first new entry, or kPoolIdxInvalid if the pool can't grow
+uint32_t gj_growPool( _gjPool* pool, uint32_t chunk_count, const char* description )
 {
-  if ( s_ArrayPoolHead != kArrayIdxTail )
+  if ( s_Config.growth_policy != gjPoolGrowthPolicy::kGrowInChunks )
+  {
+    return kPoolIdxInvalid;
+  }
+
+  const uint32_t chunk_size = pool->m_ChunkMask + 1;
+  if ( (uint64_t)pool->m_Capacity + (uint64_t)chunk_size * chunk_count > kPoolMaxCapacity )
+  {
+    return kPoolIdxInvalid;
+  }
+
+  if ( pool->m_ChunkCount + chunk_count > pool->m_ChunkTableSize )
   {
-    if ( *inout_head_idx == kArrayIdxTail || array_idx == 0 )
+    uint32_t new_table_size = pool->m_ChunkTableSize * 2;
+    while ( new_table_size < pool->m_ChunkCount + chunk_count )
     {
-      *inout_head_idx = s_ArrayPoolHead;
-      s_ArrayPoolHead = s_ArrayPool[ s_ArrayPoolHead ].m_Next;
-      s_ArrayPool[ *inout_head_idx ].m_Next = kArrayIdxTail;
-      return &s_ArrayPool[ *inout_head_idx ];
+      new_table_size *= 2;
     }
-    else
-    {
-      _gjArrayElem* elem = &s_ArrayPool[ *inout_head_idx ];
-      uint32_t      idx  = 1;
-      while ( elem->m_Next != kArrayIdxTail && idx++ != array_idx )
-      {
-        elem = &s_ArrayPool[ elem->m_Next ];
-      }
-      const uint32_t new_idx = s_ArrayPoolHead;
-      s_ArrayPoolHead = s_ArrayPool[ s_ArrayPoolHead ].m_Next;
-      
-      const uint32_t prev_next = elem->m_Next;
-      elem->m_Next = new_idx;
-      s_ArrayPool[ new_idx ].m_Next = prev_next;
 
-      return &s_ArrayPool[ new_idx ];
+    void** new_table = (void**)gj_malloc( new_table_size * 2 * sizeof( *new_table ), "gj: pool chunk table" );
+    if ( new_table == nullptr )
+    {
+      return kPoolIdxInvalid;
     }
+
+    memcpy( new_table,                  pool->m_Chunks,      pool->m_ChunkCount      * sizeof( *new_table ) );
+    memcpy( new_table + new_table_size, pool->m_Allocations, pool->m_AllocationCount * sizeof( *new_table ) );
+    gj_free( pool->m_Chunks );
+    pool->m_Chunks         = new_table;
+    pool->m_Allocations    = new_table + new_table_size;
+    pool->m_ChunkTableSize = new_table_size;
   }
 
-  return nullptr;
-}
+  const size_t chunk_sz = (size_t)chunk_size * pool->m_ElemSize;
+  uint8_t*     block    = (uint8_t*)gj_malloc( chunk_sz * chunk_count, description );
+  if ( block == nullptr )
+  {
+    return kPoolIdxInvalid;
+  }
 
-//---------------------------------------------------------------------------------
-// returns the freed elem
-_gjArrayElem* gj_freeArrayElem( _gjArrayHandle* inout_head_handle, uint32_t array_idx )
-{
-  if ( inout_head_handle->m_Idx < s_Config.max_value_count )
+  if ( s_Config.lazy_pool_init == false )
   {
-    _gjArrayElem* elem = &s_ArrayPool[ inout_head_handle->m_Idx ];
-    if ( elem->m_Gen == inout_head_handle->m_Gen )
-    {
-      if ( array_idx == 0 )
-      {
-        const uint32_t prev_head = s_ArrayPoolHead;
-        s_ArrayPoolHead = inout_head_handle->m_Idx;
+    memset( block, 0, chunk_sz * chunk_count );
+  }
 
-        inout_head_handle->m_Idx = elem->m_Next;
-        inout_head_handle->m_Gen = inout_head_handle->m_Idx != kArrayIdxTail
-                                 ? s_ArrayPool[ inout_head_handle->m_Idx ].m_Gen
-                                 : (uint32_t)-1;
-        elem->m_Gen++;
-        elem->m_Next = prev_head;
+  const uint32_t first_idx = pool->m_Capacity;
+  pool->m_Allocations[ pool->m_AllocationCount++ ] = block;
+  for ( uint32_t i_chunk = 0; i_chunk < chunk_count; ++i_chunk )
+  {
+    pool->m_Chunks[ pool->m_ChunkCount++ ] = block + i_chunk * chunk_sz;
+  }
+  pool->m_Capacity += chunk_size * chunk_count;
 
-        return elem;
-      }
-      else
-      {
-        uint32_t idx = 1;
-        while ( idx++ != array_idx && elem->m_Next != kArrayIdxTail )
-        {
-          elem = &s_ArrayPool[ elem->m_Next ];
-        }
+  return first_idx;
+}
 
-        if ( idx - 1 == array_idx )
-        {
-          const uint32_t free_idx = elem->m_Next;
-          elem->m_Next = s_ArrayPool[ elem->m_Next ].m_Next;
-          s_ArrayPool[ free_idx ].m_Next = s_ArrayPoolHead;
-          s_ArrayPool[ free_idx ].m_Gen++;
-          s_ArrayPoolHead = free_idx;
+//---------------------------------------------------------------------------------
+// a worker counts what it uses on its own, and the counts are added up afterwards
+inline uint32_t* gj_getPartitionUsedCount( const _gjPool* pool )
+{
+  return pool == &s_ValuePool ? &s_Partition->m_UsedValues
+       : pool == &s_ArrayPool ? &s_Partition->m_UsedArrayElems
+       :                        &s_Partition->m_UsedMembers;
+}
 
-          return &s_ArrayPool[ free_idx ];
-        }
-        else
-        {
-          gj_assert( "Attempted to free array elem that does not exist in provided head list. This is a problem with the library and should be reported to the github with a minimal repro." );
-        }
-      }
-    }
-    else
-    {
-      gj_assert( "Attempting to free a member that has already been freed" );
-    }
-  }
-  else
+//---------------------------------------------------------------------------------
+inline void gj_notePoolAlloc( _gjPool* pool, uint32_t count )
+{
+  if ( s_Partition != nullptr )
   {
-    gj_assert( "Attempting to free a member that has an invalid handle" );
+    *gj_getPartitionUsedCount( pool ) += count;
+    return;
   }
 
-  return nullptr;
+  pool->m_UsedCount    += count;
+  pool->m_PeakUsedCount = pool->m_UsedCount > pool->m_PeakUsedCount ? pool->m_UsedCount : pool->m_PeakUsedCount;
 }
 
 //---------------------------------------------------------------------------------
-void gj_freeArrayElemList( _gjArrayHandle head_handle )
+inline void gj_notePoolFree( _gjPool* pool, uint32_t count )
 {
-  if ( head_handle.m_Idx < s_Config.max_value_count )
+  if ( s_Partition != nullptr )
   {
-    _gjArrayElem* elem = &s_ArrayPool[ head_handle.m_Idx ];
-    if ( elem->m_Gen == head_handle.m_Gen )
-    {
-      elem->m_Gen++;
-      while ( elem->m_Next != kArrayIdxTail )
-      {
-        elem = &s_ArrayPool[ elem->m_Next ];
-        elem->m_Gen++;
-      }
-      elem->m_Next    = s_ArrayPoolHead;
-      s_ArrayPoolHead = head_handle.m_Idx; 
-    }
+    *gj_getPartitionUsedCount( pool ) -= count;
+    return;
   }
+
+  pool->m_UsedCount -= count;
 }
 
 //---------------------------------------------------------------------------------
-_gjMember* gj_allocMember( uint32_t* inout_head )
+// Running out of room in a worker's partition isn't an error, see kPartitionBlockSize
+void gj_assertPoolFull( const char* message )
 {
-  if ( s_MemberPoolHead != kMemberIdxTail )
+  if ( s_Partition != nullptr )
   {
-    if ( *inout_head == kMemberIdxTail )
-    {
-      *inout_head = s_MemberPoolHead;
-      s_MemberPoolHead = s_MemberPool[ s_MemberPoolHead ].m_Next;
-      s_MemberPool[ *inout_head ].m_Next = kMemberIdxTail;
-      return &s_MemberPool[ *inout_head ];
-    }
-    else
-    {
-      _gjMember* member = &s_MemberPool[ *inout_head ];
-      while ( member->m_Next != kMemberIdxTail )
-      {
-        member = &s_MemberPool[ member->m_Next ];
-      }
-      uint32_t new_idx = s_MemberPoolHead;
-      s_MemberPoolHead = s_MemberPool[ s_MemberPoolHead ].m_Next;
-      
-      member->m_Next = new_idx;
-      s_MemberPool[ new_idx ].m_Next = kMemberIdxTail;
+    s_Partition->m_OutOfRoom = true;
+    return;
+  }
 
-      return &s_MemberPool[ new_idx ];
-    }
+  gj_assert( message );
+}
+
+//---------------------------------------------------------------------------------
+// Takes another block of at least min_count entries for a worker's partition.
+// returns false once the entries set aside for the workers have run out
+bool gj_takePartitionBlock( _gjPartitionSource* source, uint64_t min_count, uint32_t* out_start, uint32_t* out_end )
+{
+  std::lock_guard< std::mutex > lock( s_PartitionMutex );
+
+  const uint32_t left_count = source->m_EndIdx - source->m_NextIdx;
+  if ( left_count < min_count || left_count == 0 )
+  {
+    return false;
   }
 
-  return nullptr;
+  const uint64_t block_size = min_count > kPartitionBlockSize ? min_count : kPartitionBlockSize;
+  const uint32_t take_count = block_size < left_count ? (uint32_t)block_size : left_count;
+  *out_start = source->m_NextIdx;
+  *out_end   = source->m_NextIdx + take_count;
+  source->m_NextIdx += take_count;
+  return true;
 }
 
 //---------------------------------------------------------------------------------
-_gjMember* gj_freeMember( _gjMemberHandle* inout_head_handle, uint32_t key_crc32 )
+// Once the set aside members run out, workers recycle them from the pool's free list.
+// Detaches up to a block's worth and returns the head
+uint32_t gj_takeSharedMembers()
 {
-  if ( inout_head_handle->m_Idx < s_Config.max_value_count )
+  std::lock_guard< std::mutex > lock( s_PartitionMutex );
+
+  const uint32_t first_idx = s_MemberPoolHead;
+  if ( first_idx == kMemberIdxTail )
   {
-    _gjMember* member = &s_MemberPool[ inout_head_handle->m_Idx ];
-    if ( member->m_Gen == inout_head_handle->m_Gen )
-    {
-      if ( member->m_KeyHash == key_crc32 )
-      {
-        const uint32_t prev_head = s_MemberPoolHead;
-        s_MemberPoolHead = inout_head_handle->m_Idx;
+    return kMemberIdxTail;
+  }
 
-        inout_head_handle->m_Idx = member->m_Next;
-        inout_head_handle->m_Gen = inout_head_handle->m_Idx != kMemberIdxTail
-                                 ? s_MemberPool[ inout_head_handle->m_Idx ].m_Gen
-                                 : (uint32_t)-1;
-        member->m_Gen++;
-        member->m_Next = prev_head;
-        gj_free( member->m_KeyStr );
+  _gjMember* last = gj_getMemberSlot( first_idx );
+  for ( uint32_t i_member = 1; i_member < kPartitionBlockSize && last->m_Next != kMemberIdxTail; ++i_member )
+  {
+    last = gj_getMemberSlot( last->m_Next );
+  }
+  s_MemberPoolHead = last->m_Next;
+  last->m_Next     = kMemberIdxTail;
+  return first_idx;
+}
 
-        return member;
-      }
-      else
-      {
-        _gjMember* prev_member = member;
-        while ( member->m_KeyHash != key_crc32 && member->m_Next != kMemberIdxTail )
-        {
-          prev_member = member;
-          member = &s_MemberPool[ member->m_Next ];
-        }
+//---------------------------------------------------------------------------------
+void gj_shutdownPool( _gjPool* pool )
+{
+  for ( uint32_t i_alloc = 0; i_alloc < pool->m_AllocationCount; ++i_alloc )
+  {
+    gj_free( pool->m_Allocations[ i_alloc ] );
+  }
+  gj_free( pool->m_Chunks );
+  memset( pool, 0, sizeof( *pool ) );
+}
 
-        if ( member->m_KeyHash == key_crc32 )
-        {
-          const uint32_t free_idx = prev_member->m_Next;
-          prev_member->m_Next = member->m_Next;
+//---------------------------------------------------------------------------------
+bool gj_growValuePool( uint32_t chunk_count )
+{
+  // the bitset has to cover the new chunks before any of them can be handed out
+  const uint64_t new_capacity = (uint64_t)s_ValuePool.m_Capacity + (uint64_t)( s_ValuePool.m_ChunkMask + 1 ) * chunk_count;
+  if ( new_capacity > kPoolMaxCapacity )
+  {
+    return false;
+  }
 
-          s_MemberPool[ free_idx ].m_Next = s_MemberPoolHead;
-          s_MemberPool[ free_idx ].m_Gen++;
-          s_MemberPoolHead = free_idx;
-          gj_free( member->m_KeyStr );
+  const uint32_t new_word_count = (uint32_t)( new_capacity >> 6 );
+  uint64_t*      new_bitset     = s_Config.growth_policy == gjPoolGrowthPolicy::kGrowInChunks
+                                ? (uint64_t*)gj_malloc( new_word_count * sizeof( uint64_t ), "gj: value bitset" )
+                                : nullptr;
+  if ( new_bitset == nullptr )
+  {
+    return false;
+  }
 
-          return &s_MemberPool[ free_idx ];
-        }
-        else
-        {
-          gj_assert( "Attempted to free object member that does not exist in provided head list. This is a problem with the library and should be reported to the github with a minimal repro." );
-        }
-      }
-    }
-    else
+  const uint32_t first_idx = gj_growPool( &s_ValuePool, chunk_count, "gj: value pool chunk" );
+  if ( first_idx == kPoolIdxInvalid )
+  {
+    gj_free( new_bitset );
+    return false;
+  }
+
+  memcpy( new_bitset, s_ValueBitset, s_ValueBitsetWordCount * sizeof( uint64_t ) );
+  memset( new_bitset + s_ValueBitsetWordCount, 0, ( new_word_count - s_ValueBitsetWordCount ) * sizeof( uint64_t ) );
+  if ( s_ValueBitsetOwned )
+  {
+    gj_free( s_ValueBitset );
+  }
+  s_ValueBitset          = new_bitset;
+  s_ValueBitsetWordCount = new_word_count;
+  s_ValueBitsetOwned     = true;
+
+  return true;
+}
+
+//---------------------------------------------------------------------------------
+// Recycled entries come off the free lists first. After that, entries are handed out
+// in order from the bump index, so a pool only touches its memory as it gets used.
+uint32_t gj_popValueIdx()
+{
+  uint32_t* free_head = s_Partition != nullptr ? &s_Partition->m_Values.m_FreeHead : &s_ValuePoolHead;
+  if ( *free_head != kValueIdxTail )
+  {
+    const uint32_t idx = *free_head;
+    *free_head = gj_getValueSlot( idx )->m_NextFree;
+    return idx;
+  }
+
+  uint32_t idx;
+  if ( s_Partition != nullptr )
+  {
+    _gjPartitionList* values = &s_Partition->m_Values;
+    if ( values->m_BumpIdx == values->m_EndIdx && gj_takePartitionBlock( &s_ValueSource, 1, &values->m_BumpIdx, &values->m_EndIdx ) == false )
     {
-      gj_assert( "Attempting to free a member that has already been freed" );
+      return kValueIdxTail;
     }
+    idx = values->m_BumpIdx++;
   }
   else
   {
-    gj_assert( "Attempting to free a member that has an invalid handle" );
+    if ( s_ValuePool.m_BumpIdx == s_ValuePool.m_Capacity && gj_growValuePool( 1 ) == false )
+    {
+      return kValueIdxTail;
+    }
+    idx = s_ValuePool.m_BumpIdx++;
   }
 
-  return nullptr;
+  gj_getValueSlot( idx )->m_Gen = 0;
+  return idx;
 }
 
 //---------------------------------------------------------------------------------
-void gj_freeMemberList( _gjMemberHandle head_handle )
+uint32_t gj_popMemberIdx()
 {
-  if ( head_handle.m_Idx < s_Config.max_value_count )
+  uint32_t* free_head = s_Partition != nullptr ? &s_Partition->m_Members.m_FreeHead : &s_MemberPoolHead;
+  if ( *free_head == kMemberIdxTail && s_Partition != nullptr )
   {
-    _gjMember* member = &s_MemberPool[ head_handle.m_Idx ];
-    if ( member->m_Gen == head_handle.m_Gen )
+    _gjPartitionList* members = &s_Partition->m_Members;
+    if ( members->m_BumpIdx == members->m_EndIdx && gj_takePartitionBlock( &s_MemberSource, 1, &members->m_BumpIdx, &members->m_EndIdx ) == false )
     {
-      member->m_Gen++;
-      while ( member->m_Next != kMemberIdxTail )
+      *free_head = gj_takeSharedMembers();
+      if ( *free_head == kMemberIdxTail )
       {
-        member = &s_MemberPool[ member->m_Next ];
-        member->m_Gen++;
+        return kMemberIdxTail;
       }
-      member->m_Next   = s_MemberPoolHead;
-      s_MemberPoolHead = head_handle.m_Idx; 
     }
   }
-}
 
-//---------------------------------------------------------------------------------
-bool gj_isValueAlloced( uint32_t idx, uint32_t gen )
-{
-  if ( idx < s_Config.max_value_count )
+  if ( *free_head != kMemberIdxTail )
   {
-    const uint32_t set_idx = idx >> 0x6;
-    const uint64_t bit = ( 0x8000000000000000 >> ( idx & 0x3f ) );
-    if ( s_ValueBitset[ set_idx ] & bit )
+    const uint32_t idx = *free_head;
+    *free_head = gj_getMemberSlot( idx )->m_Next;
+    return idx;
+  }
+
+  uint32_t idx;
+  if ( s_Partition != nullptr )
+  {
+    idx = s_Partition->m_Members.m_BumpIdx++;
+  }
+  else
+  {
+    if ( s_MemberPool.m_BumpIdx == s_MemberPool.m_Capacity && gj_growPool( &s_MemberPool, 1, "gj: member pool chunk" ) == kPoolIdxInvalid )
     {
-      return s_ValuePool[ idx ].m_Gen == gen;
+      return kMemberIdxTail;
     }
+    idx = s_MemberPool.m_BumpIdx++;
   }
-  return false;
+
+  gj_getMemberSlot( idx )->m_Gen = 0;
+  return idx;
 }
 
 //---------------------------------------------------------------------------------
-void gj_freeValueData( _gjValue* val )
+// when growing, every chunk has to be the same size, including the initial ones
+uint32_t gj_getInitialPoolCount( uint32_t requested_count, uint32_t chunk_shift )
 {
-  if ( VAL_TYPE( val ) == gjValueType::kString )
+  if ( s_Config.growth_policy != gjPoolGrowthPolicy::kGrowInChunks )
   {
-    gj_free( val->m_Str );
+    return requested_count;
   }
-  else if ( VAL_TYPE( val ) == gjValueType::kArray )
-  {
-    _gjArrayHandle arr_start_handle = val->m_ArrayStart;
-    if ( arr_start_handle.m_Idx == kArrayIdxTail )
-    {
-      return;
-    }
 
-    _gjArrayElem*  elem = &s_ArrayPool[ arr_start_handle.m_Idx ];
+  const uint64_t chunk_mask = ( 1ull << chunk_shift ) - 1;
+  const uint64_t rounded    = ( (uint64_t)requested_count + chunk_mask ) & ~chunk_mask;
+  return rounded < kPoolMaxCapacity ? (uint32_t)rounded : (uint32_t)( kPoolMaxCapacity & ~chunk_mask );
+}
 
-    if ( elem->m_Gen == arr_start_handle.m_Gen )
-    {
-      if ( gj_isValueAlloced( elem->m_Value.idx, elem->m_Value.gen ) )
-      {
-        gj_freeValueData( &s_ValuePool[ elem->m_Value.idx ] );
-        gj_freeValue    ( elem->m_Value.idx );
-      }
-      
-      while ( elem->m_Next != kArrayIdxTail )
-      {
-        elem = &s_ArrayPool[ elem->m_Next ];
-        if ( gj_isValueAlloced( elem->m_Value.idx, elem->m_Value.gen ) )
-        {
-          gj_freeValueData( &s_ValuePool[ elem->m_Value.idx ] );
-          gj_freeValue    ( elem->m_Value.idx );
-        }
-      }
+//---------------------------------------------------------------------------------
+void gj_initScanFns();
 
-      gj_freeArrayElemList( arr_start_handle );
-    }
-  }
-  else if ( VAL_TYPE( val ) == gjValueType::kObject )
+//---------------------------------------------------------------------------------
+void gj_init( const gjConfig* config )
+{
+  s_Config = *config;
+
+  uint32_t chunk_shift = kPoolMinChunkShift;
+  while ( ( 1u << chunk_shift ) < config->growth_chunk_size && chunk_shift < kPoolMaxChunkShift )
   {
-    _gjMemberHandle obj_start_handle = val->m_ObjectStart;
-    if ( obj_start_handle.m_Idx == kMemberIdxTail )
-    {
-      return;
-    }
+    chunk_shift++;
+  }
 
-    _gjMember*      member = &s_MemberPool[ obj_start_handle.m_Idx ];
+  const uint32_t value_count  = gj_getInitialPoolCount( config->max_value_count, chunk_shift );
+  const uint32_t array_count  = gj_getInitialPoolCount( config->max_array_elem_count ? config->max_array_elem_count : config->max_value_count, chunk_shift );
+  const uint32_t member_count = gj_getInitialPoolCount( config->max_member_count     ? config->max_member_count     : config->max_value_count, chunk_shift );
+  
+  s_ValueBitsetWordCount = ( value_count >> 6 ) + ((value_count & 0x0000003f) != 0);
+  s_ValueBitsetOwned     = false;
 
-    if ( member->m_Gen == obj_start_handle.m_Gen )
-    {
-      if ( gj_isValueAlloced( member->m_Value.idx, member->m_Value.gen ) )
-      {
-        gj_freeValueData( &s_ValuePool[ member->m_Value.idx ] );
-        gj_freeValue    ( member->m_Value.idx );
-        gj_free( member->m_KeyStr );
-      }
+  const size_t value_pool_sz   = (size_t)value_count  * sizeof( _gjValue );
+  const size_t value_bitset_sz = s_ValueBitsetWordCount * sizeof( uint64_t );
+  const size_t array_pool_sz   = (size_t)array_count  * sizeof( _gjArrayElem );
+  const size_t member_pool_sz  = (size_t)member_count * sizeof( _gjMember );
 
-      while ( member->m_Next != kMemberIdxTail )
-      {
-        member = &s_MemberPool[ member->m_Next ];
-        if ( gj_isValueAlloced( member->m_Value.idx, member->m_Value.gen ) )
-        {
-          gj_freeValueData( &s_ValuePool[ member->m_Value.idx ] );
-          gj_freeValue    ( member->m_Value.idx );
-          gj_free( member->m_KeyStr );
-        }
-      }
-    }
+  const size_t total_sz = value_pool_sz
+                        + value_bitset_sz
+                        + array_pool_sz
+                        + member_pool_sz;
 
-    gj_freeMemberList( obj_start_handle );
+  s_InitialDynamicBacking = (_gjValue*)gj_malloc( total_sz, "gj: initial bookkeepping alloc" );
+  void* cursor = s_InitialDynamicBacking;
+
+  void* value_backing  = cursor; cursor = ((uint8_t*)cursor + value_pool_sz  );
+  s_ValueBitset        = (uint64_t*)cursor; cursor = ((uint8_t*)cursor + value_bitset_sz);
+  void* array_backing  = cursor; cursor = ((uint8_t*)cursor + array_pool_sz  );
+  void* member_backing = cursor; cursor = ((uint8_t*)cursor + member_pool_sz );
+
+  // with lazy init, the pools are left untouched until their entries get handed out
+  memset( s_ValueBitset, 0, value_bitset_sz );
+  if ( config->lazy_pool_init == false )
+  {
+    memset( value_backing,  0, value_pool_sz  );
+    memset( array_backing,  0, array_pool_sz  );
+    memset( member_backing, 0, member_pool_sz );
+  }
+
+  gj_initPool( &s_ValuePool,  value_backing,  sizeof( _gjValue ),     value_count,  chunk_shift );
+  gj_initPool( &s_ArrayPool,  array_backing,  sizeof( _gjArrayElem ), array_count,  chunk_shift );
+  gj_initPool( &s_MemberPool, member_backing, sizeof( _gjMember ),    member_count, chunk_shift );
+
+  s_ValuePoolHead  = kValueIdxTail;
+  s_MemberPoolHead = kMemberIdxTail;
+  for ( uint32_t i_class = 0; i_class < kArrayRunClassCount; ++i_class )
+  {
+    s_ArrayArena.m_RunHeads[ i_class ] = kArrayIdxTail;
   }
+  s_ArrayArena.m_BumpIdx     = 0;
+  s_ArrayArena.m_EndIdx      = s_ArrayPool.m_Capacity;
+  s_ArrayArena.m_RegionStart = 0;
+
+  s_ArrayRunEdgeWordCount = ( array_count >> 6 ) + ( ( array_count & 0x3f ) != 0 );
+  s_ArrayRunEdges         = (uint64_t*)gj_malloc( s_ArrayRunEdgeWordCount * sizeof( uint64_t ), "gj: array run edges" );
+  memset( s_ArrayRunEdges, 0, s_ArrayRunEdgeWordCount * sizeof( uint64_t ) );
+
+  gj_initScanFns();
 }
 
 //---------------------------------------------------------------------------------
-//
-// gjValue constructors
-// 
+void gj_shutdownSerializeCache();
+
 //---------------------------------------------------------------------------------
-gjValue::gjValue()
+void gj_shutdown()
 {
-  gen = (uint32_t)-1;
-  idx = (uint32_t)-1;
+  gj_shutdownPool( &s_ValuePool  );
+  gj_shutdownPool( &s_ArrayPool  );
+  gj_shutdownPool( &s_MemberPool );
+  gj_shutdownSerializeCache();
+
+  if ( s_ValueBitsetOwned )
+  {
+    gj_free( s_ValueBitset );
+  }
+  s_ValueBitset = nullptr;
+
+  gj_free( s_ArrayRunEdges );
+  s_ArrayRunEdges = nullptr;
+
+  gj_free( s_InitialDynamicBacking );
 }
 
 //---------------------------------------------------------------------------------
-gjValue::gjValue( int v )
+// Free value slots are kept in a list threaded through the slots themselves, so
+// grabbing one is a pop off the head rather than a search through the bitset.
+// The bitset is still what tells an allocated slot from a free one.
+_gjValue* gj_allocValue( uint32_t* out_idx )
 {
-  gen = (uint32_t)-1;
-  if ( _gjValue* val = gj_allocValue( &idx ) )
+  *out_idx = gj_popValueIdx();
+
+  if ( *out_idx != kValueIdxTail )
   {
-    gen = val->m_Gen;
-    ASSIGN_VAL_TYPE( val, gjValueType::kNumber );
-    ASSIGN_VAL_SUBTYPE( val, kGjSubValueTypeInt );
-    val->m_Int     = v;
+    _gjValue* val = gj_getValueSlot( *out_idx );
+    val->m_Flags  = 0;
+    gj_notePoolAlloc( &s_ValuePool, 1 );
+
+    const uint32_t set_idx = (*out_idx) >> 0x6;
+    const uint64_t bit = ( 0x8000000000000000 >> ( (*out_idx) & 0x3f));
+    s_ValueBitset[ set_idx ] |= bit;
+    return val;
   }
+
+  gj_assertPoolFull( "Ran out of slots for values" );
+  return nullptr;
 }
 
 //---------------------------------------------------------------------------------
-gjValue::gjValue( uint64_t v )
+void gj_freeValue( uint32_t idx )
 {
-  gen = (uint32_t)-1;
-  if ( _gjValue* val = gj_allocValue( &idx ) )
+  if ( idx < s_ValuePool.m_BumpIdx )
   {
-    gen = val->m_Gen;
-    ASSIGN_VAL_TYPE( val, gjValueType::kNumber );
-    ASSIGN_VAL_SUBTYPE( val, kGjSubValueTypeU64 );
-    val->m_U64     = v;
+    const uint32_t set_idx = idx >> 0x6;
+    const uint64_t bit = ( 0x8000000000000000 >> ( idx & 0x3f ) );
+    if ( s_ValueBitset[ set_idx ] & bit )
+    {
+      s_ValueBitset[ set_idx ] &= ~bit;
+      uint32_t* free_head = s_Partition != nullptr ? &s_Partition->m_Values.m_FreeHead : &s_ValuePoolHead;
+      gj_getValueSlot( idx )->m_Gen++;
+      gj_getValueSlot( idx )->m_NextFree = *free_head;
+      *free_head = idx;
+      gj_notePoolFree( &s_ValuePool, 1 );
+    }
   }
 }
 
 //---------------------------------------------------------------------------------
-gjValue::gjValue( float v )
+inline _gjArrayElem* gj_getArrayElems( const _gjArrayStorage& arr )
 {
-  gen = (uint32_t)-1;
-  if ( _gjValue* val = gj_allocValue( &idx ) )
+  return gj_getArrayElemSlot( arr.m_Idx ) + 1;
+}
+
+//---------------------------------------------------------------------------------
+inline uint32_t gj_getArrayRunClass( uint64_t run_len )
+{
+  uint32_t run_class = 0;
+  while ( ( run_len >> run_class ) > 1 )
   {
-    gen = val->m_Gen;
-    ASSIGN_VAL_TYPE( val, gjValueType::kNumber );
-    ASSIGN_VAL_SUBTYPE( val, kGjSubValueTypeFloat );
-    val->m_Float   = v;
+    run_class++;
   }
+  return run_class;
 }
 
 //---------------------------------------------------------------------------------
-gjValue::gjValue( bool v )
+inline _gjArrayArena* gj_getArrayArena()
 {
-  gen = (uint32_t)-1;
-  if ( _gjValue* val = gj_allocValue( &idx ) )
+  return s_Partition != nullptr ? &s_Partition->m_Arrays : &s_ArrayArena;
+}
+
+//---------------------------------------------------------------------------------
+inline bool gj_isArrayRunEdge( uint32_t idx )
+{
+  return ( s_ArrayRunEdges[ idx >> 6 ] & ( 0x8000000000000000 >> ( idx & 0x3f ) ) ) != 0;
+}
+
+//---------------------------------------------------------------------------------
+// Free runs are at least two entries long, so their first and last entries never share a bit
+inline void gj_markArrayRunEdges( uint32_t run_idx, uint32_t run_len, bool is_free )
+{
+  const uint32_t last_idx = run_idx + run_len - 1;
+  if ( is_free )
   {
-    gen = val->m_Gen;
-    ASSIGN_VAL_TYPE( val, gjValueType::kBool );
-    ASSIGN_VAL_SUBTYPE( val, kGjSubValueTypeInvalid );
-    val->m_Bool    = v;
+    s_ArrayRunEdges[ run_idx  >> 6 ] |= 0x8000000000000000 >> ( run_idx  & 0x3f );
+    s_ArrayRunEdges[ last_idx >> 6 ] |= 0x8000000000000000 >> ( last_idx & 0x3f );
+  }
+  else
+  {
+    s_ArrayRunEdges[ run_idx  >> 6 ] &= ~( 0x8000000000000000 >> ( run_idx  & 0x3f ) );
+    s_ArrayRunEdges[ last_idx >> 6 ] &= ~( 0x8000000000000000 >> ( last_idx & 0x3f ) );
   }
 }
 
 //---------------------------------------------------------------------------------
-gjValue::gjValue( const char* v )
+// true if idx is the first entry of one of the array pool's allocations, which runs
+// can't reach across
+bool gj_isArrayBlockStart( uint32_t idx )
 {
-  gen = (uint32_t)-1;
-  if ( _gjValue* val = gj_allocValue( &idx ) )
+  if ( idx == 0 )
   {
-    gen = val->m_Gen;
-    ASSIGN_VAL_TYPE( val, gjValueType::kString );
-    ASSIGN_VAL_SUBTYPE( val, kGjSubValueTypeInvalid );
+    return true;
+  }
 
-    size_t str_len = gj_StrLen( v );
-    val->m_Str = (char*)gj_malloc( str_len + 1, "Value String" );
-    if ( val->m_Str != nullptr )
-    {
-      memcpy( val->m_Str, v, str_len );
-      val->m_Str[ str_len ] = '\0';
-    }
-    else
+  if ( ( idx & s_ArrayPool.m_ChunkMask ) != 0 )
+  {
+    return false;
+  }
+
+  const void* chunk = s_ArrayPool.m_Chunks[ idx >> s_ArrayPool.m_ChunkShift ];
+  for ( uint32_t i_alloc = 0; i_alloc < s_ArrayPool.m_AllocationCount; ++i_alloc )
+  {
+    if ( s_ArrayPool.m_Allocations[ i_alloc ] == chunk )
     {
-      val->m_Gen++;
-      gj_freeValue( idx );
+      return true;
     }
   }
+  return false;
 }
 
 //---------------------------------------------------------------------------------
-//
-// gjValue getters
-// 
-//---------------------------------------------------------------------------------
-gjValueType gjValue::getType() const
+void gj_pushArrayRun( _gjArrayArena* arena, uint32_t run_idx, uint32_t run_len )
 {
-  if ( gj_isValueAlloced( idx, gen ) )
+  _gjArrayElem*  header    = gj_getArrayElemSlot( run_idx );
+  const uint32_t run_class = gj_getArrayRunClass( run_len );
+  const uint32_t next_idx  = arena->m_RunHeads[ run_class ];
+
+  header->m_Value.idx = run_len;
+  header->m_Value.gen = next_idx;
+  gj_getArrayElemSlot( run_idx + 1           )->m_Value.idx = kArrayIdxTail;
+  gj_getArrayElemSlot( run_idx + run_len - 1 )->m_Value.gen = run_idx;
+  if ( next_idx != kArrayIdxTail )
   {
-    _gjValue* val = &s_ValuePool[ idx ];
-    return VAL_TYPE( val );
+    gj_getArrayElemSlot( next_idx + 1 )->m_Value.idx = run_idx;
+  }
+  arena->m_RunHeads[ run_class ] = run_idx;
+
+  // only the pool's arena merges runs, the workers' runs are merged once they're handed back
+  if ( arena == &s_ArrayArena )
+  {
+    gj_markArrayRunEdges( run_idx, run_len, true );
   }
- 
-  return gjValueType::kNull;
 }
 
 //---------------------------------------------------------------------------------
-int gjValue::getInt() const
+// Takes a free run off its list, wherever it is in it
+void gj_unlinkArrayRun( _gjArrayArena* arena, uint32_t run_idx )
 {
-  if ( gj_isValueAlloced( idx, gen ) )
+  _gjArrayElem*  header   = gj_getArrayElemSlot( run_idx );
+  const uint32_t run_len  = header->m_Value.idx;
+  const uint32_t next_idx = header->m_Value.gen;
+  const uint32_t prev_idx = gj_getArrayElemSlot( run_idx + 1 )->m_Value.idx;
+
+  if ( prev_idx == kArrayIdxTail )
   {
-    _gjValue* val = &s_ValuePool[ idx ];
-    if ( VAL_TYPE( val ) == gjValueType::kNumber)
-    {
-      switch ( VAL_SUBTYPE( val ) )
-      {
-      case kGjSubValueTypeInt:
-      {
-        return val->m_Int;
-      }
-      break;
-      case kGjSubValueTypeU64:
-      {
-        return (int)val->m_U64;
-      }
-      break;
-      case kGjSubValueTypeFloat:
-      {
-        return (int)val->m_Float;
-      }
-      break;
-      }
-    }
-    else
-    {
-      gj_assert( "Attempting to get int for json value that is not a number" );
-    }
+    arena->m_RunHeads[ gj_getArrayRunClass( run_len ) ] = next_idx;
   }
   else
   {
-    gj_assert( "Attempting to get int for deallocated json value" );
+    gj_getArrayElemSlot( prev_idx )->m_Value.gen = next_idx;
   }
 
-  return 0;
+  if ( next_idx != kArrayIdxTail )
+  {
+    gj_getArrayElemSlot( next_idx + 1 )->m_Value.idx = prev_idx;
+  }
+
+  if ( arena == &s_ArrayArena )
+  {
+    gj_markArrayRunEdges( run_idx, run_len, false );
+  }
 }
 
 //---------------------------------------------------------------------------------
-uint64_t gjValue::getU64() const
+// Gives a run back to the arena. In the pool's arena it first merges with the free
+// runs on either side of it in the same allocation, and a run that then ends at the
+// bump index goes back to never having been handed out
+void gj_releaseArrayRun( _gjArrayArena* arena, uint32_t run_idx, uint32_t run_len )
 {
-  if ( gj_isValueAlloced( idx, gen ) )
+  if ( arena == &s_ArrayArena )
   {
-    _gjValue* val = &s_ValuePool[ idx ];
-    if ( VAL_TYPE( val ) == gjValueType::kNumber )
+    const uint32_t next_idx = run_idx + run_len;
+    if ( next_idx < s_ArrayPool.m_Capacity && gj_isArrayRunEdge( next_idx ) && gj_isArrayBlockStart( next_idx ) == false )
     {
-      switch ( VAL_SUBTYPE( val ) )
-      {
-      case kGjSubValueTypeInt:
-      {
-        return (uint64_t)val->m_Int;
-      }
-      break;
-      case kGjSubValueTypeU64:
-      {
-        return val->m_U64;
-      }
-      break;
-      case kGjSubValueTypeFloat:
-      {
-        return (uint64_t)val->m_Float;
-      }
-      break;
-      }
+      run_len += gj_getArrayElemSlot( next_idx )->m_Value.idx;
+      gj_unlinkArrayRun( arena, next_idx );
     }
-    else
+
+    if ( run_idx > 0 && gj_isArrayRunEdge( run_idx - 1 ) && gj_isArrayBlockStart( run_idx ) == false )
     {
-      gj_assert( "Attempting to get u64 for json value that is not a number" );
+      const uint32_t prev_idx = gj_getArrayElemSlot( run_idx - 1 )->m_Value.gen;
+      gj_unlinkArrayRun( arena, prev_idx );
+      run_len += run_idx - prev_idx;
+      run_idx  = prev_idx;
     }
   }
+
+  if ( run_idx + run_len == arena->m_BumpIdx && run_idx >= arena->m_RegionStart )
+  {
+    arena->m_BumpIdx = run_idx;
+  }
   else
   {
-    gj_assert( "Attempting to get u64 for deallocated json value" );
+    gj_pushArrayRun( arena, run_idx, run_len );
   }
-
-  return 0;
 }
 
 //---------------------------------------------------------------------------------
-float gjValue::getFloat() const
+// Takes a free run of at least run_len off the pool's arena for a worker to bump through
+bool gj_takeSharedArrayRun( uint64_t run_len, uint32_t* out_start, uint32_t* out_end )
 {
-  if ( gj_isValueAlloced( idx, gen ) )
+  std::lock_guard< std::mutex > lock( s_PartitionMutex );
+
+  uint32_t run_class = gj_getArrayRunClass( run_len );
+  run_class += ( 1ull << run_class ) < run_len;
+  while ( run_class < kArrayRunClassCount && s_ArrayArena.m_RunHeads[ run_class ] == kArrayIdxTail )
   {
-    _gjValue* val = &s_ValuePool[ idx ];
-    if ( VAL_TYPE( val ) == gjValueType::kNumber )
-    {
-      switch ( VAL_SUBTYPE( val ) )
-      {
-      case kGjSubValueTypeInt:
-      {
-        return (float)val->m_Int;
-      }
-      break;
-      case kGjSubValueTypeU64:
-      {
-        return (float)val->m_U64;
-      }
-      break;
-      case kGjSubValueTypeFloat:
-      {
-        return val->m_Float;
-      }
-      break;
-      }
-        
-    }
-    else
-    {
-      gj_assert( "Attempting to get float for json value that is not a number" );
-    }
+    run_class++;
   }
-  else
+
+  if ( run_class == kArrayRunClassCount )
   {
-    gj_assert( "Attempting to get float for deallocated json value" );
+    return false;
   }
 
-  return 0;
+  const uint32_t run_idx = s_ArrayArena.m_RunHeads[ run_class ];
+  *out_start = run_idx;
+  *out_end   = run_idx + gj_getArrayElemSlot( run_idx )->m_Value.idx;
+  gj_unlinkArrayRun( &s_ArrayArena, run_idx );
+  return true;
 }
 
 //---------------------------------------------------------------------------------
-const char* gjValue::getString() const
+// Moves the arena on to a new block of entries with room for at least run_len. The pool's
+// arena grows the pool, and a worker's takes a block from what's set aside for workers,
+// or failing that a free run from the pool's arena. Blocks aren't contiguous with each
+// other, so what's left of the old one becomes a free run
+bool gj_growArrayArena( _gjArrayArena* arena, uint64_t run_len )
 {
-  if ( gj_isValueAlloced( idx, gen ) )
+  uint32_t block_start;
+  uint32_t block_end;
+  if ( arena == &s_ArrayArena )
   {
-    _gjValue* val = &s_ValuePool[ idx ];
-    if ( VAL_TYPE( val ) == gjValueType::kString )
+    block_start = s_ArrayPool.m_Capacity;
+
+    // the edges have to cover the new chunks before any of them can be freed
+    const uint64_t grow_count     = ( run_len + s_ArrayPool.m_ChunkMask ) >> s_ArrayPool.m_ChunkShift;
+    const uint64_t new_capacity   = (uint64_t)s_ArrayPool.m_Capacity + ( grow_count << s_ArrayPool.m_ChunkShift );
+    const uint64_t new_word_count = ( new_capacity >> 6 ) + ( ( new_capacity & 0x3f ) != 0 );
+    uint64_t*      new_edges      = s_Config.growth_policy == gjPoolGrowthPolicy::kGrowInChunks && new_capacity <= kPoolMaxCapacity
+                                  ? (uint64_t*)gj_malloc( new_word_count * sizeof( uint64_t ), "gj: array run edges" )
+                                  : nullptr;
+    if ( new_edges == nullptr )
     {
-      return val->m_Str;
+      return false;
     }
-    else
+
+    if ( gj_growPool( &s_ArrayPool, (uint32_t)grow_count, "gj: array pool chunk" ) == kPoolIdxInvalid )
     {
-      gj_assert( "Attempting to get string for json value that is not a string" );
+      gj_free( new_edges );
+      return false;
     }
+    block_end = s_ArrayPool.m_Capacity;
+
+    memcpy( new_edges, s_ArrayRunEdges, s_ArrayRunEdgeWordCount * sizeof( uint64_t ) );
+    memset( new_edges + s_ArrayRunEdgeWordCount, 0, ( new_word_count - s_ArrayRunEdgeWordCount ) * sizeof( uint64_t ) );
+    gj_free( s_ArrayRunEdges );
+    s_ArrayRunEdges         = new_edges;
+    s_ArrayRunEdgeWordCount = (uint32_t)new_word_count;
   }
-  else
+  else if ( gj_takePartitionBlock( &s_ArraySource, run_len, &block_start, &block_end ) == false
+         && gj_takeSharedArrayRun( run_len, &block_start, &block_end ) == false )
   {
-    gj_assert( "Attempting to get string for deallocated json value" );
+    return false;
   }
 
-  return nullptr;
+  // the leftover is released once the arena has moved on, so it isn't bumped back into
+  const uint32_t left_idx = arena->m_BumpIdx;
+  const uint32_t left_end = arena->m_EndIdx;
+  arena->m_BumpIdx     = block_start;
+  arena->m_EndIdx      = block_end;
+  arena->m_RegionStart = block_start;
+  if ( left_end - left_idx >= 2 )
+  {
+    gj_releaseArrayRun( arena, left_idx, left_end - left_idx );
+  }
+
+  return true;
 }
 
 //---------------------------------------------------------------------------------
-bool gjValue::getBool() const
+// Returns the header of a run of at least run_len entries, or kArrayIdxTail.
+// Free runs are used first and split when they're longer than needed. After that,
+// runs come from entries that have never been handed out.
+uint32_t gj_allocArrayRun( uint64_t run_len )
 {
-  if ( gj_isValueAlloced( idx, gen ) )
+  if ( run_len > kPoolMaxCapacity )
   {
-    _gjValue* val = &s_ValuePool[ idx ];
-    if ( VAL_TYPE( val ) == gjValueType::kBool )
+    return kArrayIdxTail;
+  }
+
+  _gjArrayArena* arena = gj_getArrayArena();
+
+  // every run listed under a class is at least 1 << class long, so starting from the
+  // class that covers run_len, the head of the first non-empty list is long enough
+  uint32_t run_class = gj_getArrayRunClass( run_len );
+  run_class += ( 1ull << run_class ) < run_len;
+  while ( run_class < kArrayRunClassCount && arena->m_RunHeads[ run_class ] == kArrayIdxTail )
+  {
+    run_class++;
+  }
+
+  uint32_t run_idx = kArrayIdxTail;
+  if ( run_class < kArrayRunClassCount )
+  {
+    run_idx = arena->m_RunHeads[ run_class ];
+    gj_unlinkArrayRun( arena, run_idx );
+
+    // a leftover too short to hold a header and an element stays with the run
+    const uint32_t free_len = gj_getArrayElemSlot( run_idx )->m_Value.idx;
+    if ( free_len - run_len >= 2 )
     {
-      return val->m_Bool;
+      gj_pushArrayRun( arena, run_idx + (uint32_t)run_len, free_len - (uint32_t)run_len );
     }
     else
     {
-      gj_assert( "Attempting to get bool for json value that is not a bool" );
+      run_len = free_len;
     }
   }
   else
   {
-    gj_assert( "Attempting to get bool for deallocated json value" );
+    if ( arena->m_BumpIdx + run_len > arena->m_EndIdx && gj_growArrayArena( arena, run_len ) == false )
+    {
+      return kArrayIdxTail;
+    }
+
+    // as with free runs, a leftover that couldn't be freed on its own stays with the run
+    run_idx  = arena->m_BumpIdx;
+    run_len += arena->m_EndIdx - run_idx - run_len == 1;
+    arena->m_BumpIdx += (uint32_t)run_len;
   }
 
-  return false;
+  gj_getArrayElemSlot( run_idx )->m_Value.idx = (uint32_t)run_len;
+  gj_notePoolAlloc( &s_ArrayPool, (uint32_t)run_len );
+  return run_idx;
 }
 
 //---------------------------------------------------------------------------------
-//
-// gjValue setters
-// 
-//---------------------------------------------------------------------------------
-void gjValue::setInt( int v )
+void gj_freeArrayRun( uint32_t run_idx )
 {
-  if ( gj_isValueAlloced( idx, gen ) )
-  {
-    _gjValue* val = &s_ValuePool[ idx ];
-    gj_freeValueData( val );
-
-    ASSIGN_VAL_TYPE( val, gjValueType::kNumber );
-    ASSIGN_VAL_SUBTYPE( val, kGjSubValueTypeInt );
-    val->m_Int     = v;
-  }
+  const uint32_t run_len = gj_getArrayElemSlot( run_idx )->m_Value.idx;
+  gj_notePoolFree( &s_ArrayPool, run_len );
+  gj_releaseArrayRun( gj_getArrayArena(), run_idx, run_len );
 }
 
 //---------------------------------------------------------------------------------
-void gjValue::setU64( uint64_t v )
+// Makes room for one more element. A full run that ends at the bump index grows in
+// place, anything else moves to a run with twice the room.
+// Returns the array's elements, or nullptr if the pool has no room left.
+_gjArrayElem* gj_reserveArrayElem( _gjValue* val )
 {
-  if ( gj_isValueAlloced( idx, gen ) )
+  const uint32_t count = val->m_Array.m_Count;
+  if ( val->m_Array.m_Idx != kArrayIdxTail )
   {
-    _gjValue* val = &s_ValuePool[ idx ];
-    gj_freeValueData( val );
+    const uint32_t run_idx = val->m_Array.m_Idx;
+    _gjArrayElem*  header  = gj_getArrayElemSlot( run_idx );
+    if ( count + 1 < header->m_Value.idx )
+    {
+      return header + 1;
+    }
 
-    ASSIGN_VAL_TYPE( val, gjValueType::kNumber );
-    ASSIGN_VAL_SUBTYPE( val, kGjSubValueTypeU64 );
-    val->m_U64     = v;
+    _gjArrayArena* arena = gj_getArrayArena();
+    if ( run_idx + header->m_Value.idx == arena->m_BumpIdx
+      && run_idx >= arena->m_RegionStart
+      && arena->m_BumpIdx < arena->m_EndIdx )
+    {
+      const uint32_t room  = arena->m_EndIdx - arena->m_BumpIdx;
+      const uint32_t extra = count + 1 < room ? count : room;
+
+      arena->m_BumpIdx    += extra;
+      header->m_Value.idx += extra;
+      gj_notePoolAlloc( &s_ArrayPool, extra );
+      return header + 1;
+    }
   }
-}
 
-//---------------------------------------------------------------------------------
-void gjValue::setFloat( float v )
-{
-  if ( gj_isValueAlloced( idx, gen ) )
+  // when twice the room doesn't fit anywhere, settle for one more element
+  uint32_t new_idx = gj_allocArrayRun( (uint64_t)count * 2 + 2 );
+  if ( new_idx == kArrayIdxTail && count != 0 )
   {
-    _gjValue* val = &s_ValuePool[ idx ];
-    gj_freeValueData( val );
+    new_idx = gj_allocArrayRun( (uint64_t)count + 2 );
+  }
 
-    ASSIGN_VAL_TYPE( val, gjValueType::kNumber );
-    ASSIGN_VAL_SUBTYPE( val, kGjSubValueTypeFloat );
-    val->m_Float   = v;
+  if ( new_idx == kArrayIdxTail )
+  {
+    return nullptr;
+  }
+
+  _gjArrayElem* new_elems = gj_getArrayElemSlot( new_idx ) + 1;
+  if ( val->m_Array.m_Idx != kArrayIdxTail )
+  {
+    memcpy( new_elems, gj_getArrayElems( val->m_Array ), count * sizeof( _gjArrayElem ) );
+    gj_freeArrayRun( val->m_Array.m_Idx );
   }
+
+  val->m_Array.m_Idx = new_idx;
+  return new_elems;
 }
 
 //---------------------------------------------------------------------------------
-void gjValue::setString( const char* str )
+// Takes an element out of the array and closes the gap behind it.
+// returns the element's value, or an invalid value if there's no such element
+gjValue gj_takeArrayElem( _gjValue* val, uint32_t array_idx )
 {
-  if ( gj_isValueAlloced( idx, gen ) )
+  if ( array_idx < val->m_Array.m_Count )
   {
-    _gjValue* val = &s_ValuePool[ idx ];
-    gj_freeValueData( val );
+    _gjArrayElem* elems = gj_getArrayElems( val->m_Array );
+    const gjValue taken = elems[ array_idx ].m_Value;
 
-    ASSIGN_VAL_TYPE( val, gjValueType::kString );
-    ASSIGN_VAL_SUBTYPE( val, kGjSubValueTypeInvalid );
+    memmove( elems + array_idx, elems + array_idx + 1, ( val->m_Array.m_Count - array_idx - 1 ) * sizeof( _gjArrayElem ) );
+    val->m_Array.m_Count--;
 
-    const size_t str_len = gj_StrLen( str );
-    val->m_Str     = (char*)gj_malloc( str_len + 1, "setString string" );
-    memcpy( val->m_Str, str, str_len );
-    val->m_Str[ str_len ] = '\0';
+    return taken;
   }
+
+  gj_assert( "Attempting to take an array element that is out of range" );
+  return gjValue{};
 }
 
 //---------------------------------------------------------------------------------
-void gjValue::setBool( bool v )
+inline _gjMemberIndexEntry* gj_getMemberIndexEntries( const _gjMemberIndex* index )
 {
-  if ( gj_isValueAlloced( idx, gen ) )
-  {
-    _gjValue* val = &s_ValuePool[ idx ];
-    gj_freeValueData( val );
-
-    ASSIGN_VAL_TYPE( val, gjValueType::kBool );
-    ASSIGN_VAL_SUBTYPE( val, kGjSubValueTypeInvalid );
-    val->m_Float   = v;
-  }
+  return (_gjMemberIndexEntry*)( index + 1 );
 }
 
 //---------------------------------------------------------------------------------
-void gjValue::setNull()
+void gj_addToMemberIndex( _gjMemberIndex* index, uint32_t key_hash, uint32_t member_idx )
 {
-  if ( gj_isValueAlloced( idx, gen ) )
-  {
-    _gjValue* val = &s_ValuePool[ idx ];
-    gj_freeValueData( val );
+  _gjMemberIndexEntry* entries = gj_getMemberIndexEntries( index );
 
-    ASSIGN_VAL_TYPE( val, gjValueType::kNull );
-    ASSIGN_VAL_SUBTYPE( val, kGjSubValueTypeInvalid );
+  uint32_t slot = key_hash & index->m_Mask;
+  while ( entries[ slot ].m_MemberIdx != kMemberIdxTail || entries[ slot ].m_KeyHash == kMemberIndexErased )
+  {
+    slot = ( slot + 1 ) & index->m_Mask;
   }
+
+  entries[ slot ].m_KeyHash   = key_hash;
+  entries[ slot ].m_MemberIdx = member_idx;
+  index->m_UsedCount++;
+  index->m_LiveCount++;
 }
 
 //---------------------------------------------------------------------------------
-//
-// gjValue assignment operators
-// 
-//---------------------------------------------------------------------------------
-gjValue& gjValue::operator=( int v )
+void gj_removeFromMemberIndex( _gjMemberIndex* index, uint32_t key_hash, uint32_t member_idx )
 {
-  setInt( v );
-  return *this;
+  _gjMemberIndexEntry* entries = gj_getMemberIndexEntries( index );
+
+  uint32_t slot = key_hash & index->m_Mask;
+  while ( entries[ slot ].m_MemberIdx != kMemberIdxTail || entries[ slot ].m_KeyHash == kMemberIndexErased )
+  {
+    if ( entries[ slot ].m_MemberIdx == member_idx )
+    {
+      entries[ slot ].m_KeyHash   = kMemberIndexErased;
+      entries[ slot ].m_MemberIdx = kMemberIdxTail;
+      index->m_LiveCount--;
+      return;
+    }
+    slot = ( slot + 1 ) & index->m_Mask;
+  }
 }
 
 //---------------------------------------------------------------------------------
-gjValue& gjValue::operator=( uint64_t v )
+uint32_t gj_findInMemberIndex( const _gjMemberIndex* index, uint32_t key_hash )
 {
-  setU64( v );
-  return *this;
+  const _gjMemberIndexEntry* entries = gj_getMemberIndexEntries( index );
+
+  uint32_t slot = key_hash & index->m_Mask;
+  while ( entries[ slot ].m_MemberIdx != kMemberIdxTail || entries[ slot ].m_KeyHash == kMemberIndexErased )
+  {
+    if ( entries[ slot ].m_MemberIdx != kMemberIdxTail && entries[ slot ].m_KeyHash == key_hash )
+    {
+      return entries[ slot ].m_MemberIdx;
+    }
+    slot = ( slot + 1 ) & index->m_Mask;
+  }
+
+  return kMemberIdxTail;
 }
 
 //---------------------------------------------------------------------------------
-gjValue& gjValue::operator=( float v )
+// Replaces the header's index with a fresh one holding every member, in list order.
+// The table starts at most half full, leaving room for the object to grow.
+void gj_buildMemberIndex( _gjMember* header )
 {
-  setFloat( v );
-  return *this;
+  uint64_t capacity = 16;
+  while ( capacity < (uint64_t)header->m_MemberCount * 2 )
+  {
+    capacity *= 2;
+  }
+
+  _gjMemberIndex* index = (_gjMemberIndex*)gj_malloc( sizeof( _gjMemberIndex ) + capacity * sizeof( _gjMemberIndexEntry ), "gj: object member index" );
+  if ( index == nullptr )
+  {
+    return;
+  }
+
+  index->m_Mask      = (uint32_t)( capacity - 1 );
+  index->m_UsedCount = 0;
+  index->m_LiveCount = 0;
+
+  _gjMemberIndexEntry* entries = gj_getMemberIndexEntries( index );
+  for ( uint64_t i_entry = 0; i_entry < capacity; ++i_entry )
+  {
+    entries[ i_entry ].m_KeyHash   = kMemberIndexEmpty;
+    entries[ i_entry ].m_MemberIdx = kMemberIdxTail;
+  }
+
+  for ( uint32_t member_idx = header->m_Next; member_idx != kMemberIdxTail; member_idx = gj_getMemberSlot( member_idx )->m_Next )
+  {
+    gj_addToMemberIndex( index, gj_getMemberSlot( member_idx )->m_KeyHash, member_idx );
+  }
+
+  gj_free( header->m_Index );
+  header->m_Index = index;
 }
 
 //---------------------------------------------------------------------------------
-gjValue& gjValue::operator=( const char* v )
+// returns the object's header, or nullptr if it has never had any members
+_gjMember* gj_getObjectHeader( const _gjValue* val )
 {
-  setString( v );
-  return *this;
+  const _gjMemberHandle handle = val->m_ObjectStart;
+  if ( handle.m_Idx < s_MemberPool.m_BumpIdx )
+  {
+    _gjMember* header = gj_getMemberSlot( handle.m_Idx );
+    if ( header->m_Gen == handle.m_Gen )
+    {
+      return header;
+    }
+
+    gj_assert( "Attempting to use object members that have already been freed" );
+  }
+
+  return nullptr;
 }
 
 //---------------------------------------------------------------------------------
-gjValue& gjValue::operator=( bool v )
+// Finds the first member with the given key hash. Objects with an index look it up
+// there, others walk their members. A walk longer than member_index_threshold
+// builds the object an index, so the next lookup doesn't have to.
+uint32_t gj_findMember( _gjMember* header, uint32_t key_crc32 )
 {
-  setBool( v );
-  return *this;
+  if ( header->m_Index != nullptr )
+  {
+    return gj_findInMemberIndex( header->m_Index, key_crc32 );
+  }
+
+  uint32_t walked_count = 0;
+  uint32_t member_idx   = header->m_Next;
+  while ( member_idx != kMemberIdxTail && gj_getMemberSlot( member_idx )->m_KeyHash != key_crc32 )
+  {
+    member_idx = gj_getMemberSlot( member_idx )->m_Next;
+    walked_count++;
+  }
+
+  if ( s_Config.member_index_threshold != 0 && walked_count >= s_Config.member_index_threshold )
+  {
+    gj_buildMemberIndex( header );
+  }
+
+  return member_idx;
 }
 
 //---------------------------------------------------------------------------------
-//
-// Make Deep Copy
-//
-//---------------------------------------------------------------------------------
-gjValue gjValue::makeDeepCopy() const
+// Appends a member to the object, giving the object a header first if it needs one.
+// returns the new member, or nullptr if the member pool is full
+_gjMember* gj_allocMember( _gjValue* val, uint32_t key_crc32 )
 {
-  gjValue copy_val;
-  if ( gj_isValueAlloced( idx, gen ) )
+  uint32_t header_idx = val->m_ObjectStart.m_Idx;
+  if ( header_idx == kMemberIdxTail )
   {
-    const _gjValue* val = &s_ValuePool[ idx ];
-    if ( _gjValue* val_copy = gj_allocValue( &copy_val.idx ) )
+    header_idx = gj_popMemberIdx();
+    if ( header_idx == kMemberIdxTail )
     {
-      copy_val.gen = val_copy->m_Gen;
+      return nullptr;
+    }
+    gj_notePoolAlloc( &s_MemberPool, 1 );
+
+    _gjMember* header = gj_getMemberSlot( header_idx );
+    header->m_Index       = nullptr;
+    header->m_MemberCount = 0;
+    header->m_Next        = kMemberIdxTail;
+    header->m_LastIdx     = header_idx;
+
+    val->m_ObjectStart.m_Idx = header_idx;
+    val->m_ObjectStart.m_Gen = header->m_Gen;
+  }
+
+  const uint32_t new_idx = gj_popMemberIdx();
+  if ( new_idx == kMemberIdxTail )
+  {
+    return nullptr;
+  }
+  gj_notePoolAlloc( &s_MemberPool, 1 );
+
+  _gjMember* header = gj_getMemberSlot( header_idx );
+  _gjMember* member = gj_getMemberSlot( new_idx );
+  member->m_KeyHash = key_crc32;
+  member->m_Next    = kMemberIdxTail;
+  member->m_Prev    = header->m_LastIdx;
+  gj_getMemberSlot( header->m_LastIdx )->m_Next = new_idx;
+  header->m_LastIdx = new_idx;
+  header->m_MemberCount++;
+
+  if ( header->m_Index != nullptr )
+  {
+    // past three quarters full, start over with a bigger table rather than probe forever
+    _gjMemberIndex* index = header->m_Index;
+    if ( ( (uint64_t)index->m_UsedCount + 1 ) * 4 > ( (uint64_t)index->m_Mask + 1 ) * 3 )
+    {
+      gj_buildMemberIndex( header );
+    }
+    else
+    {
+      gj_addToMemberIndex( index, key_crc32, new_idx );
+    }
+  }
+
+  return member;
+}
+
+//---------------------------------------------------------------------------------
+// Unlinks a member from its object and puts it back in the pool.
+// returns the freed member, its m_Value is left as it was
+_gjMember* gj_freeMember( _gjMember* header, uint32_t member_idx, bool free_key )
+{
+  _gjMember* member = gj_getMemberSlot( member_idx );
+
+  gj_getMemberSlot( member->m_Prev )->m_Next = member->m_Next;
+  if ( member->m_Next != kMemberIdxTail )
+  {
+    gj_getMemberSlot( member->m_Next )->m_Prev = member->m_Prev;
+  }
+  else
+  {
+    header->m_LastIdx = member->m_Prev;
+  }
+  header->m_MemberCount--;
+
+  if ( header->m_Index != nullptr )
+  {
+    gj_removeFromMemberIndex( header->m_Index, member->m_KeyHash, member_idx );
+  }
+
+  if ( free_key )
+  {
+    gj_free( member->m_KeyStr );
+  }
+  uint32_t* free_head = s_Partition != nullptr ? &s_Partition->m_Members.m_FreeHead : &s_MemberPoolHead;
+  member->m_Gen++;
+  member->m_Next = *free_head;
+  *free_head     = member_idx;
+  gj_notePoolFree( &s_MemberPool, 1 );
+
+  return member;
+}
+
+//---------------------------------------------------------------------------------
+// frees an object's header and members, but not the values they hold
+void gj_freeMemberList( _gjMemberHandle head_handle, bool free_keys )
+{
+  if ( head_handle.m_Idx < s_MemberPool.m_BumpIdx )
+  {
+    _gjMember* member = gj_getMemberSlot( head_handle.m_Idx );
+    if ( member->m_Gen == head_handle.m_Gen )
+    {
+      gj_free( member->m_Index );
+
+      uint32_t freed_count = 1;
+      member->m_Gen++;
+      while ( member->m_Next != kMemberIdxTail )
+      {
+        member = gj_getMemberSlot( member->m_Next );
+        if ( free_keys )
+        {
+          gj_free( member->m_KeyStr );
+        }
+        member->m_Gen++;
+        freed_count++;
+      }
+      uint32_t* free_head = s_Partition != nullptr ? &s_Partition->m_Members.m_FreeHead : &s_MemberPoolHead;
+      member->m_Next = *free_head;
+      *free_head     = head_handle.m_Idx;
+      gj_notePoolFree( &s_MemberPool, freed_count );
+    }
+  }
+}
+
+//---------------------------------------------------------------------------------
+// Gives an object that was parsed in place its own copies of its keys, so that
+// keys it owns and keys it doesn't are never mixed in one object
+void gj_copyBorrowedKeys( _gjValue* val )
+{
+  if ( const _gjMember* header = gj_getObjectHeader( val ) )
+  {
+    for ( uint32_t member_idx = header->m_Next; member_idx != kMemberIdxTail; member_idx = gj_getMemberSlot( member_idx )->m_Next )
+    {
+      _gjMember*   member   = gj_getMemberSlot( member_idx );
+      const size_t str_len  = gj_StrLen( member->m_KeyStr ) + 1;
+      char*        key_copy = (char*)gj_malloc( str_len, "Object Key String" );
+      memcpy( key_copy, member->m_KeyStr, str_len );
+      member->m_KeyStr = key_copy;
+    }
+  }
+
+  val->m_Flags &= ~kValueFlagBorrowedKeys;
+}
+
+//---------------------------------------------------------------------------------
+bool gj_isValueAlloced( uint32_t idx, uint32_t gen )
+{
+  if ( idx < s_ValuePool.m_BumpIdx )
+  {
+    const uint32_t set_idx = idx >> 0x6;
+    const uint64_t bit = ( 0x8000000000000000 >> ( idx & 0x3f ) );
+    if ( s_ValueBitset[ set_idx ] & bit )
+    {
+      return gj_getValueSlot( idx )->m_Gen == gen;
+    }
+  }
+  return false;
+}
+
+//---------------------------------------------------------------------------------
+// Freeing, copying and serializing walk the tree with a stack of the containers they
+// are inside of rather than by recursing, so deep documents can't run a thread out
+// of stack. Like the parser's stack, it lives on the caller's stack until the nesting
+// gets deeper than kWalkInlineStackDepth. The container being walked is kept in a
+// local frame so it stays in registers, and the stack only holds the ones around it.
+static constexpr uint32_t kWalkInlineStackDepth = 32;
+
+//---------------------------------------------------------------------------------
+struct _gjWalkFrame
+{
+  _gjValue*           m_Val;
+  _gjValue*           m_Copy;      // the container being filled in, when copying
+  const _gjArrayElem* m_Elems;     // null for objects
+  uint32_t            m_ElemCount;
+  uint32_t            m_ValueIdx;  // kValueIdxTail for the value the walk started from
+  uint32_t            m_Next;      // index of the next element, or of the next member for objects
+  uint32_t            m_Visited;   // children walked so far
+};
+
+//---------------------------------------------------------------------------------
+struct _gjWalkStack
+{
+  _gjWalkFrame* m_Frames; // the containers around the one being walked, innermost last
+  uint32_t      m_Depth;
+  uint32_t      m_Capacity;
+  _gjWalkFrame  m_InlineFrames[ kWalkInlineStackDepth ];
+};
+
+//---------------------------------------------------------------------------------
+void gj_initWalkStack( _gjWalkStack* stack )
+{
+  stack->m_Frames   = stack->m_InlineFrames;
+  stack->m_Depth    = 0;
+  stack->m_Capacity = kWalkInlineStackDepth;
+}
+
+//---------------------------------------------------------------------------------
+void gj_releaseWalkStack( _gjWalkStack* stack )
+{
+  if ( stack->m_Frames != stack->m_InlineFrames )
+  {
+    gj_free( stack->m_Frames );
+  }
+}
+
+//---------------------------------------------------------------------------------
+bool gj_growWalkStack( _gjWalkStack* stack )
+{
+  const uint32_t new_capacity = stack->m_Capacity * 2;
+  _gjWalkFrame*  new_frames   = (_gjWalkFrame*)gj_malloc( new_capacity * sizeof( *new_frames ), "Walk stack" );
+  if ( new_frames == nullptr )
+  {
+    gj_assert( "Ran out of memory for the walk stack. You may be out of memory" );
+    return false;
+  }
+
+  memcpy( new_frames, stack->m_Frames, stack->m_Depth * sizeof( *new_frames ) );
+  gj_releaseWalkStack( stack );
+
+  stack->m_Frames   = new_frames;
+  stack->m_Capacity = new_capacity;
+  return true;
+}
+
+//---------------------------------------------------------------------------------
+// Saves the frame being walked before stepping into one of its children.
+// returns false if the stack couldn't grow
+inline bool gj_pushWalkFrame( _gjWalkStack* stack, const _gjWalkFrame* frame )
+{
+  if ( stack->m_Depth == stack->m_Capacity && gj_growWalkStack( stack ) == false )
+  {
+    return false;
+  }
+
+  stack->m_Frames[ stack->m_Depth++ ] = *frame;
+  return true;
+}
+
+//---------------------------------------------------------------------------------
+// Goes back to the container around the one that was being walked.
+// returns false once the walk is back where it started
+inline bool gj_popWalkFrame( _gjWalkStack* stack, _gjWalkFrame* out_frame )
+{
+  if ( stack->m_Depth == 0 )
+  {
+    return false;
+  }
+
+  *out_frame = stack->m_Frames[ --stack->m_Depth ];
+  return true;
+}
+
+//---------------------------------------------------------------------------------
+inline bool gj_isContainer( const _gjValue* val )
+{
+  return VAL_TYPE( val ) == gjValueType::kArray || VAL_TYPE( val ) == gjValueType::kObject;
+}
+
+//---------------------------------------------------------------------------------
+inline void gj_startWalkFrame( _gjWalkFrame* frame, _gjValue* val, uint32_t value_idx )
+{
+  frame->m_Val      = val;
+  frame->m_Copy     = nullptr;
+  frame->m_ValueIdx = value_idx;
+  frame->m_Visited  = 0;
+  if ( VAL_TYPE( val ) == gjValueType::kObject )
+  {
+    const _gjMember* header = gj_getObjectHeader( val );
+    frame->m_Elems     = nullptr;
+    frame->m_ElemCount = 0;
+    frame->m_Next      = header != nullptr ? header->m_Next : kMemberIdxTail;
+  }
+  else
+  {
+    const bool has_run = val->m_Array.m_Idx != kArrayIdxTail;
+    frame->m_Elems     = has_run ? gj_getArrayElems( val->m_Array ) : nullptr;
+    frame->m_ElemCount = has_run ? val->m_Array.m_Count : 0;
+    frame->m_Next      = has_run ? 0 : kMemberIdxTail;
+  }
+}
+
+//---------------------------------------------------------------------------------
+inline bool gj_hasWalkChild( const _gjWalkFrame* frame )
+{
+  return frame->m_Elems != nullptr ? frame->m_Next < frame->m_ElemCount : frame->m_Next != kMemberIdxTail;
+}
+
+//---------------------------------------------------------------------------------
+// Moves the frame on to its next child. out_member is only set for objects.
+// returns false once there are no children left
+inline bool gj_nextWalkChild( _gjWalkFrame* frame, gjValue* out_child, const _gjMember** out_member )
+{
+  if ( gj_hasWalkChild( frame ) == false )
+  {
+    return false;
+  }
+
+  frame->m_Visited++;
+  if ( frame->m_Elems != nullptr )
+  {
+    *out_child  = frame->m_Elems[ frame->m_Next++ ].m_Value;
+    *out_member = nullptr;
+  }
+  else
+  {
+    const _gjMember* member = gj_getMemberSlot( frame->m_Next );
+    frame->m_Next = member->m_Next;
+    *out_child    = member->m_Value;
+    *out_member   = member;
+  }
+
+  return true;
+}
+
+//---------------------------------------------------------------------------------
+// frees what a value owns, apart from the values inside it
+void gj_releaseValueData( _gjValue* val )
+{
+  const uint8_t flags = val->m_Flags;
+  val->m_Flags = 0;
+
+  if ( VAL_TYPE( val ) == gjValueType::kString )
+  {
+    if ( ( flags & kValueFlagBorrowedStr ) == 0 )
+    {
+      gj_free( val->m_Str );
+    }
+  }
+  else if ( VAL_TYPE( val ) == gjValueType::kArray )
+  {
+    if ( val->m_Array.m_Idx != kArrayIdxTail )
+    {
+      gj_freeArrayRun( val->m_Array.m_Idx );
+    }
+  }
+  else if ( VAL_TYPE( val ) == gjValueType::kObject )
+  {
+    if ( gj_getObjectHeader( val ) != nullptr )
+    {
+      gj_freeMemberList( val->m_ObjectStart, ( flags & kValueFlagBorrowedKeys ) == 0 );
+    }
+  }
+}
+
+//---------------------------------------------------------------------------------
+// Frees everything val owns, including the values inside it, but not val's own slot
+void gj_freeValueData( _gjValue* val )
+{
+  if ( gj_isContainer( val ) == false )
+  {
+    gj_releaseValueData( val );
+    return;
+  }
+
+  _gjWalkStack stack;
+  _gjWalkFrame frame;
+  gj_initWalkStack ( &stack );
+  gj_startWalkFrame( &frame, val, kValueIdxTail );
+
+  do
+  {
+    gjValue          child;
+    const _gjMember* member;
+    while ( gj_nextWalkChild( &frame, &child, &member ) )
+    {
+      if ( gj_isValueAlloced( child.idx, child.gen ) )
+      {
+        _gjValue* child_val = gj_getValueSlot( child.idx );
+        if ( gj_isContainer( child_val ) && gj_pushWalkFrame( &stack, &frame ) )
+        {
+          gj_startWalkFrame( &frame, child_val, child.idx );
+        }
+        else
+        {
+          gj_releaseValueData( child_val );
+          gj_freeValue       ( child.idx );
+        }
+      }
+    }
+
+    // the children are gone, so the container's own storage can go too
+    gj_releaseValueData( frame.m_Val );
+    if ( frame.m_ValueIdx != kValueIdxTail )
+    {
+      gj_freeValue( frame.m_ValueIdx );
+    }
+  }
+  while ( gj_popWalkFrame( &stack, &frame ) );
+
+  gj_releaseWalkStack( &stack );
+}
+
+//---------------------------------------------------------------------------------
+//
+// gjValue constructors
+// 
+//---------------------------------------------------------------------------------
+gjValue::gjValue()
+{
+  gen = (uint32_t)-1;
+  idx = (uint32_t)-1;
+}
+
+//---------------------------------------------------------------------------------
+gjValue::gjValue( int v )
+{
+  gen = (uint32_t)-1;
+  if ( _gjValue* val = gj_allocValue( &idx ) )
+  {
+    gen = val->m_Gen;
+    ASSIGN_VAL_TYPE( val, gjValueType::kNumber );
+    ASSIGN_VAL_SUBTYPE( val, kGjSubValueTypeInt );
+    val->m_Int     = v;
+  }
+}
+
+//---------------------------------------------------------------------------------
+gjValue::gjValue( uint64_t v )
+{
+  gen = (uint32_t)-1;
+  if ( _gjValue* val = gj_allocValue( &idx ) )
+  {
+    gen = val->m_Gen;
+    ASSIGN_VAL_TYPE( val, gjValueType::kNumber );
+    ASSIGN_VAL_SUBTYPE( val, kGjSubValueTypeU64 );
+    val->m_U64     = v;
+  }
+}
+
+//---------------------------------------------------------------------------------
+gjValue::gjValue( float v )
+{
+  gen = (uint32_t)-1;
+  if ( _gjValue* val = gj_allocValue( &idx ) )
+  {
+    gen = val->m_Gen;
+    ASSIGN_VAL_TYPE( val, gjValueType::kNumber );
+    ASSIGN_VAL_SUBTYPE( val, kGjSubValueTypeFloat );
+    val->m_Float   = v;
+  }
+}
+
+//---------------------------------------------------------------------------------
+gjValue::gjValue( bool v )
+{
+  gen = (uint32_t)-1;
+  if ( _gjValue* val = gj_allocValue( &idx ) )
+  {
+    gen = val->m_Gen;
+    ASSIGN_VAL_TYPE( val, gjValueType::kBool );
+    ASSIGN_VAL_SUBTYPE( val, kGjSubValueTypeInvalid );
+    val->m_Bool    = v;
+  }
+}
+
+//---------------------------------------------------------------------------------
+gjValue::gjValue( const char* v )
+{
+  gen = (uint32_t)-1;
+  if ( _gjValue* val = gj_allocValue( &idx ) )
+  {
+    gen = val->m_Gen;
+    ASSIGN_VAL_TYPE( val, gjValueType::kString );
+    ASSIGN_VAL_SUBTYPE( val, kGjSubValueTypeInvalid );
+
+    size_t str_len = gj_StrLen( v );
+    val->m_Str = (char*)gj_malloc( str_len + 1, "Value String" );
+    if ( val->m_Str != nullptr )
+    {
+      memcpy( val->m_Str, v, str_len );
+      val->m_Str[ str_len ] = '\0';
+    }
+    else
+    {
+      val->m_Gen++;
+      gj_freeValue( idx );
+    }
+  }
+}
+
+//---------------------------------------------------------------------------------
+//
+// gjValue getters
+// 
+//---------------------------------------------------------------------------------
+gjValueType gjValue::getType() const
+{
+  if ( gj_isValueAlloced( idx, gen ) )
+  {
+    _gjValue* val = gj_getValueSlot( idx );
+    return VAL_TYPE( val );
+  }
+ 
+  return gjValueType::kNull;
+}
+
+//---------------------------------------------------------------------------------
+int gjValue::getInt() const
+{
+  if ( gj_isValueAlloced( idx, gen ) )
+  {
+    _gjValue* val = gj_getValueSlot( idx );
+    if ( VAL_TYPE( val ) == gjValueType::kNumber)
+    {
+      switch ( VAL_SUBTYPE( val ) )
+      {
+      case kGjSubValueTypeInt:
+      {
+        return val->m_Int;
+      }
+      break;
+      case kGjSubValueTypeU64:
+      {
+        return (int)val->m_U64;
+      }
+      break;
+      case kGjSubValueTypeFloat:
+      {
+        return (int)val->m_Float;
+      }
+      break;
+      }
+    }
+    else
+    {
+      gj_assert( "Attempting to get int for json value that is not a number" );
+    }
+  }
+  else
+  {
+    gj_assert( "Attempting to get int for deallocated json value" );
+  }
+
+  return 0;
+}
+
+//---------------------------------------------------------------------------------
+uint64_t gjValue::getU64() const
+{
+  if ( gj_isValueAlloced( idx, gen ) )
+  {
+    _gjValue* val = gj_getValueSlot( idx );
+    if ( VAL_TYPE( val ) == gjValueType::kNumber )
+    {
+      switch ( VAL_SUBTYPE( val ) )
+      {
+      case kGjSubValueTypeInt:
+      {
+        return (uint64_t)val->m_Int;
+      }
+      break;
+      case kGjSubValueTypeU64:
+      {
+        return val->m_U64;
+      }
+      break;
+      case kGjSubValueTypeFloat:
+      {
+        return (uint64_t)val->m_Float;
+      }
+      break;
+      }
+    }
+    else
+    {
+      gj_assert( "Attempting to get u64 for json value that is not a number" );
+    }
+  }
+  else
+  {
+    gj_assert( "Attempting to get u64 for deallocated json value" );
+  }
+
+  return 0;
+}
+
+//---------------------------------------------------------------------------------
+float gjValue::getFloat() const
+{
+  if ( gj_isValueAlloced( idx, gen ) )
+  {
+    _gjValue* val = gj_getValueSlot( idx );
+    if ( VAL_TYPE( val ) == gjValueType::kNumber )
+    {
+      switch ( VAL_SUBTYPE( val ) )
+      {
+      case kGjSubValueTypeInt:
+      {
+        return (float)val->m_Int;
+      }
+      break;
+      case kGjSubValueTypeU64:
+      {
+        return (float)val->m_U64;
+      }
+      break;
+      case kGjSubValueTypeFloat:
+      {
+        return val->m_Float;
+      }
+      break;
+      }
+        
+    }
+    else
+    {
+      gj_assert( "Attempting to get float for json value that is not a number" );
+    }
+  }
+  else
+  {
+    gj_assert( "Attempting to get float for deallocated json value" );
+  }
+
+  return 0;
+}
+
+//---------------------------------------------------------------------------------
+const char* gjValue::getString() const
+{
+  if ( gj_isValueAlloced( idx, gen ) )
+  {
+    _gjValue* val = gj_getValueSlot( idx );
+    if ( VAL_TYPE( val ) == gjValueType::kString )
+    {
+      return val->m_Str;
+    }
+    else
+    {
+      gj_assert( "Attempting to get string for json value that is not a string" );
+    }
+  }
+  else
+  {
+    gj_assert( "Attempting to get string for deallocated json value" );
+  }
+
+  return nullptr;
+}
+
+//---------------------------------------------------------------------------------
+bool gjValue::getBool() const
+{
+  if ( gj_isValueAlloced( idx, gen ) )
+  {
+    _gjValue* val = gj_getValueSlot( idx );
+    if ( VAL_TYPE( val ) == gjValueType::kBool )
+    {
+      return val->m_Bool;
+    }
+    else
+    {
+      gj_assert( "Attempting to get bool for json value that is not a bool" );
+    }
+  }
+  else
+  {
+    gj_assert( "Attempting to get bool for deallocated json value" );
+  }
+
+  return false;
+}
+
+//---------------------------------------------------------------------------------
+//
+// Serialize cache
+//
+//---------------------------------------------------------------------------------
+// A gjSerializer with cache_subtrees keeps its last output, and this table remembers
+// where each container's text sits in it so the next serialize can copy the text of
+// containers that haven't changed instead of walking them again. There's a slot per
+// value. Values don't know their container, so the slot links back to it, and an
+// edit follows those links to mark every container above it as dirty. A container's
+// offset is kept from the start of its parent's text, so the offsets inside a copied
+// container stay right wherever the copy lands.
+struct _gjCacheSlot
+{
+  uint32_t m_Gen;       // of the value the slot was filled in for
+  uint32_t m_ParentIdx; // kValueIdxTail when it isn't in a container
+  uint32_t m_ParentGen;
+  uint32_t m_Owner;     // the serializer whose output holds the text, 0 for none
+  uint32_t m_Offset;    // from the start of the parent's text
+  uint32_t m_Len;
+  uint32_t m_Depth;
+  uint32_t m_Dirty;
+};
+
+//---------------------------------------------------------------------------------
+struct _gjSerializeCache
+{
+  _gjCacheSlot* m_Slots;
+  uint32_t      m_SlotCount;
+  uint32_t      m_NextOwner;
+  size_t        m_Bytes;      // the slots plus the outputs kept for them
+  size_t        m_PeakBytes;
+};
+
+static _gjSerializeCache s_SerializeCache = { nullptr, 0, 1, 0, 0 };
+
+//---------------------------------------------------------------------------------
+void gj_addCacheBytes( size_t bytes )
+{
+  s_SerializeCache.m_Bytes += bytes;
+  if ( s_SerializeCache.m_Bytes > s_SerializeCache.m_PeakBytes )
+  {
+    s_SerializeCache.m_PeakBytes = s_SerializeCache.m_Bytes;
+  }
+}
+
+//---------------------------------------------------------------------------------
+void gj_removeCacheBytes( size_t bytes )
+{
+  // serializers can outlive gj_shutdown, which has already zeroed the count
+  s_SerializeCache.m_Bytes -= bytes < s_SerializeCache.m_Bytes ? bytes : s_SerializeCache.m_Bytes;
+}
+
+//---------------------------------------------------------------------------------
+// grows the table to cover slot_count values, doubling it when the budget allows.
+// returns false if it can't cover them without going over budget
+bool gj_reserveCacheSlots( uint32_t slot_count )
+{
+  if ( slot_count <= s_SerializeCache.m_SlotCount )
+  {
+    return true;
+  }
+
+  const size_t old_bytes = s_SerializeCache.m_SlotCount * sizeof( _gjCacheSlot );
+  const size_t room      = s_Config.serialize_cache_budget - ( s_SerializeCache.m_Bytes - old_bytes );
+  if ( s_SerializeCache.m_Bytes - old_bytes > s_Config.serialize_cache_budget || slot_count * sizeof( _gjCacheSlot ) > room )
+  {
+    return false;
+  }
+
+  const uint32_t doubled = s_SerializeCache.m_SlotCount * 2 < s_ValuePool.m_Capacity ? s_SerializeCache.m_SlotCount * 2 : s_ValuePool.m_Capacity;
+  if ( doubled > slot_count && doubled * sizeof( _gjCacheSlot ) <= room )
+  {
+    slot_count = doubled;
+  }
+
+  const size_t new_bytes = slot_count * sizeof( _gjCacheSlot );
+
+  _gjCacheSlot* slots = (_gjCacheSlot*)gj_malloc( new_bytes, "gj: serialize cache slots" );
+  if ( slots == nullptr )
+  {
+    return false;
+  }
+
+  if ( s_SerializeCache.m_Slots != nullptr )
+  {
+    memcpy( slots, s_SerializeCache.m_Slots, old_bytes );
+    gj_free( s_SerializeCache.m_Slots );
+  }
+
+  for ( uint32_t i = s_SerializeCache.m_SlotCount; i < slot_count; ++i )
+  {
+    slots[ i ]             = _gjCacheSlot{};
+    slots[ i ].m_ParentIdx = kValueIdxTail;
+  }
+
+  s_SerializeCache.m_Slots     = slots;
+  s_SerializeCache.m_SlotCount = slot_count;
+  gj_removeCacheBytes( old_bytes );
+  gj_addCacheBytes   ( new_bytes );
+  return true;
+}
+
+//---------------------------------------------------------------------------------
+void gj_shutdownSerializeCache()
+{
+  if ( s_SerializeCache.m_Slots != nullptr )
+  {
+    gj_free( s_SerializeCache.m_Slots );
+  }
+
+  // owners keep counting up, so a serializer that outlives this never matches a slot
+  s_SerializeCache.m_Slots     = nullptr;
+  s_SerializeCache.m_SlotCount = 0;
+  s_SerializeCache.m_Bytes     = 0;
+  s_SerializeCache.m_PeakBytes = 0;
+}
+
+//---------------------------------------------------------------------------------
+// Marks the value and every container above it as changed. A value the table doesn't
+// know about stops the climb, which is fine: it was added since its container was
+// last serialized, and adding it already marked the container
+inline void gj_markCacheDirty( gjValue value )
+{
+  uint32_t idx     = value.idx;
+  uint32_t val_gen = value.gen;
+  while ( idx < s_SerializeCache.m_SlotCount )
+  {
+    _gjCacheSlot* slot = &s_SerializeCache.m_Slots[ idx ];
+    if ( slot->m_Gen != val_gen || gj_isValueAlloced( idx, val_gen ) == false )
+    {
+      return;
+    }
+
+    slot->m_Dirty = 1;
+    idx           = slot->m_ParentIdx;
+    val_gen       = slot->m_ParentGen;
+  }
+}
+
+//---------------------------------------------------------------------------------
+// Points the slot of a value that was just put into a container back at it
+void gj_linkCachedValue( gjValue value, gjValue parent )
+{
+  if ( value.idx < s_SerializeCache.m_SlotCount )
+  {
+    _gjCacheSlot* slot = &s_SerializeCache.m_Slots[ value.idx ];
+    slot->m_Gen       = value.gen;
+    slot->m_ParentIdx = parent.idx;
+    slot->m_ParentGen = parent.gen;
+    slot->m_Owner     = 0;
+    slot->m_Dirty     = 1;
+  }
+}
+
+//---------------------------------------------------------------------------------
+void gj_unlinkCachedValue( gjValue value )
+{
+  if ( value.idx < s_SerializeCache.m_SlotCount && s_SerializeCache.m_Slots[ value.idx ].m_Gen == value.gen )
+  {
+    s_SerializeCache.m_Slots[ value.idx ].m_ParentIdx = kValueIdxTail;
+    s_SerializeCache.m_Slots[ value.idx ].m_Owner     = 0;
+  }
+}
+
+//---------------------------------------------------------------------------------
+//
+// gjValue setters
+// 
+//---------------------------------------------------------------------------------
+void gjValue::setInt( int v )
+{
+  if ( gj_isValueAlloced( idx, gen ) )
+  {
+    _gjValue* val = gj_getValueSlot( idx );
+    gj_freeValueData( val );
+
+    ASSIGN_VAL_TYPE( val, gjValueType::kNumber );
+    ASSIGN_VAL_SUBTYPE( val, kGjSubValueTypeInt );
+    val->m_Int     = v;
+    gj_markCacheDirty( *this );
+  }
+}
+
+//---------------------------------------------------------------------------------
+void gjValue::setU64( uint64_t v )
+{
+  if ( gj_isValueAlloced( idx, gen ) )
+  {
+    _gjValue* val = gj_getValueSlot( idx );
+    gj_freeValueData( val );
+
+    ASSIGN_VAL_TYPE( val, gjValueType::kNumber );
+    ASSIGN_VAL_SUBTYPE( val, kGjSubValueTypeU64 );
+    val->m_U64     = v;
+    gj_markCacheDirty( *this );
+  }
+}
+
+//---------------------------------------------------------------------------------
+void gjValue::setFloat( float v )
+{
+  if ( gj_isValueAlloced( idx, gen ) )
+  {
+    _gjValue* val = gj_getValueSlot( idx );
+    gj_freeValueData( val );
+
+    ASSIGN_VAL_TYPE( val, gjValueType::kNumber );
+    ASSIGN_VAL_SUBTYPE( val, kGjSubValueTypeFloat );
+    val->m_Float   = v;
+    gj_markCacheDirty( *this );
+  }
+}
+
+//---------------------------------------------------------------------------------
+void gjValue::setString( const char* str )
+{
+  if ( gj_isValueAlloced( idx, gen ) )
+  {
+    _gjValue* val = gj_getValueSlot( idx );
+    gj_freeValueData( val );
+
+    ASSIGN_VAL_TYPE( val, gjValueType::kString );
+    ASSIGN_VAL_SUBTYPE( val, kGjSubValueTypeInvalid );
+
+    const size_t str_len = gj_StrLen( str );
+    val->m_Str     = (char*)gj_malloc( str_len + 1, "setString string" );
+    memcpy( val->m_Str, str, str_len );
+    val->m_Str[ str_len ] = '\0';
+    gj_markCacheDirty( *this );
+  }
+}
+
+//---------------------------------------------------------------------------------
+void gjValue::setBool( bool v )
+{
+  if ( gj_isValueAlloced( idx, gen ) )
+  {
+    _gjValue* val = gj_getValueSlot( idx );
+    gj_freeValueData( val );
+
+    ASSIGN_VAL_TYPE( val, gjValueType::kBool );
+    ASSIGN_VAL_SUBTYPE( val, kGjSubValueTypeInvalid );
+    val->m_Float   = v;
+    gj_markCacheDirty( *this );
+  }
+}
+
+//---------------------------------------------------------------------------------
+void gjValue::setNull()
+{
+  if ( gj_isValueAlloced( idx, gen ) )
+  {
+    _gjValue* val = gj_getValueSlot( idx );
+    gj_freeValueData( val );
+
+    ASSIGN_VAL_TYPE( val, gjValueType::kNull );
+    ASSIGN_VAL_SUBTYPE( val, kGjSubValueTypeInvalid );
+    gj_markCacheDirty( *this );
+  }
+}
+
+//---------------------------------------------------------------------------------
+//
+// gjValue assignment operators
+// 
+//---------------------------------------------------------------------------------
+gjValue& gjValue::operator=( int v )
+{
+  setInt( v );
+  return *this;
+}
+
+//---------------------------------------------------------------------------------
+gjValue& gjValue::operator=( uint64_t v )
+{
+  setU64( v );
+  return *this;
+}
+
+//---------------------------------------------------------------------------------
+gjValue& gjValue::operator=( float v )
+{
+  setFloat( v );
+  return *this;
+}
+
+//---------------------------------------------------------------------------------
+gjValue& gjValue::operator=( const char* v )
+{
+  setString( v );
+  return *this;
+}
+
+//---------------------------------------------------------------------------------
+gjValue& gjValue::operator=( bool v )
+{
+  setBool( v );
+  return *this;
+}
+
+//---------------------------------------------------------------------------------
+//
+// Make Deep Copy
+//
+//---------------------------------------------------------------------------------
+// Copies a value on its own. A copied container starts out empty, apart from an
+// array's run being allocated ready for the elements. returns the copy's slot, or
+// null if there's no copy
+_gjValue* gj_copyValueData( gjValue val_handle, gjValue* out_copy )
+{
+  *out_copy = gjValue();
+  if ( gj_isValueAlloced( val_handle.idx, val_handle.gen ) == false )
+  {
+    return nullptr;
+  }
+
+  const _gjValue* val      = gj_getValueSlot( val_handle.idx );
+  _gjValue*       val_copy = gj_allocValue( &out_copy->idx );
+  if ( val_copy == nullptr )
+  {
+    gj_assert( "backing data is not large enough to make deep copy" );
+    return nullptr;
+  }
+
+  out_copy->gen = val_copy->m_Gen;
+
+  val_copy->m_TypeGroup = val->m_TypeGroup;
+  switch ( VAL_TYPE( val ) )
+  {
+  case gjValueType::kBool:
+  {
+    val_copy->m_Bool = val->m_Bool;
+  }
+  break;
+  case gjValueType::kString:
+  {
+    size_t sz = gj_StrLen( val->m_Str ) + 1;
+    val_copy->m_Str = (char*)gj_malloc( sz, "string value" );
+    memcpy( val_copy->m_Str, val->m_Str, sz );
+  }
+  break;
+  case gjValueType::kNumber:
+  {
+    switch ( VAL_SUBTYPE( val ) )
+    {
+      case kGjSubValueTypeInt:
+      {
+        val_copy->m_Int = val->m_Int;
+      }
+      break;
+      case kGjSubValueTypeU64:
+      {
+        val_copy->m_U64 = val->m_U64;
+      }
+      break;
+      case kGjSubValueTypeFloat:
+      {
+        val_copy->m_Float = val->m_Float;
+      }
+      break;
+    }
+  }
+  break;
+  case gjValueType::kArray:
+  {
+    val_copy->m_Array.m_Idx   = kArrayIdxTail;
+    val_copy->m_Array.m_Count = 0;
+
+    const _gjArrayStorage arr = val->m_Array;
+    if ( arr.m_Count != 0 )
+    {
+      const uint32_t run_idx = gj_allocArrayRun( (uint64_t)arr.m_Count + 1 );
+      if ( run_idx != kArrayIdxTail )
+      {
+        val_copy->m_Array.m_Idx   = run_idx;
+        val_copy->m_Array.m_Count = arr.m_Count;
+      }
+      else
+      {
+        gj_assert( "Attempting to copy an array, but the array pool is full. You may be out of memory" );
+      }
+    }
+  }
+  break;
+  case gjValueType::kObject:
+  {
+    val_copy->m_ObjectStart.m_Idx = kMemberIdxTail;
+    val_copy->m_ObjectStart.m_Gen = (uint32_t)-1;
+  }
+  break;
+  }
+
+  return val_copy;
+}
+
+//---------------------------------------------------------------------------------
+// An array whose run couldn't be allocated stays empty, so there's nothing to walk
+inline bool gj_hasCopyStorage( const _gjValue* val_copy )
+{
+  return VAL_TYPE( val_copy ) == gjValueType::kObject
+      || ( VAL_TYPE( val_copy ) == gjValueType::kArray && val_copy->m_Array.m_Idx != kArrayIdxTail );
+}
+
+//---------------------------------------------------------------------------------
+gjValue gjValue::makeDeepCopy() const
+{
+  gjValue   copy_val;
+  _gjValue* val_copy = gj_copyValueData( *this, &copy_val );
+  if ( val_copy == nullptr || gj_hasCopyStorage( val_copy ) == false )
+  {
+    return copy_val;
+  }
+
+  _gjWalkStack stack;
+  _gjWalkFrame frame;
+  gj_initWalkStack ( &stack );
+  gj_startWalkFrame( &frame, gj_getValueSlot( idx ), kValueIdxTail );
+  frame.m_Copy = val_copy;
+
+  do
+  {
+    gjValue          child;
+    const _gjMember* member;
+    while ( gj_nextWalkChild( &frame, &child, &member ) )
+    {
+      gjValue   child_copy;
+      _gjValue* child_val_copy;
+      if ( member == nullptr )
+      {
+        child_val_copy = gj_copyValueData( child, &child_copy );
+        gj_getArrayElems( frame.m_Copy->m_Array )[ frame.m_Next - 1 ].m_Value = child_copy;
+      }
+      else
+      {
+        _gjMember* new_member = gj_allocMember( frame.m_Copy, member->m_KeyHash );
+        if ( new_member == nullptr )
+        {
+          gj_assert( "Attempting to copy an object, but the member pool is full. You may be out of memory" );
+          break;
+        }
+
+        const size_t str_len  = gj_StrLen( member->m_KeyStr ) + 1;
+        new_member->m_KeyStr  = (char*)gj_malloc( str_len, "Object Member Key" );
+        memcpy( new_member->m_KeyStr, member->m_KeyStr, str_len );
+
+        child_val_copy        = gj_copyValueData( child, &child_copy );
+        new_member->m_Value   = child_copy;
+      }
+
+      if ( child_val_copy != nullptr && gj_hasCopyStorage( child_val_copy ) && gj_pushWalkFrame( &stack, &frame ) )
+      {
+        gj_startWalkFrame( &frame, gj_getValueSlot( child.idx ), child.idx );
+        frame.m_Copy = child_val_copy;
+      }
+    }
+  }
+  while ( gj_popWalkFrame( &stack, &frame ) );
+
+  gj_releaseWalkStack( &stack );
+  return copy_val;
+}
+
+//---------------------------------------------------------------------------------
+//
+// Array operations
+//
+//---------------------------------------------------------------------------------
+uint32_t gjValue::getElementCount() const
+{
+  if ( gj_isValueAlloced( idx, gen ) )
+  {
+    const _gjValue* val = gj_getValueSlot( idx );
+    if ( VAL_TYPE( val ) == gjValueType::kArray )
+    {
+      return val->m_Array.m_Count;
+    }
+    else
+    {
+      gj_assert( "Attempting to get element count for json value that is not a array" );
+    }
+  }
+  else
+  {
+    gj_assert( "Attempting to get element count for deallocated json value" );
+  }
+
+  return 0;
+}
+
+//---------------------------------------------------------------------------------
+gjValue gjValue::getElement( uint32_t elem_idx ) const
+{
+  if ( gj_isValueAlloced( idx, gen ) )
+  {
+    const _gjValue* val = gj_getValueSlot( idx );
+    if ( VAL_TYPE( val ) == gjValueType::kArray )
+    {
+      return elem_idx < val->m_Array.m_Count ? gj_getArrayElems( val->m_Array )[ elem_idx ].m_Value : gjValue();
+    }
+    else
+    {
+      gj_assert( "Attempting to get element for json value that is not a array" );
+    }
+  }
+  else
+  {
+    gj_assert( "Attempting to get element for deallocated json value" );
+  }
+
+  return gjValue{};
+}
+
+//---------------------------------------------------------------------------------
+gjValue gjValue::operator[]( uint32_t elem_idx ) const
+{
+  return getElement( elem_idx );
+}
+
+//---------------------------------------------------------------------------------
+void gjValue::insertElement( gjValue value, uint32_t insert_idx )
+{
+  if ( gj_isValueAlloced( idx, gen ) )
+  {
+    _gjValue* val = gj_getValueSlot( idx );
+    if ( VAL_TYPE( val ) == gjValueType::kArray )
+    {
+      _gjArrayElem* elems = gj_reserveArrayElem( val );
+
+      if ( elems != nullptr )
+      {
+        const uint32_t count = val->m_Array.m_Count;
+        if ( insert_idx > count )
+        {
+          insert_idx = count;
+        }
+
+        memmove( elems + insert_idx + 1, elems + insert_idx, ( count - insert_idx ) * sizeof( _gjArrayElem ) );
+        elems[ insert_idx ].m_Value = value;
+        val->m_Array.m_Count++;
+        gj_markCacheDirty ( *this );
+        gj_linkCachedValue( value, *this );
+      }
+      else
+      {
+        gj_assert( "Attempting to create array element, but the array pool is full. You may be out of memory" );
+      }
+    }
+    else
+    {
+      gj_assert( "Attempting to insert element into a value that isn't an array" );
+    }
+  }
+  else
+  {
+    gj_assert( "Attempting to insert element into a value that has been freed" );
+  }
+}
+
+//---------------------------------------------------------------------------------
+void gjValue::removeElement( uint32_t remove_idx )
+{
+  if ( gj_isValueAlloced( idx, gen ) )
+  {
+    _gjValue* val = gj_getValueSlot( idx );
+    if ( VAL_TYPE( val ) == gjValueType::kArray)
+    {
+      const gjValue removed = gj_takeArrayElem( val, remove_idx );
+      gj_markCacheDirty( *this );
+      if ( gj_isValueAlloced( removed.idx, removed.gen ) )
+      {
+        gj_freeValueData( gj_getValueSlot( removed.idx ) );
+        gj_freeValue    ( removed.idx );
+      }
+    }
+    else
+    {
+      gj_assert( "Attempting to remove element into a value that isn't an array" );
+    }
+  }
+  else
+  {
+    gj_assert( "Attempting to remove element from a value that has been freed" );
+  }
+}
+
+//---------------------------------------------------------------------------------
+gjValue gjValue::detachElement( uint32_t detach_idx )
+{
+  if ( gj_isValueAlloced( idx, gen ) )
+  {
+    _gjValue* val = gj_getValueSlot( idx );
+    if ( VAL_TYPE( val ) == gjValueType::kArray)
+    {
+      const gjValue detached = gj_takeArrayElem( val, detach_idx );
+      gj_markCacheDirty   ( *this );
+      gj_unlinkCachedValue( detached );
+      return detached;
+    }
+    else
+    {
+      gj_assert( "Attempting to remove element into a value that isn't an array" );
+    }
+  }
+  else
+  {
+    gj_assert( "Attempting to remove element from a value that has been freed" );
+  }
+
+  return gjValue{};
+}
+
+//---------------------------------------------------------------------------------
+void gjValue::clearArray()
+{
+  if ( gj_isValueAlloced( idx, gen ) )
+  {
+    _gjValue* val = gj_getValueSlot( idx );
+    if ( VAL_TYPE( val ) == gjValueType::kArray)
+    {
+      gj_freeValueData( val );
+      val->m_Array.m_Idx   = kArrayIdxTail;
+      val->m_Array.m_Count = 0;
+      gj_markCacheDirty( *this );
+    }
+    else
+    {
+      gj_assert( "Attempting to clear array on a value that isn't an array" );
+    }
+  }
+  else
+  {
+    gj_assert( "Attempting to clear array on a value that has been freed" );
+  }
+}
+
+//---------------------------------------------------------------------------------
+//
+// Object operations
+//
+//---------------------------------------------------------------------------------
+uint32_t gjValue::getMemberCount() const
+{
+  if ( gj_isValueAlloced( idx, gen ) )
+  {
+    const _gjValue* val = gj_getValueSlot( idx );
+    if ( VAL_TYPE( val ) == gjValueType::kObject )
+    {
+      if ( const _gjMember* header = gj_getObjectHeader( val ) )
+      {
+        return header->m_MemberCount;
+      }
+
+      return 0;
+    }
+    else
+    {
+      gj_assert( "Attempting to get member count for json value that is not an object" );
+    }
+  }
+  else
+  {
+    gj_assert( "Attempting to get member count for deallocated json value" );
+  }
+
+  return 0;
+}
+
+//---------------------------------------------------------------------------------
+gjValue gjValue::operator[]( const char* key ) const
+{
+  return getMember( key );
+}
+
+//---------------------------------------------------------------------------------
+gjValue gjValue::getMember( const char* key ) const
+{
+  return getMember( gj_crc32( key ) );
+}
+
+//---------------------------------------------------------------------------------
+gjValue gjValue::getMember( uint32_t key_crc32 ) const
+{
+  if ( gj_isValueAlloced( idx, gen ) )
+  {
+    const _gjValue* val = gj_getValueSlot( idx );
+    if ( VAL_TYPE( val ) == gjValueType::kObject )
+    {
+      _gjMember* header = gj_getObjectHeader( val );
+      if ( header != nullptr && header->m_Next != kMemberIdxTail )
+      {
+        const uint32_t member_idx = gj_findMember( header, key_crc32 );
+        if ( member_idx != kMemberIdxTail )
+        {
+          return gj_getMemberSlot( member_idx )->m_Value;
+        }
+        else
+        {
+          gj_assert( "Attempting to get member that does not exist in object" );
+        }
+      }
+      else
+      {
+        gj_assert( "Attempting to get member in an empty object" );
+      }
+    }
+    else
+    {
+      gj_assert( "Attempting to get member from a value that isn't an object" );
+    }
+  }
+  else
+  {
+    gj_assert( "Attempting to get member from a value that has been freed" );
+  }
+
+  return gjValue();
+}
+
+//---------------------------------------------------------------------------------
+bool gjValue::hasMember( const char* key ) const
+{
+  return hasMember( gj_crc32( key ) );
+}
+
+//---------------------------------------------------------------------------------
+bool gjValue::hasMember( uint32_t key_crc32 ) const
+{
+  if ( gj_isValueAlloced( idx, gen ) )
+  {
+    const _gjValue* val = gj_getValueSlot( idx );
+    if ( VAL_TYPE( val ) == gjValueType::kObject )
+    {
+      _gjMember* header = gj_getObjectHeader( val );
+      if ( header == nullptr )
+      {
+        return false;
+      }
+
+      return gj_findMember( header, key_crc32 ) != kMemberIdxTail;
+    }
+    else
+    {
+      gj_assert( "Attempting to get member from a value that isn't an object" );
+    }
+  }
+  else
+  {
+    gj_assert( "Attempting to get member from a value that has been freed" );
+  }
+
+  return false;
+}
+
+//---------------------------------------------------------------------------------
+void gjValue::addMember( const char* key, gjValue value )
+{
+  if ( gj_isValueAlloced( idx, gen ) )
+  {
+    _gjValue* val = gj_getValueSlot( idx );
+    if ( VAL_TYPE( val ) == gjValueType::kObject )
+    {
+      if ( val->m_Flags & kValueFlagBorrowedKeys )
+      {
+        gj_copyBorrowedKeys( val );
+      }
+
+      _gjMember* member = gj_allocMember( val, gj_crc32( key ) );
+
+      if ( member != nullptr )
+      {
+        const size_t key_str_size = gj_StrLen( key );
+        member->m_KeyStr = (char*)gj_malloc( key_str_size + 1, "Object Key String" );
+        memcpy( member->m_KeyStr, key, key_str_size );
+        member->m_KeyStr[ key_str_size ] = '\0';
+        member->m_Value   = value;
+        gj_markCacheDirty ( *this );
+        gj_linkCachedValue( value, *this );
+      }
+      else
+      {
+        gj_assert( "Attempting to create object member, but the  member pool is full. You may be out of memory" );
+      }
+    }
+    else
+    {
+      gj_assert( "Attempting to add member to a value that isn't an object" );
+    }
+  }
+  else
+  {
+    gj_assert( "Attempting to add member to a value that has been freed" );
+  }
+}
+
+//---------------------------------------------------------------------------------
+void gjValue::removeMember( const char* key )
+{
+  removeMember( gj_crc32( key ) );
+}
+
+//---------------------------------------------------------------------------------
+void gjValue::removeMember( uint32_t key_crc32 )
+{
+  if ( gj_isValueAlloced( idx, gen ) )
+  {
+    _gjValue* val = gj_getValueSlot( idx );
+    if ( VAL_TYPE( val ) == gjValueType::kObject )
+    {
+      _gjMember*     header     = gj_getObjectHeader( val );
+      const uint32_t member_idx = header != nullptr ? gj_findMember( header, key_crc32 ) : kMemberIdxTail;
+      if ( member_idx != kMemberIdxTail )
+      {
+        const _gjMember* freed_elem = gj_freeMember( header, member_idx, ( val->m_Flags & kValueFlagBorrowedKeys ) == 0 );
+        gj_markCacheDirty( *this );
+        if ( gj_isValueAlloced( freed_elem->m_Value.idx, freed_elem->m_Value.gen ) )
+        {
+          gj_freeValueData( gj_getValueSlot( freed_elem->m_Value.idx ) );
+          gj_freeValue    ( freed_elem->m_Value.idx );
+        }
+      }
+      else
+      {
+        gj_assert( "Attempting to remove member that does not exist in object" );
+      }
+    }
+    else
+    {
+      gj_assert( "Attempting to remove member from a value that isn't an object" );
+    }
+  }
+  else
+  {
+    gj_assert( "Attempting to remove member from a value that has been freed" );
+  }
+}
+
+//---------------------------------------------------------------------------------
+gjValue gjValue::detachMember( const char* key )
+{
+  return detachMember( gj_crc32( key ) );
+}
+
+//---------------------------------------------------------------------------------
+gjValue gjValue::detachMember( uint32_t key_crc32 )
+{
+  if ( gj_isValueAlloced( idx, gen ) )
+  {
+    _gjValue* val = gj_getValueSlot( idx );
+    if ( VAL_TYPE( val ) == gjValueType::kObject )
+    {
+      _gjMember*     header     = gj_getObjectHeader( val );
+      const uint32_t member_idx = header != nullptr ? gj_findMember( header, key_crc32 ) : kMemberIdxTail;
+      if ( member_idx != kMemberIdxTail )
+      {
+        const gjValue detached = gj_freeMember( header, member_idx, ( val->m_Flags & kValueFlagBorrowedKeys ) == 0 )->m_Value;
+        gj_markCacheDirty   ( *this );
+        gj_unlinkCachedValue( detached );
+        return detached;
+      }
+      else
+      {
+        gj_assert( "Attempting to detach member that does not exist in object" );
+      }
+    }
+    else
+    {
+      gj_assert( "Attempting to remove member from a value that isn't an object" );
+    }
+  }
+  else
+  {
+    gj_assert( "Attempting to remove member from a value that has been freed" );
+  }
+
+  return gjValue{};
+}
+
+//---------------------------------------------------------------------------------
+void gjValue::clearObject()
+{
+  if ( gj_isValueAlloced( idx, gen ) )
+  {
+    _gjValue* val = gj_getValueSlot( idx );
+    if ( VAL_TYPE( val ) == gjValueType::kObject)
+    {
+      gj_freeValueData( val );
+      val->m_ObjectStart.m_Idx = (uint32_t)-1;
+      val->m_ObjectStart.m_Gen = (uint32_t)-1;
+      gj_markCacheDirty( *this );
+    }
+    else
+    {
+      gj_assert( "Attempting to clear array on a value that isn't an array" );
+    }
+  }
+  else
+  {
+    gj_assert( "Attempting to clear array on a value that has been freed" );
+  }
+}
+
+//---------------------------------------------------------------------------------
+//
+// member iterators
+// 
+//---------------------------------------------------------------------------------
+gjMembers gjValue::members()
+{
+  gjMembers members;
+  members.value = *this;
+  return members;
+}
+
+//---------------------------------------------------------------------------------
+const gjMembers gjValue::members() const
+{
+  gjMembers members;
+  members.value = this;
+  return members;
+}
+
+//---------------------------------------------------------------------------------
+gjMembers::iterator gjMembers::begin()
+{
+  iterator it;
+  it.idx = kMemberIdxTail;
+  it.gen = (uint32_t)-1;
+  if ( gj_isValueAlloced( value.idx, value.gen ) )
+  {
+    const _gjMember* header = gj_getObjectHeader( gj_getValueSlot( value.idx ) );
+    if ( header != nullptr && header->m_Next != kMemberIdxTail )
+    {
+      it.idx = header->m_Next;
+      it.gen = gj_getMemberSlot( header->m_Next )->m_Gen;
+    }
+  }
+  return it;
+}
+
+//---------------------------------------------------------------------------------
+gjMembers::iterator gjMembers::end()
+{
+  iterator it;
+  it.idx = kMemberIdxTail;
+  it.gen = (uint32_t)-1;
+  return it;
+}
+
+//---------------------------------------------------------------------------------
+gjMembers::const_iterator gjMembers::begin() const
+{
+  const_iterator it;
+  it.idx = kMemberIdxTail;
+  it.gen = (uint32_t)-1;
+  if ( gj_isValueAlloced( value.idx, value.gen ) )
+  {
+    const _gjMember* header = gj_getObjectHeader( gj_getValueSlot( value.idx ) );
+    if ( header != nullptr && header->m_Next != kMemberIdxTail )
+    {
+      it.idx = header->m_Next;
+      it.gen = gj_getMemberSlot( header->m_Next )->m_Gen;
+    }
+  }
+  return it;
+}
+
+//---------------------------------------------------------------------------------
+gjMembers::const_iterator gjMembers::end() const
+{
+  const_iterator it;
+  it.idx = kMemberIdxTail;
+  it.gen = (uint32_t)-1;
+  return it;
+}
+
+//---------------------------------------------------------------------------------
+gjObjectMember gjMemberIterator::operator*()
+{
+  if ( idx < s_MemberPool.m_BumpIdx && gj_getMemberSlot( idx )->m_Gen == gen )
+  {
+    _gjMember* member = gj_getMemberSlot( idx );
+    return { member->m_KeyStr, member->m_Value };
+  }
+
+  return { nullptr, gjValue() };
+}
+
+//---------------------------------------------------------------------------------
+bool gjMemberIterator::operator==( const gjMemberIterator& other ) const
+{
+  return idx == other.idx && gen == other.gen;
+}
+
+//---------------------------------------------------------------------------------
+gjMemberIterator& gjMemberIterator::operator++()
+{
+  if ( idx < s_MemberPool.m_BumpIdx && gj_getMemberSlot( idx )->m_Gen == gen && gj_getMemberSlot( idx )->m_Next != kMemberIdxTail )
+  {
+    _gjMember* next = gj_getMemberSlot( gj_getMemberSlot( idx )->m_Next );
+    idx = gj_getMemberSlot( idx )->m_Next;
+    gen = next->m_Gen;
+  }
+  else
+  {
+    idx = kMemberIdxTail;
+    gen = (uint32_t)-1;
+  }
+
+  return *this;
+}
+
+//---------------------------------------------------------------------------------
+const gjObjectMember gjConstMemberIterator::operator*()
+{
+  if ( idx < s_MemberPool.m_BumpIdx && gj_getMemberSlot( idx )->m_Gen == gen )
+  {
+    _gjMember* member = gj_getMemberSlot( idx );
+    return { member->m_KeyStr, member->m_Value };
+  }
+
+  return { nullptr, gjValue() };
+}
+
+//---------------------------------------------------------------------------------
+bool gjConstMemberIterator::operator==( const gjConstMemberIterator& other ) const
+{
+  return idx == other.idx && gen == other.gen;
+}
+
+//---------------------------------------------------------------------------------
+gjConstMemberIterator& gjConstMemberIterator::operator++()
+{
+  if ( idx < s_MemberPool.m_BumpIdx && gj_getMemberSlot( idx )->m_Gen == gen && gj_getMemberSlot( idx )->m_Next != kMemberIdxTail )
+  {
+    _gjMember* next = gj_getMemberSlot( gj_getMemberSlot( idx )->m_Next );
+    idx = gj_getMemberSlot( idx )->m_Next;
+    gen = next->m_Gen;
+  }
+  else
+  {
+    idx = kMemberIdxTail;
+    gen = (uint32_t)-1;
+  }
+
+  return *this;
+}
+
+//---------------------------------------------------------------------------------
+//
+// sorting
+//
+//---------------------------------------------------------------------------------
+int gj_strcmp( const char* a, const char* b )
+{
+  uint32_t idx = 0;
+  while ( a[ idx ] != '\0' && b[ idx ] != '\0' )
+  {
+    int cmp = (int)a[ idx ] - (int)b[ idx ];
+    if ( cmp != 0 )
+    {
+      return cmp;
+    }
+    idx++;
+  }
+  return 0;
+}
+
+//---------------------------------------------------------------------------------
+void gj_swap( uint32_t* a, uint32_t* b )
+{
+  uint32_t tmp = *a;
+  *a = *b;
+  *b = tmp;
+}
+
+//---------------------------------------------------------------------------------
+uint32_t gj_quicksortPivot( uint32_t* key_idcs, uint32_t len )
+{
+  uint32_t  low_idx  = 0;
+  uint32_t* pivot_a  = &key_idcs[ len - 1 ];
+
+  for ( uint32_t upper_idx = 0; upper_idx < len - 1; ++upper_idx)
+  {
+    uint32_t* pivot_b = &key_idcs[ upper_idx ];
+    _gjMember* member_a = gj_getMemberSlot( *pivot_a );
+    _gjMember* member_b = gj_getMemberSlot( *pivot_b );
+
+    if ( gj_strcmp( member_a->m_KeyStr, member_b->m_KeyStr ) >= 0 )
+    {
+      gj_swap( &key_idcs[ low_idx ], &key_idcs[ upper_idx ] );
+      low_idx++;
+    }
+  }
+  gj_swap( &key_idcs[ low_idx ], &key_idcs[ len - 1 ] );
+
+  return low_idx;
+}
+
+
+//---------------------------------------------------------------------------------
+void gj_quickSortKeys( uint32_t* key_idcs, uint32_t count )
+{
+  if (count > 0)
+  {
+    uint32_t pivot_point = gj_quicksortPivot( key_idcs, count );
+    gj_quickSortKeys(  key_idcs, pivot_point );
+    gj_quickSortKeys( &key_idcs[ pivot_point + 1 ], count - pivot_point - 1 );
+  }
+}
+
+//---------------------------------------------------------------------------------
+void gjValue::sortMembersByKeys()
+{
+  if ( gj_isValueAlloced( idx, gen ) )
+  {
+    _gjValue* val = gj_getValueSlot( idx );
+    if ( VAL_TYPE( val ) == gjValueType::kObject)
+    {
+      _gjMember* header = gj_getObjectHeader( val );
+      if ( header == nullptr || header->m_Next == kMemberIdxTail )
+      {
+        return;
+      }
+
+      const uint32_t member_count = header->m_MemberCount;
+
+      // place their indices in an array
+      uint32_t* tmp_idcs = (uint32_t*)gj_malloc( sizeof( *tmp_idcs ) * member_count, "member sort temp buffer" );
+      {
+        uint32_t tmp_idx = 0;
+        for ( uint32_t member_idx = header->m_Next; member_idx != kMemberIdxTail; member_idx = gj_getMemberSlot( member_idx )->m_Next )
+        {
+          tmp_idcs[ tmp_idx++ ] = member_idx;
+        }
+      }
+
+      // sort the array by key name
+      gj_quickSortKeys( tmp_idcs, member_count );
+
+      // relink
+      uint32_t prev_idx = val->m_ObjectStart.m_Idx;
+      for ( uint32_t i_idc = 0; i_idc < member_count; ++i_idc )
+      {
+        const uint32_t member_idx = tmp_idcs[ i_idc ];
+        gj_getMemberSlot( prev_idx   )->m_Next = member_idx;
+        gj_getMemberSlot( member_idx )->m_Prev = prev_idx;
+        prev_idx = member_idx;
+      }
+
+      gj_getMemberSlot( prev_idx )->m_Next = kMemberIdxTail;
+      header->m_LastIdx = prev_idx;
+
+      // members sharing a hash have to be found in their new order
+      if ( header->m_Index != nullptr )
+      {
+        gj_buildMemberIndex( header );
+      }
+
+      gj_free( tmp_idcs );
+      gj_markCacheDirty( *this );
+    }
+    else
+    {
+      gj_assert( "Attempting to clear array on a value that isn't an array" );
+    }
+  }
+  else
+  {
+    gj_assert( "Attempting to clear array on a value that has been freed" );
+  }
+}
+
+//---------------------------------------------------------------------------------
+//
+// General controls
+// 
+//---------------------------------------------------------------------------------
+gjValue gj_makeArray()
+{
+  gjValue handle_val{};
+  if ( _gjValue* val = gj_allocValue( &handle_val.idx ) )
+  {
+    handle_val.gen = val->m_Gen;
+    ASSIGN_VAL_TYPE( val, gjValueType::kArray );
+    ASSIGN_VAL_SUBTYPE( val, kGjSubValueTypeInvalid );
+    val->m_Array.m_Idx   = kArrayIdxTail;
+    val->m_Array.m_Count = 0;
+  }
+  return handle_val;
+}
+
+//---------------------------------------------------------------------------------
+gjValue gj_makeObject()
+{
+  gjValue handle_val{};
+  if ( _gjValue* val = gj_allocValue( &handle_val.idx ) )
+  {
+    handle_val.gen = val->m_Gen;
+    ASSIGN_VAL_TYPE( val, gjValueType::kObject );
+    ASSIGN_VAL_SUBTYPE( val, kGjSubValueTypeInvalid );
+    val->m_ObjectStart.m_Gen = (uint32_t)-1;
+    val->m_ObjectStart.m_Idx = (uint32_t)-1;
+  }
+  return handle_val;
+}
+
+//---------------------------------------------------------------------------------
+void gj_deleteValue( gjValue val )
+{
+  if ( val.idx < s_ValuePool.m_BumpIdx && val.gen == gj_getValueSlot( val.idx )->m_Gen )
+  {
+    _gjValue* internal_val = gj_getValueSlot( val.idx );
+    gj_freeValueData( internal_val );
+    gj_freeValue( val.idx );
+  }
+}
+
+//---------------------------------------------------------------------------------
+gjUsageStats gj_getUsageStats()
+{
+  gjUsageStats stats;
+  stats.m_UsedValues          = s_ValuePool.m_UsedCount;
+  stats.m_FreeValues          = s_ValuePool.m_Capacity  - s_ValuePool.m_UsedCount;
+  stats.m_PeakValues          = s_ValuePool.m_PeakUsedCount;
+  stats.m_UsedArrayElements   = s_ArrayPool.m_UsedCount;
+  stats.m_FreeArrayElements   = s_ArrayPool.m_Capacity  - s_ArrayPool.m_UsedCount;
+  stats.m_PeakArrayElements   = s_ArrayPool.m_PeakUsedCount;
+  stats.m_UsedObjectMembers   = s_MemberPool.m_UsedCount;
+  stats.m_FreeObjectMembers   = s_MemberPool.m_Capacity - s_MemberPool.m_UsedCount;
+  stats.m_PeakObjectMembers   = s_MemberPool.m_PeakUsedCount;
+  stats.m_SerializeCacheBytes     = s_SerializeCache.m_Bytes;
+  stats.m_PeakSerializeCacheBytes = s_SerializeCache.m_PeakBytes;
+
+  return stats;
+}
+
+//---------------------------------------------------------------------------------
+gjSerializeOptions gj_getDefaultSerializeOptions()
+{
+  gjSerializeOptions options;
+  options.mode          = gjSerializeMode::kPretty;
+  options.newline_style = gjNewlineStyle::kLinux;
+  options.indent_amt    = 2;
+  options.cache_subtrees = false;
+
+  return options;
+}
+
+//---------------------------------------------------------------------------------
+gjSerializer::gjSerializer( gjValue obj_to_serialize, gjSerializeOptions* options )
+: m_Obj( obj_to_serialize )
+, m_Options( options ? *options : gj_getDefaultSerializeOptions() )
+, m_StringData( nullptr )
+, m_StringLen( 0 )
+, m_CacheBytes( 0 )
+, m_CacheOwner( 0 )
+{
+}
+
+//---------------------------------------------------------------------------------
+gjSerializer::~gjSerializer()
+{
+  gj_removeCacheBytes( m_CacheBytes );
+  if ( m_StringData != nullptr )
+  {
+    gj_free( m_StringData );
+  }
+}
+
+//---------------------------------------------------------------------------------
+constexpr const char* kNewlineStrings[] = {
+  "\r\n",
+  "\n"
+};
+static_assert( sizeof( kNewlineStrings ) / sizeof( *kNewlineStrings ) == (size_t)gjNewlineStyle::kCount, "The must stay in sync" );
+
+
+//---------------------------------------------------------------------------------
+constexpr size_t kNewlineLens[] = {
+  2,
+  1
+};
+static_assert( sizeof( kNewlineLens ) / sizeof( *kNewlineLens ) == (size_t)gjNewlineStyle::kCount, "The must stay in sync" );
+
+//---------------------------------------------------------------------------------
+// Numbers are formatted by hand rather than with snprintf. Integers are written two
+// digits at a time from a table of digit pairs, and floats get the shortest text
+// that parses back to the same float, found with Ryu (Ulf Adams, "Ryu: fast
+// float-to-string conversion", PLDI 2018). Both know their length up front, so
+// gj_getRequiredSerializedSize gets exact sizes for them.
+static constexpr char kDigitPairs[] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+//---------------------------------------------------------------------------------
+static constexpr uint64_t kPow10U64[] =
+{
+  1ull,
+  10ull,
+  100ull,
+  1000ull,
+  10000ull,
+  100000ull,
+  1000000ull,
+  10000000ull,
+  100000000ull,
+  1000000000ull,
+  10000000000ull,
+  100000000000ull,
+  1000000000000ull,
+  10000000000000ull,
+  100000000000000ull,
+  1000000000000000ull,
+  10000000000000000ull,
+  100000000000000000ull,
+  1000000000000000000ull,
+  10000000000000000000ull,
+};
+
+//---------------------------------------------------------------------------------
+// 1233 / 4096 is just over log10( 2 ), which gets within one of the count from the
+// bit length. The table settles which
+inline uint32_t gj_countDigits( uint64_t value )
+{
+  const uint64_t nonzero = value | 1;
+  const uint32_t guess   = ( ( gj_Bsr( nonzero ) + 1 ) * 1233 ) >> 12;
+  return guess + 1 - ( nonzero < kPow10U64[ guess ] );
+}
+
+//---------------------------------------------------------------------------------
+// Writes the digit_count digits of value, ending at cursor + digit_count
+inline void gj_writeDigits( char* cursor, uint64_t value, uint32_t digit_count )
+{
+  char* out = cursor + digit_count;
+  while ( value >= 100 )
+  {
+    const uint64_t pair = value % 100;
+    value /= 100;
+    out   -= 2;
+    memcpy( out, &kDigitPairs[ pair * 2 ], 2 );
+  }
+
+  if ( value >= 10 )
+  {
+    memcpy( out - 2, &kDigitPairs[ value * 2 ], 2 );
+  }
+  else
+  {
+    out[ -1 ] = (char)( '0' + value );
+  }
+}
+
+//---------------------------------------------------------------------------------
+inline size_t gj_getIntTextLen( int value )
+{
+  const uint64_t magnitude = value < 0 ? 0 - (uint64_t)(int64_t)value : (uint64_t)value;
+  return ( value < 0 ) + gj_countDigits( magnitude );
+}
+
+//---------------------------------------------------------------------------------
+char* gj_writeInt( char* cursor, int value )
+{
+  const uint64_t magnitude = value < 0 ? 0 - (uint64_t)(int64_t)value : (uint64_t)value;
+  if ( value < 0 )
+  {
+    *cursor++ = '-';
+  }
+
+  const uint32_t digit_count = gj_countDigits( magnitude );
+  gj_writeDigits( cursor, magnitude, digit_count );
+  return cursor + digit_count;
+}
+
+//---------------------------------------------------------------------------------
+char* gj_writeU64( char* cursor, uint64_t value )
+{
+  const uint32_t digit_count = gj_countDigits( value );
+  gj_writeDigits( cursor, value, digit_count );
+  return cursor + digit_count;
+}
+
+//---------------------------------------------------------------------------------
+// 5^i scaled so the top bit is bit 60, and 2^( bits( 5^q ) - 1 + 59 ) / 5^q rounded
+// up. Ryu multiplies by these in place of dividing by powers of 5 and 10
+static constexpr uint32_t kFloatPow5InvBitCount = 59;
+static constexpr uint32_t kFloatPow5BitCount    = 61;
+static constexpr uint64_t kFloatPow5InvSplit[]  =
+{
+  0x0800000000000001, 0x0666666666666667, 0x051EB851EB851EB9, 0x04189374BC6A7EFA,
+  0x068DB8BAC710CB2A, 0x053E2D6238DA3C22, 0x0431BDE82D7B634E, 0x06B5FCA6AF2BD216,
+  0x055E63B88C230E78, 0x044B82FA09B5A52D, 0x06DF37F675EF6EAE, 0x057F5FF85E592558,
+  0x0465E6604B7A8447, 0x0709709A125DA071, 0x05A126E1A84AE6C1, 0x0480EBE7B9D58567,
+  0x0734ACA5F6226F0B, 0x05C3BD5191B525A3, 0x049C97747490EAE9, 0x0760F253EDB4AB0E,
+  0x05E72843249088D8, 0x04B8ED0283A6D3E0, 0x078E480405D7B966, 0x060B6CD004AC9452,
+  0x04D5F0A66A23A9DB, 0x07BCB43D769F762B, 0x063090312BB2C4EF, 0x04F3A68DBC8F03F3,
+  0x07EC3DAF94180651, 0x065697BFA9ACD1DA, 0x051212FFBAF0A7E2,
+};
+
+static constexpr uint64_t kFloatPow5Split[] =
+{
+  0x1000000000000000, 0x1400000000000000, 0x1900000000000000, 0x1F40000000000000,
+  0x1388000000000000, 0x186A000000000000, 0x1E84800000000000, 0x1312D00000000000,
+  0x17D7840000000000, 0x1DCD650000000000, 0x12A05F2000000000, 0x174876E800000000,
+  0x1D1A94A200000000, 0x12309CE540000000, 0x16BCC41E90000000, 0x1C6BF52634000000,
+  0x11C37937E0800000, 0x16345785D8A00000, 0x1BC16D674EC80000, 0x1158E460913D0000,
+  0x15AF1D78B58C4000, 0x1B1AE4D6E2EF5000, 0x10F0CF064DD59200, 0x152D02C7E14AF680,
+  0x1A784379D99DB420, 0x108B2A2C28029094, 0x14ADF4B7320334B9, 0x19D971E4FE8401E7,
+  0x1027E72F1F128130, 0x1431E0FAE6D7217C, 0x193E5939A08CE9DB, 0x1F8DEF8808B02452,
+  0x13B8B5B5056E16B3, 0x18A6E32246C99C60, 0x1ED09BEAD87C0378, 0x13426172C74D822B,
+  0x1812F9CF7920E2B6, 0x1E17B84357691B64, 0x12CED32A16A1B11E, 0x178287F49C4A1D66,
+  0x1D6329F1C35CA4BF, 0x125DFA371A19E6F7, 0x16F578C4E0A060B5, 0x1CB2D6F618C878E3,
+  0x11EFC659CF7D4B8D, 0x166BB7F0435C9E71, 0x1C06A5EC5433C60D, 0x118427B3B4A05BC8,
+};
+
+//---------------------------------------------------------------------------------
+// bits in 5^e, for e > 0
+inline int32_t gj_pow5Bits( int32_t e )
+{
+  return (int32_t)( ( (uint32_t)e * 1217359 ) >> 19 ) + 1;
+}
+
+//---------------------------------------------------------------------------------
+// floor( log10( 2^e ) ), for 0 <= e <= 1650
+inline uint32_t gj_log10Pow2( int32_t e )
+{
+  return ( (uint32_t)e * 78913 ) >> 18;
+}
+
+//---------------------------------------------------------------------------------
+// floor( log10( 5^e ) ), for 0 <= e <= 2620
+inline uint32_t gj_log10Pow5( int32_t e )
+{
+  return ( (uint32_t)e * 732923 ) >> 20;
+}
+
+//---------------------------------------------------------------------------------
+inline bool gj_isMultipleOfPow5( uint32_t value, uint32_t p )
+{
+  uint32_t count = 0;
+  for ( ; value % 5 == 0; value /= 5 )
+  {
+    ++count;
+  }
+  return count >= p;
+}
+
+//---------------------------------------------------------------------------------
+inline bool gj_isMultipleOfPow2( uint32_t value, uint32_t p )
+{
+  return ( value & ( ( 1u << p ) - 1 ) ) == 0;
+}
+
+//---------------------------------------------------------------------------------
+// ( m * factor ) >> shift, for shift > 32
+inline uint32_t gj_mulShift32( uint32_t m, uint64_t factor, int32_t shift )
+{
+  const uint64_t bits_lo = (uint64_t)m * (uint32_t)factor;
+  const uint64_t bits_hi = (uint64_t)m * ( factor >> 32 );
+  return (uint32_t)( ( ( bits_lo >> 32 ) + bits_hi ) >> ( shift - 32 ) );
+}
+
+//---------------------------------------------------------------------------------
+// A finite, nonzero float as m_Digits * 10^m_Exp10
+struct _gjDecimalFloat
+{
+  uint32_t m_Digits;
+  int32_t  m_Exp10;
+};
+
+//---------------------------------------------------------------------------------
+// Ryu's f2s. Works out the interval of decimals that round to the float, then
+// drops digits while the interval still holds a number with one digit less,
+// keeping the one closest to the float.
+_gjDecimalFloat gj_floatToDecimal( uint32_t mantissa_bits, uint32_t exponent_bits )
+{
+  constexpr int32_t kFloatMantissaBits = 23;
+  constexpr int32_t kFloatBias         = 127;
+
+  // two extra bits of exponent make room for the interval's ends
+  int32_t  e2;
+  uint32_t m2;
+  if ( exponent_bits == 0 )
+  {
+    e2 = 1 - kFloatBias - kFloatMantissaBits - 2;
+    m2 = mantissa_bits;
+  }
+  else
+  {
+    e2 = (int32_t)exponent_bits - kFloatBias - kFloatMantissaBits - 2;
+    m2 = ( 1u << kFloatMantissaBits ) | mantissa_bits;
+  }
+
+  const bool     accept_bounds = ( m2 & 1 ) == 0;
+  const uint32_t mv            = 4 * m2;
+  const uint32_t mp            = 4 * m2 + 2;
+  const uint32_t mm_shift      = mantissa_bits != 0 || exponent_bits <= 1;
+  const uint32_t mm            = 4 * m2 - 1 - mm_shift;
+
+  // the interval in decimal, with a digit or so more than needed
+  uint32_t vr, vp, vm;
+  int32_t  e10;
+  bool     vm_is_trailing_zeros = false;
+  bool     vr_is_trailing_zeros = false;
+  uint8_t  last_removed_digit   = 0;
+  if ( e2 >= 0 )
+  {
+    const uint32_t q = gj_log10Pow2( e2 );
+    const int32_t  k = kFloatPow5InvBitCount + gj_pow5Bits( q ) - 1;
+    const int32_t  i = -e2 + (int32_t)q + k;
+    e10 = (int32_t)q;
+    vr  = gj_mulShift32( mv, kFloatPow5InvSplit[ q ], i );
+    vp  = gj_mulShift32( mp, kFloatPow5InvSplit[ q ], i );
+    vm  = gj_mulShift32( mm, kFloatPow5InvSplit[ q ], i );
+    if ( q != 0 && ( vp - 1 ) / 10 <= vm / 10 )
+    {
+      // the loop below drops only one digit, so it needs the one before it
+      const int32_t l = kFloatPow5InvBitCount + gj_pow5Bits( q - 1 ) - 1;
+      last_removed_digit = (uint8_t)( gj_mulShift32( mv, kFloatPow5InvSplit[ q - 1 ], -e2 + (int32_t)q - 1 + l ) % 10 );
+    }
+    if ( q <= 9 )
+    {
+      // only one of mp, mv and mm can be a multiple of 5, if any
+      if ( mv % 5 == 0 )
+      {
+        vr_is_trailing_zeros = gj_isMultipleOfPow5( mv, q );
+      }
+      else if ( accept_bounds )
+      {
+        vm_is_trailing_zeros = gj_isMultipleOfPow5( mm, q );
+      }
+      else
+      {
+        vp -= gj_isMultipleOfPow5( mp, q );
+      }
+    }
+  }
+  else
+  {
+    const uint32_t q = gj_log10Pow5( -e2 );
+    const int32_t  i = -e2 - (int32_t)q;
+    const int32_t  k = gj_pow5Bits( i ) - kFloatPow5BitCount;
+    int32_t        j = (int32_t)q - k;
+    e10 = (int32_t)q + e2;
+    vr  = gj_mulShift32( mv, kFloatPow5Split[ i ], j );
+    vp  = gj_mulShift32( mp, kFloatPow5Split[ i ], j );
+    vm  = gj_mulShift32( mm, kFloatPow5Split[ i ], j );
+    if ( q != 0 && ( vp - 1 ) / 10 <= vm / 10 )
+    {
+      j = (int32_t)q - 1 - ( gj_pow5Bits( i + 1 ) - kFloatPow5BitCount );
+      last_removed_digit = (uint8_t)( gj_mulShift32( mv, kFloatPow5Split[ i + 1 ], j ) % 10 );
+    }
+    if ( q <= 1 )
+    {
+      // mv = 4 * m2 always has at least two trailing zero bits
+      vr_is_trailing_zeros = true;
+      if ( accept_bounds )
+      {
+        vm_is_trailing_zeros = mm_shift == 1;
+      }
+      else
+      {
+        --vp;
+      }
+    }
+    else if ( q < 31 )
+    {
+      vr_is_trailing_zeros = gj_isMultipleOfPow2( mv, q - 1 );
+    }
+  }
+
+  // drop digits while the interval still holds a shorter number
+  int32_t removed = 0;
+  if ( vm_is_trailing_zeros || vr_is_trailing_zeros )
+  {
+    while ( vp / 10 > vm / 10 )
+    {
+      vm_is_trailing_zeros &= vm % 10 == 0;
+      vr_is_trailing_zeros &= last_removed_digit == 0;
+      last_removed_digit    = (uint8_t)( vr % 10 );
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      ++removed;
+    }
+    if ( vm_is_trailing_zeros )
+    {
+      while ( vm % 10 == 0 )
+      {
+        vr_is_trailing_zeros &= last_removed_digit == 0;
+        last_removed_digit    = (uint8_t)( vr % 10 );
+        vr /= 10;
+        vp /= 10;
+        vm /= 10;
+        ++removed;
+      }
+    }
+    if ( vr_is_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0 )
+    {
+      // exactly halfway, round to even
+      last_removed_digit = 4;
+    }
+  }
+  else
+  {
+    while ( vp / 10 > vm / 10 )
+    {
+      last_removed_digit = (uint8_t)( vr % 10 );
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      ++removed;
+    }
+  }
+
+  const bool round_up = ( vr == vm && ( accept_bounds == false || vm_is_trailing_zeros == false ) ) || last_removed_digit >= 5;
+
+  _gjDecimalFloat decimal;
+  decimal.m_Digits = vr + round_up;
+  decimal.m_Exp10  = e10 + removed;
+  return decimal;
+}
+
+//---------------------------------------------------------------------------------
+// Floats are laid out the way javascript writes numbers: plain notation from 1e-6 up
+// to 1e21, exponent notation outside that. Whole numbers keep a ".0" so they read
+// back as floats. NaN and infinity have no json spelling and become null.
+static constexpr int32_t kMaxPlainFloatIntDigits = 21;
+static constexpr int32_t kMaxPlainFloatLeadZeros = 5;
+
+enum class _gjFloatLayout : uint32_t
+{
+  kNull,
+  kZero,
+  kLeadingZeros, // 0.000ddd
+  kPointInside,  // dd.ddd
+  kWhole,        // ddd000.0
+  kExponent,     // d.ddde-dd
+};
+
+//---------------------------------------------------------------------------------
+struct _gjFloatText
+{
+  _gjFloatLayout  m_Layout;
+  bool            m_Negative;
+  _gjDecimalFloat m_Decimal;
+  uint32_t        m_DigitCount;
+  int32_t         m_Point;      // digits before the decimal point, m_DigitCount + m_Exp10
+};
+
+//---------------------------------------------------------------------------------
+_gjFloatText gj_getFloatText( float value )
+{
+  uint32_t bits;
+  memcpy( &bits, &value, sizeof( bits ) );
+  const uint32_t mantissa_bits = bits & ( ( 1u << 23 ) - 1 );
+  const uint32_t exponent_bits = ( bits >> 23 ) & 0xff;
+
+  _gjFloatText text = {};
+  text.m_Negative = ( bits >> 31 ) != 0;
+  if ( exponent_bits == 0xff )
+  {
+    text.m_Layout = _gjFloatLayout::kNull;
+    return text;
+  }
+  if ( exponent_bits == 0 && mantissa_bits == 0 )
+  {
+    text.m_Layout = _gjFloatLayout::kZero;
+    return text;
+  }
+
+  text.m_Decimal    = gj_floatToDecimal( mantissa_bits, exponent_bits );
+  text.m_DigitCount = gj_countDigits( text.m_Decimal.m_Digits );
+  text.m_Point      = (int32_t)text.m_DigitCount + text.m_Decimal.m_Exp10;
+  if ( text.m_Point <= 0 )
+  {
+    text.m_Layout = -text.m_Point <= kMaxPlainFloatLeadZeros ? _gjFloatLayout::kLeadingZeros : _gjFloatLayout::kExponent;
+  }
+  else if ( text.m_Point < (int32_t)text.m_DigitCount )
+  {
+    text.m_Layout = _gjFloatLayout::kPointInside;
+  }
+  else
+  {
+    text.m_Layout = text.m_Point <= kMaxPlainFloatIntDigits ? _gjFloatLayout::kWhole : _gjFloatLayout::kExponent;
+  }
+
+  return text;
+}
+
+//---------------------------------------------------------------------------------
+size_t gj_getFloatTextLen( const _gjFloatText* text )
+{
+  const size_t sign_len = text->m_Negative;
+  switch ( text->m_Layout )
+  {
+  case _gjFloatLayout::kNull:
+  {
+    return 4;
+  }
+  case _gjFloatLayout::kZero:
+  {
+    return sign_len + 3;
+  }
+  case _gjFloatLayout::kLeadingZeros:
+  {
+    return sign_len + 2 + -text->m_Point + text->m_DigitCount;
+  }
+  case _gjFloatLayout::kPointInside:
+  {
+    return sign_len + text->m_DigitCount + 1;
+  }
+  case _gjFloatLayout::kWhole:
+  {
+    return sign_len + text->m_Point + 2;
+  }
+  case _gjFloatLayout::kExponent:
+  {
+    const int32_t exp10 = text->m_Point - 1;
+    return sign_len + text->m_DigitCount + ( text->m_DigitCount > 1 ) + 1 + ( exp10 < 0 ) + gj_countDigits( exp10 < 0 ? -exp10 : exp10 );
+  }
+  }
+
+  return 0;
+}
+
+//---------------------------------------------------------------------------------
+char* gj_writeFloat( char* cursor, const _gjFloatText* text )
+{
+  if ( text->m_Layout == _gjFloatLayout::kNull )
+  {
+    memcpy( cursor, "null", 4 );
+    return cursor + 4;
+  }
+
+  if ( text->m_Negative )
+  {
+    *cursor++ = '-';
+  }
+
+  const uint32_t digit_count = text->m_DigitCount;
+  switch ( text->m_Layout )
+  {
+  case _gjFloatLayout::kZero:
+  {
+    memcpy( cursor, "0.0", 3 );
+    return cursor + 3;
+  }
+  case _gjFloatLayout::kLeadingZeros:
+  {
+    const size_t zero_count = 2 + -text->m_Point;
+    memset( cursor, '0', zero_count );
+    cursor[ 1 ] = '.';
+    gj_writeDigits( cursor + zero_count, text->m_Decimal.m_Digits, digit_count );
+    return cursor + zero_count + digit_count;
+  }
+  case _gjFloatLayout::kPointInside:
+  {
+    // write the digits one place to the right, then pull the whole part back over
+    gj_writeDigits( cursor + 1, text->m_Decimal.m_Digits, digit_count );
+    memmove( cursor, cursor + 1, text->m_Point );
+    cursor[ text->m_Point ] = '.';
+    return cursor + digit_count + 1;
+  }
+  case _gjFloatLayout::kWhole:
+  {
+    gj_writeDigits( cursor, text->m_Decimal.m_Digits, digit_count );
+    memset( cursor + digit_count, '0', text->m_Point - digit_count );
+    memcpy( cursor + text->m_Point, ".0", 2 );
+    return cursor + text->m_Point + 2;
+  }
+  case _gjFloatLayout::kExponent:
+  {
+    gj_writeDigits( cursor + 1, text->m_Decimal.m_Digits, digit_count );
+    cursor[ 0 ] = cursor[ 1 ];
+    cursor     += 1;
+    if ( digit_count > 1 )
+    {
+      *cursor = '.';
+      cursor += digit_count;
+    }
+
+    const int32_t exp10 = text->m_Point - 1;
+    *cursor++ = 'e';
+    if ( exp10 < 0 )
+    {
+      *cursor++ = '-';
+    }
+    return gj_writeU64( cursor, exp10 < 0 ? -exp10 : exp10 );
+  }
+  default:
+    break;
+  }
+
+  return cursor;
+}
+
+//---------------------------------------------------------------------------------
+// Strings are copied a run at a time between the bytes that need escaping, which
+// gj_findEscape finds a block at a time. Quotes, backslashes, slashes and the control
+// characters json has a short escape for take two chars, the rest of the control
+// characters take six as \u00XX.
+const char* gj_findEscape( const char* cursor, const char* end );
+
+static constexpr char   kControlEscapes[] = "uuuuuuuubtnufruuuuuuuuuuuuuuuuuu";
+static constexpr size_t kMaxEscapeLen     = 6;
+static_assert( sizeof( kControlEscapes ) == 0x20 + 1, "One per control character" );
+
+//---------------------------------------------------------------------------------
+// the char after the backslash, for a char gj_findEscape stopped at
+inline char gj_getEscapeChar( char c )
+{
+  return (uint8_t)c < 0x20 ? kControlEscapes[ (uint8_t)c ] : c;
+}
+
+//---------------------------------------------------------------------------------
+// returns the length of the escape written
+inline size_t gj_writeEscape( char* cursor, char c )
+{
+  static constexpr char kHexDigits[] = "0123456789abcdef";
+
+  const char escaped = gj_getEscapeChar( c );
+  cursor[ 0 ] = '\\';
+  cursor[ 1 ] = escaped;
+  if ( escaped != 'u' )
+  {
+    return 2;
+  }
+
+  cursor[ 2 ] = '0';
+  cursor[ 3 ] = '0';
+  cursor[ 4 ] = kHexDigits[ (uint8_t)c >> 4 ];
+  cursor[ 5 ] = kHexDigits[ (uint8_t)c & 0xf ];
+  return kMaxEscapeLen;
+}
+
+//---------------------------------------------------------------------------------
+// Length of cstring once escaped, without the quotes. strlen rather than gj_StrLen so
+// strings past kUnreasonablyLargeStringSize still serialize whole
+size_t gj_getJsonSizeforCString( const char* cstring )
+{
+  const size_t      len    = strlen( cstring );
+  const char*       cursor = cstring;
+  const char* const end    = cstring + len;
+
+  size_t sz = len;
+  for ( ;; )
+  {
+    cursor = gj_findEscape( cursor, end );
+    if ( cursor == end )
+    {
+      return sz;
+    }
+    sz += gj_getEscapeChar( *cursor ) == 'u' ? kMaxEscapeLen - 1 : 1;
+    cursor++;
+  }
+}
+
+//---------------------------------------------------------------------------------
+size_t gj_getScalarSerializedSize( const _gjValue* val )
+{
+  switch ( VAL_TYPE( val ) )
+  {
+  case gjValueType::kNull:
+  {
+    return 4; // null
+  }
+  case gjValueType::kString:
+  {
+    return 2 + gj_getJsonSizeforCString( val->m_Str ); // "<string>"
+  }
+  case gjValueType::kNumber:
+  {
+    switch ( VAL_SUBTYPE( val ) )
+    {
+      case kGjSubValueTypeInt:
+      {
+        return gj_getIntTextLen( val->m_Int );
+      }
+      break;
+      case kGjSubValueTypeU64:
+      {
+        return gj_countDigits( val->m_U64 );
+      }
+      break;
+      case kGjSubValueTypeFloat:
+      {
+        const _gjFloatText text = gj_getFloatText( val->m_Float );
+        return gj_getFloatTextLen( &text );
+      }
+      break;
+    }
+  }
+  case gjValueType::kBool:
+  {
+    return val->m_Bool ? 4 : 5;
+  }
+  default:
+    gj_assert( "Attempt to serialize unknown type!" );
+  }
+
+  return 0;
+}
+
+//---------------------------------------------------------------------------------
+size_t gj_getRequiredSerializedSize( gjValue val_handle, gjSerializeOptions* options )
+{
+  const size_t newline_len    = options->mode == gjSerializeMode::kPretty ? kNewlineLens[ (uint32_t)options->newline_style ] : 0;
+  const size_t new_indent_amt = options->mode == gjSerializeMode::kPretty ? abs( options->indent_amt )                       : 0;
+
+  if ( gj_isValueAlloced( val_handle.idx, val_handle.gen ) == false )
+  {
+    gj_assert( "attempting to serialize freed value" );
+    return 0;
+  }
+
+  _gjWalkStack stack;
+  _gjWalkFrame frame;
+  bool         in_container = false;
+  gj_initWalkStack( &stack );
+
+  size_t    sz  = 0;
+  _gjValue* val = gj_getValueSlot( val_handle.idx );
+  while ( val != nullptr )
+  {
+    if ( VAL_TYPE( val ) == gjValueType::kArray && val->m_Array.m_Count == 0 )
+    {
+      sz += 2; // []
+    }
+    else if ( gj_isContainer( val ) )
+    {
+      sz += 1 + newline_len; // { or [
+      if ( in_container && gj_pushWalkFrame( &stack, &frame ) == false )
+      {
+        break;
+      }
+      gj_startWalkFrame( &frame, val, kValueIdxTail );
+      in_container = true;
+    }
+    else
+    {
+      sz += gj_getScalarSerializedSize( val );
+    }
+
+    // find the next value, closing the containers that have run out of them
+    val = nullptr;
+    while ( in_container && val == nullptr )
+    {
+      const size_t     local_indent_amt = ( stack.m_Depth + 1 ) * new_indent_amt;
+      gjValue          child;
+      const _gjMember* member;
+      if ( gj_nextWalkChild( &frame, &child, &member ) )
+      {
+        const bool is_last = gj_hasWalkChild( &frame ) == false;
+        if ( member != nullptr )
+        {
+          sz += local_indent_amt + (options->mode == gjSerializeMode::kMinified ? 3 : 5) + gj_getJsonSizeforCString( member->m_KeyStr ); // "<key>" : 
+          sz += ( is_last == false ) + newline_len; // ,
+        }
+        else
+        {
+          sz += local_indent_amt + newline_len + ( is_last == false ); // ,
+        }
+
+        if ( gj_isValueAlloced( child.idx, child.gen ) )
+        {
+          val = gj_getValueSlot( child.idx );
+        }
+        else
+        {
+          gj_assert( "attempting to serialize freed value" );
+        }
+      }
+      else
+      {
+        const bool in_object = VAL_TYPE( frame.m_Val ) == gjValueType::kObject;
+        sz += local_indent_amt - new_indent_amt + ( in_object ? 0 : newline_len ) + 1; // } or ]
+        in_container = gj_popWalkFrame( &stack, &frame );
+      }
+    }
+  }
+
+  gj_releaseWalkStack( &stack );
+  return sz;
+}
+
+//---------------------------------------------------------------------------------
+char* gj_addIndent( char* cursor, size_t amt, bool use_tabs )
+{
+  for ( size_t i_char = 0; i_char < amt; ++i_char )
+  {
+    *cursor = use_tabs ? '\t' : ' ';
+    cursor++;
+  }
+  return cursor;
+}
+
+//---------------------------------------------------------------------------------
+char* gj_addChars( char* cursor, const char* src, size_t len )
+{
+  memcpy( cursor, src, len );
+  return cursor + len;
+}
+
+//---------------------------------------------------------------------------------
+char* gj_addCString( char* cursor, const char* src )
+{
+  const char* const end = src + strlen( src );
+  for ( ;; )
+  {
+    const char* const stop = gj_findEscape( src, end );
+    memcpy( cursor, src, stop - src );
+    cursor += stop - src;
+    if ( stop == end )
+    {
+      return cursor;
+    }
+
+    cursor += gj_writeEscape( cursor, *stop );
+    src     = stop + 1;
+  }
+}
+
+//---------------------------------------------------------------------------------
+char* gj_serializeScalar( char* cursor, const _gjValue* val )
+{
+  switch ( VAL_TYPE( val ) )
+  {
+  case gjValueType::kNull:
+  {
+    return gj_addChars( cursor, "null", 4 );
+  }
+  case gjValueType::kString:
+  {
+    cursor = gj_addChars  ( cursor, "\"", 1 );
+    cursor = gj_addCString( cursor, val->m_Str );
+    cursor = gj_addChars  ( cursor, "\"", 1 );
+    return cursor;
+  }
+  case gjValueType::kNumber:
+  {
+    switch ( VAL_SUBTYPE( val ) )
+    {
+      case kGjSubValueTypeInt:
+      {
+        return gj_writeInt( cursor, val->m_Int );
+      }
+      break;
+      case kGjSubValueTypeU64:
+      {
+        return gj_writeU64( cursor, val->m_U64 );
+      }
+      break;
+      case kGjSubValueTypeFloat:
+      {
+        const _gjFloatText text = gj_getFloatText( val->m_Float );
+        return gj_writeFloat( cursor, &text );
+      }
+      break;
+    }
+  }
+  case gjValueType::kBool:
+  {
+    if ( val->m_Bool )
+    {
+      return gj_addChars( cursor, "true", 4 );
+    }
+    else
+    {
+      return gj_addChars( cursor, "false", 5 );
+    }
+  }
+  default:
+    gj_assert( "Attempt to serialize unknown type!" );
+  }
+
+  return cursor;
+}
+
+//---------------------------------------------------------------------------------
+// Writes the same text gj_getRequiredSerializedSize measures, walking the tree in
+// the same order
+char* gj_serialize( char* cursor, gjValue val_handle, gjSerializeOptions* options )
+{
+  const char*  newline_str    = options->mode == gjSerializeMode::kPretty ? kNewlineStrings[ (uint32_t)options->newline_style ] : "";
+  const size_t newline_len    = options->mode == gjSerializeMode::kPretty ? kNewlineLens   [ (uint32_t)options->newline_style ] : 0;
+  const bool   using_tabs     = options->mode == gjSerializeMode::kPretty ? options->indent_amt == -1                           : 0;
+  const size_t new_indent_amt = options->mode == gjSerializeMode::kPretty ? abs( options->indent_amt )                          : 0;
+
+  if ( gj_isValueAlloced( val_handle.idx, val_handle.gen ) == false )
+  {
+    gj_assert( "attempting to serialize freed value" );
+    return cursor;
+  }
+
+  _gjWalkStack stack;
+  _gjWalkFrame frame;
+  bool         in_container = false;
+  gj_initWalkStack( &stack );
+
+  _gjValue* val = gj_getValueSlot( val_handle.idx );
+  while ( val != nullptr )
+  {
+    if ( VAL_TYPE( val ) == gjValueType::kArray && val->m_Array.m_Count == 0 )
+    {
+      cursor = gj_addChars( cursor, "[]", 2 );
+    }
+    else if ( gj_isContainer( val ) )
+    {
+      cursor = gj_addChars( cursor, VAL_TYPE( val ) == gjValueType::kObject ? "{" : "[", 1           );
+      cursor = gj_addChars( cursor, newline_str,                                         newline_len );
+      if ( in_container && gj_pushWalkFrame( &stack, &frame ) == false )
+      {
+        break;
+      }
+      gj_startWalkFrame( &frame, val, kValueIdxTail );
+      in_container = true;
+    }
+    else
+    {
+      cursor = gj_serializeScalar( cursor, val );
+    }
+
+    // find the next value, closing the containers that have run out of them
+    val = nullptr;
+    while ( in_container && val == nullptr )
+    {
+      const size_t     local_indent_amt = ( stack.m_Depth + 1 ) * new_indent_amt;
+      gjValue          child;
+      const _gjMember* member;
+      if ( gj_nextWalkChild( &frame, &child, &member ) )
+      {
+        if ( frame.m_Visited > 1 )
+        {
+          cursor = gj_addChars( cursor, ",",         1           );
+          cursor = gj_addChars( cursor, newline_str, newline_len );
+        }
+
+        cursor = gj_addIndent( cursor, local_indent_amt, using_tabs );
+        if ( member != nullptr )
+        {
+          cursor = gj_addChars  ( cursor, "\"",             1                             );
+          cursor = gj_addCString( cursor, member->m_KeyStr );
+          cursor = gj_addChars  ( cursor, options->mode == gjSerializeMode::kMinified ? "\":" : "\" : ", 
+                                          options->mode == gjSerializeMode::kMinified ? 2     : 4 );
+        }
+
+        if ( gj_isValueAlloced( child.idx, child.gen ) )
+        {
+          val = gj_getValueSlot( child.idx );
+        }
+        else
+        {
+          gj_assert( "attempting to serialize freed value" );
+        }
+      }
+      else
+      {
+        const bool in_object = VAL_TYPE( frame.m_Val ) == gjValueType::kObject;
+        if ( frame.m_Visited > 0 )
+        {
+          cursor = gj_addChars( cursor, newline_str, newline_len );
+        }
+        cursor = gj_addIndent( cursor, local_indent_amt - new_indent_amt, using_tabs );
+        cursor = gj_addChars ( cursor, in_object ? "}" : "]",             1          );
+        in_container = gj_popWalkFrame( &stack, &frame );
+      }
+    }
+  }
+
+  gj_releaseWalkStack( &stack );
+  return cursor;
+}
+
+//---------------------------------------------------------------------------------
+void gjSerializer::serialize()
+{
+  // the table has to cover every value before the walk can record anything in it
+  if ( m_Options.cache_subtrees && s_Config.serialize_cache_budget > 0 && gj_reserveCacheSlots( s_ValuePool.m_BumpIdx ) )
+  {
+    serializeCached();
+    return;
+  }
+
+  // anything cached points into the text that's about to be freed
+  gj_removeCacheBytes( m_CacheBytes );
+  m_CacheBytes = 0;
+
+  // gather the size needed
+  size_t str_sz = gj_getRequiredSerializedSize( m_Obj, &m_Options ) + 1;
+  if ( m_StringData != nullptr )
+  {
+    gj_free( m_StringData );
+  }
+
+  m_StringData = (char*)gj_malloc( str_sz, "Serialized string data" );
+  char* cursor = m_StringData;
+  cursor = gj_serialize( cursor, m_Obj, &m_Options );
+  *cursor = '\0';
+  m_StringLen = cursor - m_StringData;
+}
+
+//---------------------------------------------------------------------------------
+const char* gjSerializer::getString()
+{
+  return m_StringData ? m_StringData : "";
+}
+
+//---------------------------------------------------------------------------------
+bool gj_writeToMemory( const char* data, size_t data_len, void* user_data )
+{
+  gjMemorySink* memory = (gjMemorySink*)user_data;
+  if ( memory->capacity - memory->length < data_len )
+  {
+    return false;
+  }
+
+  memcpy( memory->data + memory->length, data, data_len );
+  memory->length += data_len;
+  return true;
+}
+
+//---------------------------------------------------------------------------------
+bool gj_writeToFile( const char* data, size_t data_len, void* user_data )
+{
+  return fwrite( data, 1, data_len, (FILE*)user_data ) == data_len;
+}
+
+//---------------------------------------------------------------------------------
+bool gj_writeToFd( const char* data, size_t data_len, void* user_data )
+{
+  return gj_writeFd( (int)(intptr_t)user_data, data, data_len );
+}
+
+//---------------------------------------------------------------------------------
+gjSink gj_makeMemorySink( gjMemorySink* memory )
+{
+  return gjSink{ gj_writeToMemory, memory };
+}
+
+//---------------------------------------------------------------------------------
+gjSink gj_makeFileSink( FILE* file )
+{
+  return gjSink{ gj_writeToFile, file };
+}
+
+//---------------------------------------------------------------------------------
+gjSink gj_makeFdSink( int fd )
+{
+  return gjSink{ gj_writeToFd, (void*)(intptr_t)fd };
+}
+
+//---------------------------------------------------------------------------------
+// The stream writer fills a fixed buffer and hands it to the sink whenever the next
+// write won't fit. Once the sink fails, the rest of the output still goes into the
+// buffer so the writes don't need checking, but it's dropped instead of flushed.
+struct _gjStreamWriter
+{
+  char*         m_Buffer;
+  char*         m_Cursor;
+  char*         m_End;
+  const gjSink* m_Sink;
+  bool          m_Failed;
+};
+
+// numbers, bools and null are written straight into the buffer by gj_serializeScalar
+static constexpr size_t kStreamScalarReserve = 32;
+static_assert( kStreamScalarReserve <= kGjMinStreamBufferSize, "A scalar must always fit in an empty buffer" );
+static_assert( kMaxEscapeLen        <= kGjMinStreamBufferSize, "An escape must always fit in an empty buffer" );
+
+//---------------------------------------------------------------------------------
+// A writer without a sink is building the output in memory, so running out of room
+// grows the buffer instead
+void gj_growStreamWriter( _gjStreamWriter* writer )
+{
+  const size_t len          = writer->m_Cursor - writer->m_Buffer;
+  const size_t new_capacity = ( writer->m_End - writer->m_Buffer ) * 2;
+  char*        new_buffer   = (char*)gj_malloc( new_capacity, "Serialized string data" );
+  if ( new_buffer == nullptr )
+  {
+    gj_assert( "Ran out of memory growing the serialized string. You may be out of memory" );
+    writer->m_Failed = true;
+    writer->m_Cursor = writer->m_Buffer;
+    return;
+  }
+
+  memcpy( new_buffer, writer->m_Buffer, len );
+  gj_free( writer->m_Buffer );
+
+  writer->m_Buffer = new_buffer;
+  writer->m_Cursor = new_buffer + len;
+  writer->m_End    = new_buffer + new_capacity;
+}
+
+//---------------------------------------------------------------------------------
+void gj_flushStreamWriter( _gjStreamWriter* writer )
+{
+  if ( writer->m_Sink == nullptr )
+  {
+    gj_growStreamWriter( writer );
+    return;
+  }
+
+  const size_t len = writer->m_Cursor - writer->m_Buffer;
+  if ( len > 0 && writer->m_Failed == false )
+  {
+    writer->m_Failed = writer->m_Sink->write( writer->m_Buffer, len, writer->m_Sink->user_data ) == false;
+  }
+  writer->m_Cursor = writer->m_Buffer;
+}
+
+//---------------------------------------------------------------------------------
+void gj_streamCharsAcrossFlush( _gjStreamWriter* writer, const char* src, size_t len )
+{
+  for ( ;; )
+  {
+    const size_t room      = writer->m_End - writer->m_Cursor;
+    const size_t chunk_len = len < room ? len : room;
+    memcpy( writer->m_Cursor, src, chunk_len );
+    writer->m_Cursor += chunk_len;
+    src              += chunk_len;
+    len              -= chunk_len;
+    if ( len == 0 )
+    {
+      return;
+    }
+    gj_flushStreamWriter( writer );
+  }
+}
+
+//---------------------------------------------------------------------------------
+// Most writes are a few chars of punctuation, so the common case stays inline
+inline void gj_streamChars( _gjStreamWriter* writer, const char* src, size_t len )
+{
+  if ( len <= (size_t)( writer->m_End - writer->m_Cursor ) )
+  {
+    memcpy( writer->m_Cursor, src, len );
+    writer->m_Cursor += len;
+  }
+  else
+  {
+    gj_streamCharsAcrossFlush( writer, src, len );
+  }
+}
+
+//---------------------------------------------------------------------------------
+void gj_streamIndent( _gjStreamWriter* writer, size_t amt, bool use_tabs )
+{
+  for ( ;; )
+  {
+    const size_t room      = writer->m_End - writer->m_Cursor;
+    const size_t chunk_len = amt < room ? amt : room;
+    memset( writer->m_Cursor, use_tabs ? '\t' : ' ', chunk_len );
+    writer->m_Cursor += chunk_len;
+    amt              -= chunk_len;
+    if ( amt == 0 )
+    {
+      return;
+    }
+    gj_flushStreamWriter( writer );
+  }
+}
+
+//---------------------------------------------------------------------------------
+void gj_streamCString( _gjStreamWriter* writer, const char* src )
+{
+  const char* const end = src + strlen( src );
+  for ( ;; )
+  {
+    const char* const stop = gj_findEscape( src, end );
+    gj_streamChars( writer, src, stop - src );
+    if ( stop == end )
+    {
+      return;
+    }
+
+    if ( (size_t)( writer->m_End - writer->m_Cursor ) < kMaxEscapeLen )
+    {
+      gj_flushStreamWriter( writer );
+    }
+    writer->m_Cursor += gj_writeEscape( writer->m_Cursor, *stop );
+    src               = stop + 1;
+  }
+}
+
+//---------------------------------------------------------------------------------
+void gj_streamScalar( _gjStreamWriter* writer, const _gjValue* val )
+{
+  if ( VAL_TYPE( val ) == gjValueType::kString )
+  {
+    gj_streamChars  ( writer, "\"", 1 );
+    gj_streamCString( writer, val->m_Str );
+    gj_streamChars  ( writer, "\"", 1 );
+    return;
+  }
+
+  if ( (size_t)( writer->m_End - writer->m_Cursor ) < kStreamScalarReserve )
+  {
+    gj_flushStreamWriter( writer );
+  }
+  writer->m_Cursor = gj_serializeScalar( writer->m_Cursor, val );
+}
+
+//---------------------------------------------------------------------------------
+// When a gjSerializer caches subtrees, gj_streamValue is handed one of these to look
+// up the text containers had in the last output and to record where they land in the
+// new one. It keeps a frame per open container, like the walk stack, but by depth so
+// the container around the current one is always the frame before it.
+static constexpr size_t kNoOldText = (size_t)-1;
+
+struct _gjCacheFrame
+{
+  gjValue m_Value;
+  size_t  m_NewStart; // where the container's text starts in the output being written
+  size_t  m_OldStart; // and where it started in the last output, kNoOldText if it wasn't there
+};
+
+//---------------------------------------------------------------------------------
+struct _gjCacheWalk
+{
+  const char*    m_OldText;  // the last output, nullptr if nothing in it can be used
+  uint32_t       m_Owner;
+  _gjCacheFrame* m_Frames;   // the open containers, outermost first
+  uint32_t       m_Capacity;
+  _gjCacheFrame  m_InlineFrames[ kWalkInlineStackDepth ];
+};
+
+//---------------------------------------------------------------------------------
+void gj_initCacheWalk( _gjCacheWalk* cache, const char* old_text, uint32_t owner )
+{
+  cache->m_OldText  = old_text;
+  cache->m_Owner    = owner;
+  cache->m_Frames   = cache->m_InlineFrames;
+  cache->m_Capacity = kWalkInlineStackDepth;
+}
+
+//---------------------------------------------------------------------------------
+void gj_releaseCacheWalk( _gjCacheWalk* cache )
+{
+  if ( cache->m_Frames != cache->m_InlineFrames )
+  {
+    gj_free( cache->m_Frames );
+  }
+}
+
+//---------------------------------------------------------------------------------
+// returns where the value's text started in the last output, or kNoOldText if it
+// wasn't written there by this serializer at this depth inside this parent
+size_t gj_findOldText( const _gjCacheWalk* cache, gjValue value, uint32_t depth, const _gjCacheFrame* parent )
+{
+  const _gjCacheSlot* slot = &s_SerializeCache.m_Slots[ value.idx ];
+  if ( cache->m_OldText == nullptr || slot->m_Gen != value.gen || slot->m_Owner != cache->m_Owner || slot->m_Depth != depth )
+  {
+    return kNoOldText;
+  }
+
+  if ( parent == nullptr )
+  {
+    return 0;
+  }
+
+  if ( parent->m_OldStart == kNoOldText || slot->m_ParentIdx != parent->m_Value.idx || slot->m_ParentGen != parent->m_Value.gen )
+  {
+    return kNoOldText;
+  }
+
+  return parent->m_OldStart + slot->m_Offset;
+}
+
+//---------------------------------------------------------------------------------
+// Copies the container's text from the last output if nothing in it has changed.
+// returns false if it has to be walked
+bool gj_copyCachedText( _gjStreamWriter* writer, _gjCacheWalk* cache, gjValue value, uint32_t depth, const _gjCacheFrame* parent )
+{
+  const size_t old_start = gj_findOldText( cache, value, depth, parent );
+  _gjCacheSlot* slot     = &s_SerializeCache.m_Slots[ value.idx ];
+  if ( old_start == kNoOldText || slot->m_Dirty )
+  {
+    return false;
+  }
+
+  const size_t new_start = writer->m_Cursor - writer->m_Buffer;
+  gj_streamChars( writer, cache->m_OldText + old_start, slot->m_Len );
+  slot->m_Offset = parent != nullptr ? (uint32_t)( new_start - parent->m_NewStart ) : 0;
+  return true;
+}
+
+//---------------------------------------------------------------------------------
+// Starts the frame of a container that's about to be walked. returns false if the
+// frames couldn't grow to fit it
+bool gj_openCachedText( _gjCacheWalk* cache, gjValue value, uint32_t depth, size_t new_start )
+{
+  const _gjCacheFrame* parent    = depth > 0 ? &cache->m_Frames[ depth - 1 ] : nullptr;
+  const size_t         old_start = gj_findOldText( cache, value, depth, parent );
+
+  if ( depth == cache->m_Capacity )
+  {
+    const uint32_t new_capacity = cache->m_Capacity * 2;
+    _gjCacheFrame* new_frames   = (_gjCacheFrame*)gj_malloc( new_capacity * sizeof( *new_frames ), "Serialize cache frames" );
+    if ( new_frames == nullptr )
+    {
+      gj_assert( "Ran out of memory for the serialize cache frames. You may be out of memory" );
+      return false;
+    }
+
+    memcpy( new_frames, cache->m_Frames, depth * sizeof( *new_frames ) );
+    gj_releaseCacheWalk( cache );
+    cache->m_Frames   = new_frames;
+    cache->m_Capacity = new_capacity;
+  }
+
+  _gjCacheFrame* frame = &cache->m_Frames[ depth ];
+  frame->m_Value    = value;
+  frame->m_NewStart = new_start;
+  frame->m_OldStart = old_start;
+  return true;
+}
+
+//---------------------------------------------------------------------------------
+// Records where the container at depth ended up once its text is all written
+void gj_closeCachedText( _gjCacheWalk* cache, uint32_t depth, size_t new_end )
+{
+  const _gjCacheFrame* frame = &cache->m_Frames[ depth ];
+  _gjCacheSlot*        slot  = &s_SerializeCache.m_Slots[ frame->m_Value.idx ];
+  const size_t         len   = new_end - frame->m_NewStart;
+
+  slot->m_Gen = frame->m_Value.gen;
+  if ( depth > 0 )
+  {
+    const _gjCacheFrame* parent = frame - 1;
+    slot->m_ParentIdx = parent->m_Value.idx;
+    slot->m_ParentGen = parent->m_Value.gen;
+    slot->m_Offset    = (uint32_t)( frame->m_NewStart - parent->m_NewStart );
+  }
+  else
+  {
+    slot->m_Offset    = 0;
+  }
+
+  // text past 4GB is written every time, which also keeps the offsets inside it from overflowing
+  slot->m_Owner = len <= UINT32_MAX ? cache->m_Owner : 0;
+  slot->m_Len   = (uint32_t)len;
+  slot->m_Depth = depth;
+  slot->m_Dirty = 0;
+}
+
+//---------------------------------------------------------------------------------
+// The same walk as gj_serialize, writing through the stream writer instead of into
+// memory sized up front. base_depth is how deep the value sits in the document, for
+// the indent. cache is only set by a gjSerializer caching subtrees. returns false if
+// the value was freed
+bool gj_streamValue( _gjStreamWriter* writer, gjValue val_handle, gjSerializeOptions* options, uint32_t base_depth, _gjCacheWalk* cache )
+{
+  const char*  newline_str    = options->mode == gjSerializeMode::kPretty ? kNewlineStrings[ (uint32_t)options->newline_style ] : "";
+  const size_t newline_len    = options->mode == gjSerializeMode::kPretty ? kNewlineLens   [ (uint32_t)options->newline_style ] : 0;
+  const bool   using_tabs     = options->mode == gjSerializeMode::kPretty ? options->indent_amt == -1                           : 0;
+  const size_t new_indent_amt = options->mode == gjSerializeMode::kPretty ? abs( options->indent_amt )                          : 0;
+
+  if ( gj_isValueAlloced( val_handle.idx, val_handle.gen ) == false )
+  {
+    gj_assert( "attempting to serialize freed value" );
+    return false;
+  }
+
+  _gjWalkStack stack;
+  _gjWalkFrame frame;
+  bool         in_container = false;
+  gj_initWalkStack( &stack );
+
+  _gjValue* val = gj_getValueSlot( val_handle.idx );
+  while ( val != nullptr && writer->m_Failed == false )
+  {
+    const uint32_t       depth  = in_container ? stack.m_Depth + 1 : 0;
+    const _gjCacheFrame* parent = cache != nullptr && in_container ? &cache->m_Frames[ stack.m_Depth ] : nullptr;
+
+    if ( VAL_TYPE( val ) == gjValueType::kArray && val->m_Array.m_Count == 0 )
+    {
+      gj_streamChars( writer, "[]", 2 );
+      if ( parent != nullptr )
+      {
+        gj_linkCachedValue( val_handle, parent->m_Value );
+      }
+    }
+    else if ( cache != nullptr && gj_copyCachedText( writer, cache, val_handle, depth, parent ) )
+    {
+      // nothing in it changed, so its text came from the last output
+    }
+    else if ( gj_isContainer( val ) )
+    {
+      if ( cache != nullptr && gj_openCachedText( cache, val_handle, depth, writer->m_Cursor - writer->m_Buffer ) == false )
+      {
+        break;
+      }
+
+      gj_streamChars( writer, VAL_TYPE( val ) == gjValueType::kObject ? "{" : "[", 1           );
+      gj_streamChars( writer, newline_str,                                         newline_len );
+      if ( in_container && gj_pushWalkFrame( &stack, &frame ) == false )
+      {
+        break;
+      }
+      gj_startWalkFrame( &frame, val, kValueIdxTail );
+      in_container = true;
+    }
+    else
+    {
+      gj_streamScalar( writer, val );
+      if ( parent != nullptr )
+      {
+        gj_linkCachedValue( val_handle, parent->m_Value );
+      }
+    }
+
+    // find the next value, closing the containers that have run out of them
+    val = nullptr;
+    while ( in_container && val == nullptr )
+    {
+      const size_t     local_indent_amt = ( base_depth + stack.m_Depth + 1 ) * new_indent_amt;
+      gjValue          child;
+      const _gjMember* member;
+      if ( gj_nextWalkChild( &frame, &child, &member ) )
+      {
+        if ( frame.m_Visited > 1 )
+        {
+          gj_streamChars( writer, ",",         1           );
+          gj_streamChars( writer, newline_str, newline_len );
+        }
+
+        gj_streamIndent( writer, local_indent_amt, using_tabs );
+        if ( member != nullptr )
+        {
+          gj_streamChars  ( writer, "\"", 1 );
+          gj_streamCString( writer, member->m_KeyStr );
+          gj_streamChars  ( writer, options->mode == gjSerializeMode::kMinified ? "\":" : "\" : ", 
+                                    options->mode == gjSerializeMode::kMinified ? 2     : 4 );
+        }
+
+        if ( gj_isValueAlloced( child.idx, child.gen ) )
+        {
+          val        = gj_getValueSlot( child.idx );
+          val_handle = child;
+        }
+        else
+        {
+          gj_assert( "attempting to serialize freed value" );
+        }
+      }
+      else
+      {
+        const bool in_object = VAL_TYPE( frame.m_Val ) == gjValueType::kObject;
+        if ( frame.m_Visited > 0 )
+        {
+          gj_streamChars( writer, newline_str, newline_len );
+        }
+        gj_streamIndent( writer, local_indent_amt - new_indent_amt, using_tabs );
+        gj_streamChars ( writer, in_object ? "}" : "]",             1          );
+        if ( cache != nullptr )
+        {
+          gj_closeCachedText( cache, stack.m_Depth, writer->m_Cursor - writer->m_Buffer );
+        }
+        in_container = gj_popWalkFrame( &stack, &frame );
+      }
+    }
+  }
+
+  gj_releaseWalkStack( &stack );
+  return true;
+}
+
+//---------------------------------------------------------------------------------
+gjStreamSerializer::gjStreamSerializer( gjSerializeOptions* options, size_t buffer_size )
+: m_Options( options ? *options : gj_getDefaultSerializeOptions() )
+, m_Buffer( nullptr )
+, m_BufferSize( buffer_size > kGjMinStreamBufferSize ? buffer_size : kGjMinStreamBufferSize )
+{
+}
+
+//---------------------------------------------------------------------------------
+gjStreamSerializer::~gjStreamSerializer()
+{
+  if ( m_Buffer != nullptr )
+  {
+    gj_free( m_Buffer );
+  }
+}
+
+//---------------------------------------------------------------------------------
+bool gjStreamSerializer::serialize( gjValue value, const gjSink* sink )
+{
+  if ( sink == nullptr || sink->write == nullptr )
+  {
+    gj_assert( "Attempting to stream serialize without a sink" );
+    return false;
+  }
+
+  if ( m_Buffer == nullptr )
+  {
+    m_Buffer = (char*)gj_malloc( m_BufferSize, "gj: stream serializer buffer" );
+  }
+
+  _gjStreamWriter writer;
+  writer.m_Buffer = m_Buffer;
+  writer.m_Cursor = m_Buffer;
+  writer.m_End    = m_Buffer + m_BufferSize;
+  writer.m_Sink   = sink;
+  writer.m_Failed = false;
+
+  const bool walked = gj_streamValue( &writer, value, &m_Options, 0, nullptr );
+  gj_flushStreamWriter( &writer );
+  return walked && writer.m_Failed == false;
+}
+
+//---------------------------------------------------------------------------------
+// Writes into a growing buffer, copying the text of unchanged containers from the
+// last output. The new output only becomes the cache if it fits in the budget,
+// otherwise the next serialize walks everything again
+void gjSerializer::serializeCached()
+{
+  if ( m_CacheOwner == 0 )
+  {
+    m_CacheOwner = s_SerializeCache.m_NextOwner++;
+  }
+
+  // the output usually comes out close to the size it was last time
+  const size_t capacity = m_StringLen + m_StringLen / 8 + kGjMinStreamBufferSize;
+
+  _gjStreamWriter writer;
+  writer.m_Buffer = (char*)gj_malloc( capacity, "Serialized string data" );
+  writer.m_Cursor = writer.m_Buffer;
+  writer.m_End    = writer.m_Buffer + capacity;
+  writer.m_Sink   = nullptr;
+  writer.m_Failed = false;
+
+  _gjCacheWalk cache;
+  gj_initCacheWalk( &cache, m_CacheBytes > 0 ? m_StringData : nullptr, m_CacheOwner );
+  const bool walked = gj_streamValue( &writer, m_Obj, &m_Options, 0, &cache );
+  gj_releaseCacheWalk( &cache );
+
+  if ( writer.m_Cursor == writer.m_End )
+  {
+    gj_flushStreamWriter( &writer );
+  }
+  *writer.m_Cursor = '\0';
+
+  gj_removeCacheBytes( m_CacheBytes );
+  if ( m_StringData != nullptr )
+  {
+    gj_free( m_StringData );
+  }
+
+  m_StringData = writer.m_Buffer;
+  m_StringLen  = writer.m_Cursor - writer.m_Buffer;
+  m_CacheBytes = writer.m_End    - writer.m_Buffer;
+  if ( walked == false || writer.m_Failed || s_SerializeCache.m_Bytes + m_CacheBytes > s_Config.serialize_cache_budget )
+  {
+    m_CacheBytes = 0;
+  }
+  gj_addCacheBytes( m_CacheBytes );
+}
+
+//---------------------------------------------------------------------------------
+// A parallel serialize splits the children of one container into parts, and each
+// worker writes whole parts into buffers of its own with a growing stream writer.
+// The parts are joined in order once they're all done. The container split is the
+// first one down from the root with more than one child, so documents that wrap their
+// data in an object or two still get split.
+static constexpr uint32_t kMaxSerializeThreads     = 64;
+static constexpr uint32_t kSerializePartsPerThread = 8;  // more parts than threads evens out children of different sizes
+static constexpr uint32_t kMaxSerializeSplitDepth  = 32; // how far down it looks for a container to split
+
+//---------------------------------------------------------------------------------
+struct _gjSerializePart
+{
+  uint32_t m_First;   // index of the first element, or of the first member for objects
+  uint32_t m_Ordinal; // children before it in the container
+  uint32_t m_Count;
+  char*    m_Buffer;
+  size_t   m_Len;
+  bool     m_Failed;
+};
+
+//---------------------------------------------------------------------------------
+struct _gjParallelSerialize
+{
+  _gjValue*               m_Container;
+  uint32_t                m_Depth;
+  gjSerializeOptions*     m_Options;
+  _gjSerializePart*       m_Parts;
+  uint32_t                m_PartCount;
+  std::atomic< uint32_t > m_NextPart;
+};
+
+//---------------------------------------------------------------------------------
+uint32_t gj_getChildCount( const _gjValue* val )
+{
+  if ( VAL_TYPE( val ) == gjValueType::kArray )
+  {
+    return val->m_Array.m_Count;
+  }
+
+  const _gjMember* header = VAL_TYPE( val ) == gjValueType::kObject ? gj_getObjectHeader( val ) : nullptr;
+  return header != nullptr ? header->m_MemberCount : 0;
+}
+
+//---------------------------------------------------------------------------------
+// Writes what comes before a container's child: the comma after the child before it,
+// the indent and, in an object, the key. depth is the container's
+void gj_streamChildPrefix( _gjStreamWriter* writer, const gjSerializeOptions* options, uint32_t depth, uint32_t ordinal, const _gjMember* member )
+{
+  const bool pretty = options->mode == gjSerializeMode::kPretty;
+  if ( ordinal > 0 )
+  {
+    gj_streamChars( writer, ",", 1 );
+    if ( pretty )
+    {
+      gj_streamChars( writer, kNewlineStrings[ (uint32_t)options->newline_style ], kNewlineLens[ (uint32_t)options->newline_style ] );
+    }
+  }
+
+  if ( pretty )
+  {
+    gj_streamIndent( writer, ( depth + 1 ) * abs( options->indent_amt ), options->indent_amt == kGjIndentAmtTabs );
+  }
+
+  if ( member != nullptr )
+  {
+    gj_streamChars  ( writer, "\"", 1 );
+    gj_streamCString( writer, member->m_KeyStr );
+    gj_streamChars  ( writer, pretty ? "\" : " : "\":", pretty ? 4 : 2 );
+  }
+}
+
+//---------------------------------------------------------------------------------
+void gj_streamContainerOpen( _gjStreamWriter* writer, const gjSerializeOptions* options, gjValueType type )
+{
+  gj_streamChars( writer, type == gjValueType::kObject ? "{" : "[", 1 );
+  if ( options->mode == gjSerializeMode::kPretty )
+  {
+    gj_streamChars( writer, kNewlineStrings[ (uint32_t)options->newline_style ], kNewlineLens[ (uint32_t)options->newline_style ] );
+  }
+}
+
+//---------------------------------------------------------------------------------
+// Writes the close of a container that has children. depth is the container's
+void gj_streamContainerClose( _gjStreamWriter* writer, const gjSerializeOptions* options, uint32_t depth, gjValueType type )
+{
+  if ( options->mode == gjSerializeMode::kPretty )
+  {
+    gj_streamChars ( writer, kNewlineStrings[ (uint32_t)options->newline_style ], kNewlineLens[ (uint32_t)options->newline_style ] );
+    gj_streamIndent( writer, depth * abs( options->indent_amt ), options->indent_amt == kGjIndentAmtTabs );
+  }
+  gj_streamChars( writer, type == gjValueType::kObject ? "}" : "]", 1 );
+}
+
+//---------------------------------------------------------------------------------
+// returns the first child of a container. out_member is only set for objects
+gjValue gj_getFirstChild( _gjValue* container, const _gjMember** out_member )
+{
+  _gjWalkFrame frame;
+  gjValue      child;
+  gj_startWalkFrame( &frame, container, kValueIdxTail );
+  if ( gj_nextWalkChild( &frame, &child, out_member ) == false )
+  {
+    *out_member = nullptr;
+    return gjValue{};
+  }
+  return child;
+}
+
+//---------------------------------------------------------------------------------
+bool gj_initGrowingWriter( _gjStreamWriter* writer, size_t capacity )
+{
+  writer->m_Buffer = (char*)gj_malloc( capacity, "Serialized string data" );
+  writer->m_Cursor = writer->m_Buffer;
+  writer->m_End    = writer->m_Buffer != nullptr ? writer->m_Buffer + capacity : nullptr;
+  writer->m_Sink   = nullptr;
+  writer->m_Failed = writer->m_Buffer == nullptr;
+  return writer->m_Failed == false;
+}
+
+//---------------------------------------------------------------------------------
+void gj_serializePartsWorker( _gjParallelSerialize* job )
+{
+  for ( ;; )
+  {
+    const uint32_t i_part = job->m_NextPart.fetch_add( 1 );
+    if ( i_part >= job->m_PartCount )
+    {
+      return;
+    }
+
+    _gjSerializePart* part = &job->m_Parts[ i_part ];
+    _gjStreamWriter   writer;
+    if ( gj_initGrowingWriter( &writer, kGjDefaultStreamBufferSize ) )
+    {
+      _gjWalkFrame frame;
+      gj_startWalkFrame( &frame, job->m_Container, kValueIdxTail );
+      frame.m_Next    = part->m_First;
+      frame.m_Visited = part->m_Ordinal;
+
+      gjValue          child;
+      const _gjMember* member;
+      for ( uint32_t i_child = 0; i_child < part->m_Count && writer.m_Failed == false && gj_nextWalkChild( &frame, &child, &member ); ++i_child )
+      {
+        gj_streamChildPrefix( &writer, job->m_Options, job->m_Depth, frame.m_Visited - 1, member );
+        gj_streamValue      ( &writer, child, job->m_Options, job->m_Depth + 1, nullptr );
+      }
+    }
+
+    part->m_Buffer = writer.m_Buffer;
+    part->m_Len    = writer.m_Cursor - writer.m_Buffer;
+    part->m_Failed = writer.m_Failed;
+  }
+}
+
+//---------------------------------------------------------------------------------
+void gjSerializer::serializeParallel( uint32_t thread_count )
+{
+  if ( thread_count == 0 )
+  {
+    thread_count = std::thread::hardware_concurrency();
+  }
+  thread_count = thread_count == 0 ? 1 : thread_count < kMaxSerializeThreads ? thread_count : kMaxSerializeThreads;
+
+  if ( thread_count == 1 || gj_isValueAlloced( m_Obj.idx, m_Obj.gen ) == false )
+  {
+    serialize();
+    return;
+  }
+
+  // go down through containers with a single child to one that can be split
+  _gjValue*   container = gj_getValueSlot( m_Obj.idx );
+  uint32_t    depth     = 0;
+  gjValueType path_types[ kMaxSerializeSplitDepth + 1 ];
+  while ( gj_isContainer( container ) && gj_getChildCount( container ) == 1 && depth < kMaxSerializeSplitDepth )
+  {
+    const _gjMember* member;
+    const gjValue    child = gj_getFirstChild( container, &member );
+    if ( gj_isValueAlloced( child.idx, child.gen ) == false || gj_isContainer( gj_getValueSlot( child.idx ) ) == false )
+    {
+      break;
+    }
+
+    path_types[ depth++ ] = VAL_TYPE( container );
+    container             = gj_getValueSlot( child.idx );
+  }
+
+  const uint32_t child_count = gj_isContainer( container ) ? gj_getChildCount( container ) : 0;
+  if ( child_count < 2 )
+  {
+    serialize();
+    return;
+  }
+  path_types[ depth ] = VAL_TYPE( container );
+
+  // hand out the children in runs that are next to each other
+  const uint32_t    max_parts  = thread_count * kSerializePartsPerThread;
+  const uint32_t    part_count = child_count < max_parts ? child_count : max_parts;
+  _gjSerializePart* parts      = (_gjSerializePart*)gj_malloc( part_count * sizeof( *parts ), "Serialize parts" );
+  if ( parts == nullptr )
+  {
+    serialize();
+    return;
+  }
+
+  _gjWalkFrame frame;
+  uint32_t     ordinal = 0;
+  gj_startWalkFrame( &frame, container, kValueIdxTail );
+  for ( uint32_t i_part = 0; i_part < part_count; ++i_part )
+  {
+    _gjSerializePart* part = &parts[ i_part ];
+    part->m_First   = frame.m_Next;
+    part->m_Ordinal = ordinal;
+    part->m_Count   = child_count / part_count + ( i_part < child_count % part_count );
+    part->m_Buffer  = nullptr;
+    part->m_Len     = 0;
+    part->m_Failed  = true;
+    ordinal        += part->m_Count;
+
+    if ( frame.m_Elems != nullptr )
+    {
+      frame.m_Next += part->m_Count;
+    }
+    else
+    {
+      for ( uint32_t i_child = 0; i_child < part->m_Count; ++i_child )
+      {
+        frame.m_Next = gj_getMemberSlot( frame.m_Next )->m_Next;
+      }
+    }
+  }
+
+  _gjParallelSerialize job;
+  job.m_Container = container;
+  job.m_Depth     = depth;
+  job.m_Options   = &m_Options;
+  job.m_Parts     = parts;
+  job.m_PartCount = part_count;
+  job.m_NextPart  = 0;
+
+  const uint32_t worker_count = thread_count < part_count ? thread_count : part_count;
+  std::thread    threads[ kMaxSerializeThreads ];
+  for ( uint32_t i_thread = 1; i_thread < worker_count; ++i_thread )
+  {
+    threads[ i_thread ] = std::thread( gj_serializePartsWorker, &job );
+  }
+  gj_serializePartsWorker( &job );
+
+  for ( uint32_t i_thread = 1; i_thread < worker_count; ++i_thread )
+  {
+    threads[ i_thread ].join();
+  }
+
+  // the text in front of the split container and after it, for the containers around it
+  _gjStreamWriter around;
+  size_t          front_len = 0;
+  if ( gj_initGrowingWriter( &around, kGjMinStreamBufferSize ) )
+  {
+    _gjValue* path_val = gj_getValueSlot( m_Obj.idx );
+    for ( uint32_t i_depth = 0; i_depth < depth; ++i_depth )
+    {
+      const _gjMember* member;
+      const gjValue    child = gj_getFirstChild( path_val, &member );
+      gj_streamContainerOpen( &around, &m_Options, path_types[ i_depth ] );
+      gj_streamChildPrefix  ( &around, &m_Options, i_depth, 0, member );
+      path_val = gj_getValueSlot( child.idx );
+    }
+    gj_streamContainerOpen( &around, &m_Options, path_types[ depth ] );
+    front_len = around.m_Cursor - around.m_Buffer;
+
+    for ( uint32_t i_depth = depth + 1; i_depth-- > 0; )
+    {
+      gj_streamContainerClose( &around, &m_Options, i_depth, path_types[ i_depth ] );
+    }
+  }
+
+  size_t total_len = around.m_Cursor - around.m_Buffer;
+  bool   failed    = around.m_Failed;
+  for ( uint32_t i_part = 0; i_part < part_count; ++i_part )
+  {
+    total_len += parts[ i_part ].m_Len;
+    failed    |= parts[ i_part ].m_Failed;
+  }
+
+  char* str_data = failed ? nullptr : (char*)gj_malloc( total_len + 1, "Serialized string data" );
+  if ( str_data != nullptr )
+  {
+    char* cursor = str_data;
+    memcpy( cursor, around.m_Buffer, front_len );
+    cursor += front_len;
+    for ( uint32_t i_part = 0; i_part < part_count; ++i_part )
+    {
+      memcpy( cursor, parts[ i_part ].m_Buffer, parts[ i_part ].m_Len );
+      cursor += parts[ i_part ].m_Len;
+    }
+    memcpy( cursor, around.m_Buffer + front_len, ( around.m_Cursor - around.m_Buffer ) - front_len );
+    str_data[ total_len ] = '\0';
+
+    // anything cached pointed into the old text
+    gj_removeCacheBytes( m_CacheBytes );
+    m_CacheBytes = 0;
+    if ( m_StringData != nullptr )
+    {
+      gj_free( m_StringData );
+    }
+    m_StringData = str_data;
+    m_StringLen  = total_len;
+  }
+
+  for ( uint32_t i_part = 0; i_part < part_count; ++i_part )
+  {
+    if ( parts[ i_part ].m_Buffer != nullptr )
+    {
+      gj_free( parts[ i_part ].m_Buffer );
+    }
+  }
+  gj_free( parts );
+  if ( around.m_Buffer != nullptr )
+  {
+    gj_free( around.m_Buffer );
+  }
+
+  // out of memory somewhere, so try again on this thread
+  if ( str_data == nullptr )
+  {
+    serialize();
+  }
+}
+
+//---------------------------------------------------------------------------------
+// The parser reads the text once, building values straight into the pools. The only
+// scratch it keeps is a stack of the containers it is inside of, which lives in the
+// context until the nesting gets deeper than kParseInlineStackDepth.
+static constexpr uint32_t kParseInlineStackDepth = 32;
+
+//---------------------------------------------------------------------------------
+struct _gjParseContext
+{
+  const char* m_Cursor;
+  const char* m_End;
+  uint32_t*   m_Stack; // value indices of the open containers, innermost last
+  uint32_t    m_Depth;
+  uint32_t    m_BaseDepth; // containers around the text being parsed, when it's part of a bigger document
+  bool        m_Insitu; // strings are unescaped in place and borrowed from the input
+  uint32_t    m_StackCapacity;
+  uint32_t    m_InlineStack[ kParseInlineStackDepth ];
+};
+
+//---------------------------------------------------------------------------------
+// returns the character at the cursor, or '\0' once the input has run out
+inline char gj_peekChar( const _gjParseContext* ctx )
+{
+  return ctx->m_Cursor < ctx->m_End ? *ctx->m_Cursor : '\0';
+}
+
+//---------------------------------------------------------------------------------
+// Most of parsing is spent skipping whitespace and walking through string bodies.
+// The scans below test a block of bytes at a time, turning the block into a bitmask
+// of the bytes that stop the scan, so they only drop to a byte at a time for the
+// last partial block. gj_initScanFns picks the widest version the cpu supports.
+typedef const char* (*_gjScanFn)( const char* cursor, const char* end );
+
+//---------------------------------------------------------------------------------
+inline bool gj_isWhitespace( char c )
+{
+  return c == ' ' || c == '\r' || c == '\n' || c == '\t';
+}
+
+//---------------------------------------------------------------------------------
+const char* gj_skipWhitespaceScalar( const char* cursor, const char* end )
+{
+  while ( cursor < end && gj_isWhitespace( *cursor ) )
+  {
+    cursor++;
+  }
+  return cursor;
+}
+
+//---------------------------------------------------------------------------------
+// finds the first quote, backslash or null terminator
+const char* gj_findStringStopScalar( const char* cursor, const char* end )
+{
+  while ( cursor < end && *cursor != '"' && *cursor != '\\' && *cursor != '\0' )
+  {
+    cursor++;
+  }
+  return cursor;
+}
+
+//---------------------------------------------------------------------------------
+// finds the first quote, backslash, control character or byte outside ascii. Validation
+// stops at each of them, while plain ascii text is skipped a block at a time.
+const char* gj_findStringCheckScalar( const char* cursor, const char* end )
+{
+  while ( cursor < end && *cursor != '"' && *cursor != '\\' && (uint8_t)*cursor >= 0x20 && (uint8_t)*cursor < 0x80 )
+  {
+    cursor++;
+  }
+  return cursor;
+}
+
+//---------------------------------------------------------------------------------
+// finds the first byte the serializer has to escape: a quote, backslash, slash or
+// control character. Bytes outside ascii are written as they are
+const char* gj_findEscapeScalar( const char* cursor, const char* end )
+{
+  while ( cursor < end && *cursor != '"' && *cursor != '\\' && *cursor != '/' && (uint8_t)*cursor >= 0x20 )
+  {
+    cursor++;
+  }
+  return cursor;
+}
+
+//---------------------------------------------------------------------------------
+// finds the first brace, bracket, quote or null terminator
+const char* gj_findStructuralScalar( const char* cursor, const char* end )
+{
+  while ( cursor < end && *cursor != '{' && *cursor != '}' && *cursor != '[' && *cursor != ']' && *cursor != '"' && *cursor != '\0' )
+  {
+    cursor++;
+  }
+  return cursor;
+}
+
+#ifdef GJ_SIMD_X64
+
+//---------------------------------------------------------------------------------
+const char* gj_skipWhitespaceSse2( const char* cursor, const char* end )
+{
+  const __m128i space = _mm_set1_epi8( ' ' );
+  const __m128i cr    = _mm_set1_epi8( '\r' );
+  const __m128i lf    = _mm_set1_epi8( '\n' );
+  const __m128i tab   = _mm_set1_epi8( '\t' );
+
+  while ( end - cursor >= 16 )
+  {
+    const __m128i block      = _mm_loadu_si128( (const __m128i*)cursor );
+    const __m128i whitespace = _mm_or_si128( _mm_or_si128( _mm_cmpeq_epi8( block, space ), _mm_cmpeq_epi8( block, cr  ) ),
+                                             _mm_or_si128( _mm_cmpeq_epi8( block, lf    ), _mm_cmpeq_epi8( block, tab ) ) );
+    const uint32_t stop_mask = ~(uint32_t)_mm_movemask_epi8( whitespace ) & 0xffff;
+    if ( stop_mask != 0 )
+    {
+      return cursor + gj_Bsf( stop_mask );
+    }
+    cursor += 16;
+  }
+
+  return gj_skipWhitespaceScalar( cursor, end );
+}
+
+//---------------------------------------------------------------------------------
+const char* gj_findStringStopSse2( const char* cursor, const char* end )
+{
+  const __m128i quote     = _mm_set1_epi8( '"' );
+  const __m128i backslash = _mm_set1_epi8( '\\' );
+  const __m128i zero      = _mm_setzero_si128();
+
+  while ( end - cursor >= 16 )
+  {
+    const __m128i block = _mm_loadu_si128( (const __m128i*)cursor );
+    const __m128i stops = _mm_or_si128( _mm_or_si128( _mm_cmpeq_epi8( block, quote ), _mm_cmpeq_epi8( block, backslash ) ),
+                                        _mm_cmpeq_epi8( block, zero ) );
+    const uint32_t stop_mask = (uint32_t)_mm_movemask_epi8( stops );
+    if ( stop_mask != 0 )
+    {
+      return cursor + gj_Bsf( stop_mask );
+    }
+    cursor += 16;
+  }
+
+  return gj_findStringStopScalar( cursor, end );
+}
+
+//---------------------------------------------------------------------------------
+// As a signed compare, "less than 0x20" catches the control characters and every
+// byte outside ascii at once
+const char* gj_findStringCheckSse2( const char* cursor, const char* end )
+{
+  const __m128i quote     = _mm_set1_epi8( '"' );
+  const __m128i backslash = _mm_set1_epi8( '\\' );
+  const __m128i space     = _mm_set1_epi8( 0x20 );
+
+  while ( end - cursor >= 16 )
+  {
+    const __m128i block = _mm_loadu_si128( (const __m128i*)cursor );
+    const __m128i stops = _mm_or_si128( _mm_or_si128( _mm_cmpeq_epi8( block, quote ), _mm_cmpeq_epi8( block, backslash ) ),
+                                        _mm_cmplt_epi8( block, space ) );
+    const uint32_t stop_mask = (uint32_t)_mm_movemask_epi8( stops );
+    if ( stop_mask != 0 )
+    {
+      return cursor + gj_Bsf( stop_mask );
+    }
+    cursor += 16;
+  }
+
+  return gj_findStringCheckScalar( cursor, end );
+}
+
+//---------------------------------------------------------------------------------
+// The byte compares are signed, which would catch everything past ascii too, so a
+// control character is a byte that min( byte, 0x1f ) leaves alone
+const char* gj_findEscapeSse2( const char* cursor, const char* end )
+{
+  const __m128i quote       = _mm_set1_epi8( '"' );
+  const __m128i backslash   = _mm_set1_epi8( '\\' );
+  const __m128i slash       = _mm_set1_epi8( '/' );
+  const __m128i max_control = _mm_set1_epi8( 0x1f );
+
+  while ( end - cursor >= 16 )
+  {
+    const __m128i block = _mm_loadu_si128( (const __m128i*)cursor );
+    const __m128i stops = _mm_or_si128( _mm_or_si128( _mm_cmpeq_epi8( block, quote ), _mm_cmpeq_epi8( block, backslash ) ),
+                                        _mm_or_si128( _mm_cmpeq_epi8( block, slash ), _mm_cmpeq_epi8( _mm_min_epu8( block, max_control ), block ) ) );
+    const uint32_t stop_mask = (uint32_t)_mm_movemask_epi8( stops );
+    if ( stop_mask != 0 )
+    {
+      return cursor + gj_Bsf( stop_mask );
+    }
+    cursor += 16;
+  }
+
+  return gj_findEscapeScalar( cursor, end );
+}
+
+//---------------------------------------------------------------------------------
+// Setting bit 5 turns '[' and ']' into '{' and '}', so the brackets take two compares
+const char* gj_findStructuralSse2( const char* cursor, const char* end )
+{
+  const __m128i bit5        = _mm_set1_epi8( 0x20 );
+  const __m128i open_brace  = _mm_set1_epi8( '{' );
+  const __m128i close_brace = _mm_set1_epi8( '}' );
+  const __m128i quote       = _mm_set1_epi8( '"' );
+  const __m128i zero        = _mm_setzero_si128();
+
+  while ( end - cursor >= 16 )
+  {
+    const __m128i block  = _mm_loadu_si128( (const __m128i*)cursor );
+    const __m128i folded = _mm_or_si128( block, bit5 );
+    const __m128i stops  = _mm_or_si128( _mm_or_si128( _mm_cmpeq_epi8( folded, open_brace ), _mm_cmpeq_epi8( folded, close_brace ) ),
+                                         _mm_or_si128( _mm_cmpeq_epi8( block, quote ), _mm_cmpeq_epi8( block, zero ) ) );
+    const uint32_t stop_mask = (uint32_t)_mm_movemask_epi8( stops );
+    if ( stop_mask != 0 )
+    {
+      return cursor + gj_Bsf( stop_mask );
+    }
+    cursor += 16;
+  }
+
+  return gj_findStructuralScalar( cursor, end );
+}
+
+//---------------------------------------------------------------------------------
+GJ_TARGET_AVX2 const char* gj_skipWhitespaceAvx2( const char* cursor, const char* end )
+{
+  const __m256i space = _mm256_set1_epi8( ' ' );
+  const __m256i cr    = _mm256_set1_epi8( '\r' );
+  const __m256i lf    = _mm256_set1_epi8( '\n' );
+  const __m256i tab   = _mm256_set1_epi8( '\t' );
+
+  while ( end - cursor >= 32 )
+  {
+    const __m256i block      = _mm256_loadu_si256( (const __m256i*)cursor );
+    const __m256i whitespace = _mm256_or_si256( _mm256_or_si256( _mm256_cmpeq_epi8( block, space ), _mm256_cmpeq_epi8( block, cr  ) ),
+                                                _mm256_or_si256( _mm256_cmpeq_epi8( block, lf    ), _mm256_cmpeq_epi8( block, tab ) ) );
+    const uint32_t stop_mask = ~(uint32_t)_mm256_movemask_epi8( whitespace );
+    if ( stop_mask != 0 )
+    {
+      return cursor + gj_Bsf( stop_mask );
+    }
+    cursor += 32;
+  }
+
+  return gj_skipWhitespaceSse2( cursor, end );
+}
+
+//---------------------------------------------------------------------------------
+GJ_TARGET_AVX2 const char* gj_findStringStopAvx2( const char* cursor, const char* end )
+{
+  const __m256i quote     = _mm256_set1_epi8( '"' );
+  const __m256i backslash = _mm256_set1_epi8( '\\' );
+  const __m256i zero      = _mm256_setzero_si256();
+
+  while ( end - cursor >= 32 )
+  {
+    const __m256i block = _mm256_loadu_si256( (const __m256i*)cursor );
+    const __m256i stops = _mm256_or_si256( _mm256_or_si256( _mm256_cmpeq_epi8( block, quote ), _mm256_cmpeq_epi8( block, backslash ) ),
+                                           _mm256_cmpeq_epi8( block, zero ) );
+    const uint32_t stop_mask = (uint32_t)_mm256_movemask_epi8( stops );
+    if ( stop_mask != 0 )
+    {
+      return cursor + gj_Bsf( stop_mask );
+    }
+    cursor += 32;
+  }
+
+  return gj_findStringStopSse2( cursor, end );
+}
+
+//---------------------------------------------------------------------------------
+GJ_TARGET_AVX2 const char* gj_findStringCheckAvx2( const char* cursor, const char* end )
+{
+  const __m256i quote     = _mm256_set1_epi8( '"' );
+  const __m256i backslash = _mm256_set1_epi8( '\\' );
+  const __m256i space     = _mm256_set1_epi8( 0x20 );
+
+  while ( end - cursor >= 32 )
+  {
+    const __m256i block = _mm256_loadu_si256( (const __m256i*)cursor );
+    const __m256i stops = _mm256_or_si256( _mm256_or_si256( _mm256_cmpeq_epi8( block, quote ), _mm256_cmpeq_epi8( block, backslash ) ),
+                                           _mm256_cmpgt_epi8( space, block ) );
+    const uint32_t stop_mask = (uint32_t)_mm256_movemask_epi8( stops );
+    if ( stop_mask != 0 )
+    {
+      return cursor + gj_Bsf( stop_mask );
+    }
+    cursor += 32;
+  }
+
+  return gj_findStringCheckSse2( cursor, end );
+}
+
+//---------------------------------------------------------------------------------
+GJ_TARGET_AVX2 const char* gj_findEscapeAvx2( const char* cursor, const char* end )
+{
+  const __m256i quote       = _mm256_set1_epi8( '"' );
+  const __m256i backslash   = _mm256_set1_epi8( '\\' );
+  const __m256i slash       = _mm256_set1_epi8( '/' );
+  const __m256i max_control = _mm256_set1_epi8( 0x1f );
+
+  while ( end - cursor >= 32 )
+  {
+    const __m256i block = _mm256_loadu_si256( (const __m256i*)cursor );
+    const __m256i stops = _mm256_or_si256( _mm256_or_si256( _mm256_cmpeq_epi8( block, quote ), _mm256_cmpeq_epi8( block, backslash ) ),
+                                           _mm256_or_si256( _mm256_cmpeq_epi8( block, slash ), _mm256_cmpeq_epi8( _mm256_min_epu8( block, max_control ), block ) ) );
+    const uint32_t stop_mask = (uint32_t)_mm256_movemask_epi8( stops );
+    if ( stop_mask != 0 )
+    {
+      return cursor + gj_Bsf( stop_mask );
+    }
+    cursor += 32;
+  }
+
+  return gj_findEscapeSse2( cursor, end );
+}
+
+//---------------------------------------------------------------------------------
+GJ_TARGET_AVX2 const char* gj_findStructuralAvx2( const char* cursor, const char* end )
+{
+  const __m256i bit5        = _mm256_set1_epi8( 0x20 );
+  const __m256i open_brace  = _mm256_set1_epi8( '{' );
+  const __m256i close_brace = _mm256_set1_epi8( '}' );
+  const __m256i quote       = _mm256_set1_epi8( '"' );
+  const __m256i zero        = _mm256_setzero_si256();
+
+  while ( end - cursor >= 32 )
+  {
+    const __m256i block  = _mm256_loadu_si256( (const __m256i*)cursor );
+    const __m256i folded = _mm256_or_si256( block, bit5 );
+    const __m256i stops  = _mm256_or_si256( _mm256_or_si256( _mm256_cmpeq_epi8( folded, open_brace ), _mm256_cmpeq_epi8( folded, close_brace ) ),
+                                            _mm256_or_si256( _mm256_cmpeq_epi8( block, quote ), _mm256_cmpeq_epi8( block, zero ) ) );
+    const uint32_t stop_mask = (uint32_t)_mm256_movemask_epi8( stops );
+    if ( stop_mask != 0 )
+    {
+      return cursor + gj_Bsf( stop_mask );
+    }
+    cursor += 32;
+  }
+
+  return gj_findStructuralSse2( cursor, end );
+}
+
+//---------------------------------------------------------------------------------
+bool gj_cpuHasAvx2()
+{
+#ifdef _MSC_VER
+  int cpu_info[ 4 ];
+  __cpuid( cpu_info, 0 );
+  if ( cpu_info[ 0 ] < 7 )
+  {
+    return false;
+  }
+
+  // the os has to save the ymm registers too
+  __cpuid( cpu_info, 1 );
+  const bool has_osxsave = ( cpu_info[ 2 ] & ( 1 << 27 ) ) != 0;
+  if ( has_osxsave == false || ( _xgetbv( 0 ) & 0x6 ) != 0x6 )
+  {
+    return false;
+  }
+
+  __cpuidex( cpu_info, 7, 0 );
+  return ( cpu_info[ 1 ] & ( 1 << 5 ) ) != 0;
+#else
+  return __builtin_cpu_supports( "avx2" );
+#endif
+}
+
+#endif
+
+//---------------------------------------------------------------------------------
+static _gjScanFn s_SkipWhitespaceFn = gj_skipWhitespaceScalar;
+static _gjScanFn s_FindStringStopFn = gj_findStringStopScalar;
+static _gjScanFn s_FindStructuralFn = gj_findStructuralScalar;
+static _gjScanFn s_FindStringCheckFn = gj_findStringCheckScalar;
+static _gjScanFn s_FindEscapeFn      = gj_findEscapeScalar;
+
+//---------------------------------------------------------------------------------
+void gj_initScanFns()
+{
+#ifdef GJ_SIMD_X64
+  if ( gj_cpuHasAvx2() )
+  {
+    s_SkipWhitespaceFn = gj_skipWhitespaceAvx2;
+    s_FindStringStopFn = gj_findStringStopAvx2;
+    s_FindStructuralFn = gj_findStructuralAvx2;
+    s_FindStringCheckFn = gj_findStringCheckAvx2;
+    s_FindEscapeFn      = gj_findEscapeAvx2;
+  }
+  else
+  {
+    s_SkipWhitespaceFn = gj_skipWhitespaceSse2;
+    s_FindStringStopFn = gj_findStringStopSse2;
+    s_FindStructuralFn = gj_findStructuralSse2;
+    s_FindStringCheckFn = gj_findStringCheckSse2;
+    s_FindEscapeFn      = gj_findEscapeSse2;
+  }
+#else
+  s_SkipWhitespaceFn = gj_skipWhitespaceScalar;
+  s_FindStringStopFn = gj_findStringStopScalar;
+  s_FindStructuralFn = gj_findStructuralScalar;
+  s_FindStringCheckFn = gj_findStringCheckScalar;
+  s_FindEscapeFn      = gj_findEscapeScalar;
+#endif
+}
+
+//---------------------------------------------------------------------------------
+const char* gj_findEscape( const char* cursor, const char* end )
+{
+  return s_FindEscapeFn( cursor, end );
+}
+
+//---------------------------------------------------------------------------------
+void gj_skipWhitespace( _gjParseContext* ctx )
+{
+  // minified input rarely has any, so check one byte before starting a scan
+  if ( ctx->m_Cursor < ctx->m_End && gj_isWhitespace( *ctx->m_Cursor ) )
+  {
+    ctx->m_Cursor = s_SkipWhitespaceFn( ctx->m_Cursor + 1, ctx->m_End );
+  }
+}
+
+//---------------------------------------------------------------------------------
+bool gj_isDigit( char c )
+{
+  return c >= '0' && c <= '9';
+}
+
+//---------------------------------------------------------------------------------
+bool gj_pushParseContainer( _gjParseContext* ctx, uint32_t value_idx )
+{
+  if ( ctx->m_Depth == ctx->m_StackCapacity )
+  {
+    const uint32_t new_capacity = ctx->m_StackCapacity * 2;
+    uint32_t*      new_stack    = (uint32_t*)gj_malloc( new_capacity * sizeof( *new_stack ), "Parser stack" );
+    if ( new_stack == nullptr )
+    {
+      gj_assert( "Ran out of memory for the parser stack. You may be out of memory" );
+      return false;
+    }
+
+    memcpy( new_stack, ctx->m_Stack, ctx->m_Depth * sizeof( *new_stack ) );
+    if ( ctx->m_Stack != ctx->m_InlineStack )
+    {
+      gj_free( ctx->m_Stack );
+    }
+
+    ctx->m_Stack         = new_stack;
+    ctx->m_StackCapacity = new_capacity;
+  }
+
+  ctx->m_Stack[ ctx->m_Depth++ ] = value_idx;
+  return true;
+}
+
+//---------------------------------------------------------------------------------
+// returns the character an escape sequence stands for, or '\0' for one we don't know
+inline char gj_unescapeChar( char escaped )
+{
+  switch ( escaped )
+  {
+    case '"': // These just grab the next char
+    case '\\':
+    case '/':
+    {
+      return escaped;
+    }
+    case 'n':
+    {
+      return '\n';
+    }
+    case 'r':
+    {
+      return '\r';
+    }
+    case 't':
+    {
+      return '\t';
+    }
+    case 'b':
+    {
+      return '\b';
+    }
+    case 'f':
+    {
+      return '\f';
+    }
+  }
+
+  return '\0';
+}
+
+//---------------------------------------------------------------------------------
+// Reads the 4 hex digits of a \u escape.
+// returns the code unit, or kInvalidCodeUnit if they aren't all there
+static constexpr uint32_t kInvalidCodeUnit = (uint32_t)-1;
+uint32_t gj_readEscapeHex( const char* digits, const char* end )
+{
+  if ( end - digits < 4 )
+  {
+    return kInvalidCodeUnit;
+  }
+
+  uint32_t code_unit = 0;
+  for ( uint32_t i_digit = 0; i_digit < 4; ++i_digit )
+  {
+    const char c     = digits[ i_digit ];
+    const char lower = c | 0x20;
+    if ( c >= '0' && c <= '9' )
+    {
+      code_unit = ( code_unit << 4 ) | (uint32_t)( c - '0' );
+    }
+    else if ( lower >= 'a' && lower <= 'f' )
+    {
+      code_unit = ( code_unit << 4 ) | (uint32_t)( lower - 'a' + 10 );
+    }
+    else
+    {
+      return kInvalidCodeUnit;
+    }
+  }
+
+  return code_unit;
+}
+
+//---------------------------------------------------------------------------------
+// Decodes the escape sequence after a backslash into out_chars, which needs room for 4.
+// A \u escape is written as utf-8, taking the escape after it along when the two make
+// a surrogate pair. A surrogate without its other half becomes U+FFFD, and U+0000 is
+// refused since strings end at a null terminator.
+// returns how many chars were written, or 0 for a sequence we don't accept. On success,
+// out_escape_end is set past the sequence
+uint32_t gj_unescapeSequence( const char* escape, const char* end, char* out_chars, const char** out_escape_end )
+{
+  if ( escape >= end )
+  {
+    return 0;
+  }
+
+  if ( *escape != 'u' )
+  {
+    out_chars[ 0 ]  = gj_unescapeChar( *escape );
+    *out_escape_end = escape + 1;
+    return out_chars[ 0 ] != '\0' ? 1 : 0;
+  }
+
+  const char* escape_end = escape + 5;
+  uint32_t    code_point = gj_readEscapeHex( escape + 1, end );
+  if ( code_point == kInvalidCodeUnit || code_point == 0 )
+  {
+    return 0;
+  }
+
+  if ( code_point >= 0xd800 && code_point < 0xdc00 )
+  {
+    const bool     has_next  = end - escape_end >= 6 && escape_end[ 0 ] == '\\' && escape_end[ 1 ] == 'u';
+    const uint32_t low_half  = has_next ? gj_readEscapeHex( escape_end + 2, end ) : kInvalidCodeUnit;
+    if ( low_half >= 0xdc00 && low_half < 0xe000 )
+    {
+      code_point  = 0x10000 + ( ( code_point - 0xd800 ) << 10 ) + ( low_half - 0xdc00 );
+      escape_end += 6;
+    }
+    else
+    {
+      code_point = 0xfffd;
+    }
+  }
+  else if ( code_point >= 0xdc00 && code_point < 0xe000 )
+  {
+    code_point = 0xfffd;
+  }
+
+  *out_escape_end = escape_end;
+  if ( code_point < 0x80 )
+  {
+    out_chars[ 0 ] = (char)code_point;
+    return 1;
+  }
+
+  if ( code_point < 0x800 )
+  {
+    out_chars[ 0 ] = (char)( 0xc0 | ( code_point >> 6 ) );
+    out_chars[ 1 ] = (char)( 0x80 | ( code_point & 0x3f ) );
+    return 2;
+  }
+
+  if ( code_point < 0x10000 )
+  {
+    out_chars[ 0 ] = (char)( 0xe0 | ( code_point >> 12 ) );
+    out_chars[ 1 ] = (char)( 0x80 | ( ( code_point >> 6 ) & 0x3f ) );
+    out_chars[ 2 ] = (char)( 0x80 | ( code_point & 0x3f ) );
+    return 3;
+  }
+
+  out_chars[ 0 ] = (char)( 0xf0 | ( code_point >> 18 ) );
+  out_chars[ 1 ] = (char)( 0x80 | ( ( code_point >> 12 ) & 0x3f ) );
+  out_chars[ 2 ] = (char)( 0x80 | ( ( code_point >> 6 ) & 0x3f ) );
+  out_chars[ 3 ] = (char)( 0x80 | ( code_point & 0x3f ) );
+  return 4;
+}
+
+//---------------------------------------------------------------------------------
+// Decodes the escaped string from json_str to json_end into c_string, which may be
+// json_str itself since no escape decodes to more chars than it takes up.
+// returns the decoded length, or (uint32_t)-1 for a bad escape sequence
+uint32_t gj_jsonToCString( char* c_string, const char* json_str, const char* json_end )
+{
+  uint32_t    str_len = 0;
+  const char* src     = json_str;
+  while ( src < json_end )
+  {
+    const char* escape  = (const char*)memchr( src, '\\', (size_t)( json_end - src ) );
+    const char* run_end = escape != nullptr ? escape : json_end;
+    memmove( c_string + str_len, src, (size_t)( run_end - src ) );
+    str_len += (uint32_t)( run_end - src );
+    if ( escape == nullptr )
+    {
+      break;
+    }
+
+    const uint32_t char_count = gj_unescapeSequence( escape + 1, json_end, c_string + str_len, &src );
+    if ( char_count == 0 )
+    {
+      gj_assert( "error parsing string literal: unrecognized escape sequence" );
+      return (uint32_t)-1;
+    }
+    str_len += char_count;
+  }
+
+  return str_len;
+}
+
+//---------------------------------------------------------------------------------
+uint32_t gj_unescapeString( const char* text, size_t text_len, char* out_str, uint32_t out_str_len )
+{
+  const char* end     = text + text_len;
+  uint32_t    str_len = 0;
+  for ( const char* src = text; src < end; )
+  {
+    char     chars[ 4 ] = { *src++ };
+    uint32_t char_count = 1;
+    if ( chars[ 0 ] == '\\' )
+    {
+      char_count = gj_unescapeSequence( src, end, chars, &src );
+      if ( char_count == 0 )
+      {
+        gj_assert( "error parsing string literal: unrecognized escape sequence" );
+        break;
+      }
+    }
+
+    for ( uint32_t i_char = 0; i_char < char_count; ++i_char )
+    {
+      if ( str_len + 1 < out_str_len )
+      {
+        out_str[ str_len ] = chars[ i_char ];
+      }
+      str_len++;
+    }
+  }
+
+  if ( out_str_len > 0 )
+  {
+    out_str[ str_len < out_str_len ? str_len : out_str_len - 1 ] = '\0';
+  }
+
+  return str_len;
+}
+
+//---------------------------------------------------------------------------------
+// Finds the end of the string literal whose contents start at json_str.
+// returns the closing quote, or nullptr if there isn't one
+const char* gj_findClosingQuote( const _gjParseContext* ctx, const char* json_str, uint32_t* out_escape_count )
+{
+  const char* cursor       = json_str;
+  uint32_t    escape_count = 0;
+  while ( true )
+  {
+    cursor = s_FindStringStopFn( cursor, ctx->m_End );
+    if ( cursor == ctx->m_End || *cursor != '\\' )
+    {
+      break;
+    }
+
+    // skip whatever is escaped, it can't end the string
+    escape_count++;
+    cursor += ( ctx->m_End - cursor >= 2 ) ? 2 : 1;
+  }
+
+  if ( cursor >= ctx->m_End || *cursor != '"' )
+  {
+    gj_assert( "error parsing string literal: missing closing quote" );
+    return nullptr;
+  }
+
+  *out_escape_count = escape_count;
+  return cursor;
+}
+
+//---------------------------------------------------------------------------------
+// frees a string from gj_parseString that never made it into a value
+inline void gj_freeParsedString( const _gjParseContext* ctx, char* str )
+{
+  if ( ctx->m_Insitu == false )
+  {
+    gj_free( str );
+  }
+}
+
+//---------------------------------------------------------------------------------
+// Reads the string literal at the cursor into a new heap string with its escapes
+// decoded, leaving the cursor after the closing quote. When parsing in place, the
+// string is decoded over the literal instead, which it is never longer than.
+// returns nullptr if the literal is malformed
+char* gj_parseString( _gjParseContext* ctx, uint32_t* out_len )
+{
+  const char* json_str = ctx->m_Cursor + 1;
+  uint32_t    escape_count;
+  const char* cursor   = gj_findClosingQuote( ctx, json_str, &escape_count );
+  if ( cursor == nullptr )
+  {
+    return nullptr;
+  }
+
+  if ( (size_t)( cursor - json_str ) >= kUnreasonablyLargeStringSize )
+  {
+    gj_assert( "error parsing string literal: string is unreasonably large" );
+    return nullptr;
+  }
+
+  // no escape decodes to more chars than it takes up, so this is enough room
+  uint32_t c_string_len = (uint32_t)( cursor - json_str ) - escape_count;
+  char*    c_string     = ctx->m_Insitu ? (char*)json_str : (char*)gj_malloc( c_string_len + 1, "Value String" );
+  if ( c_string == nullptr )
+  {
+    gj_assert( "Ran out of memory for a parsed string. You may be out of memory" );
+    return nullptr;
+  }
+
+  if ( escape_count == 0 )
+  {
+    if ( ctx->m_Insitu == false )
+    {
+      memcpy( c_string, json_str, c_string_len );
+    }
+  }
+  else
+  {
+    c_string_len = gj_jsonToCString( c_string, json_str, cursor );
+    if ( c_string_len == (uint32_t)-1 )
+    {
+      gj_freeParsedString( ctx, c_string );
+      return nullptr;
+    }
+  }
+
+  c_string[ c_string_len ] = '\0';
+  ctx->m_Cursor = cursor + 1;
+  *out_len      = c_string_len;
+
+  return c_string;
+}
+
+//---------------------------------------------------------------------------------
+// Reads `"key" :` at the cursor, for the next member of the object being parsed
+bool gj_parseKey( _gjParseContext* ctx, char** out_key_str, uint32_t* out_key_hash )
+{
+  gj_skipWhitespace( ctx );
+  if ( gj_peekChar( ctx ) != '"' )
+  {
+    gj_assert( "Unexpected token! Expected a member key" );
+    return false;
+  }
+
+  uint32_t key_len;
+  char*    key_str = gj_parseString( ctx, &key_len );
+  if ( key_str == nullptr )
+  {
+    return false;
+  }
+
+  gj_skipWhitespace( ctx );
+  if ( gj_peekChar( ctx ) != ':' )
+  {
+    gj_freeParsedString( ctx, key_str );
+    gj_assert( "Unexpected token! Expected a ':' after the member key" );
+    return false;
+  }
+  ctx->m_Cursor++;
+
+  *out_key_str  = key_str;
+  *out_key_hash = gj_crc32( key_str, key_len );
+  return true;
+}
+
+//---------------------------------------------------------------------------------
+bool gj_parseLiteral( _gjParseContext* ctx, const char* literal, size_t literal_len )
+{
+  if ( (size_t)( ctx->m_End - ctx->m_Cursor ) >= literal_len && strncmp( ctx->m_Cursor, literal, literal_len ) == 0 )
+  {
+    ctx->m_Cursor += literal_len;
+    return true;
+  }
+
+  gj_assert( "unrecognized format!" );
+  return false;
+}
+
+//---------------------------------------------------------------------------------
+// Numbers are read in a single pass with no help from libc, so they don't depend on
+// the current locale. Integer digits are accumulated eight at a time, and decimals
+// are turned into floats with the Eisel-Lemire algorithm, which gets the correctly
+// rounded float from a 128 bit multiply in almost every case. Inputs with more than
+// 19 significant digits that land close to a halfway point between two floats are
+// settled exactly with big integer arithmetic.
+static constexpr uint64_t kMinNineteenDigits  = 1000000000000000000ull;
+static constexpr int32_t  kFloatMinExp10      = -65; // anything smaller rounds to zero
+static constexpr int32_t  kFloatMaxExp10      = 38;  // anything larger rounds to infinity
+static constexpr uint32_t kFloatMantissaBits  = 23;
+static constexpr int32_t  kFloatMinExp2       = -127;
+static constexpr int32_t  kFloatInfiniteExp2  = 0xff;
+static constexpr uint32_t kFloatMaxExactInt   = 1u << 24;
+static constexpr size_t   kMaxExactDigitCount = 200; // enough to tell any float halfway point apart
+
+//---------------------------------------------------------------------------------
+// 5^q for q in [ kFloatMinExp10, kFloatMaxExp10 ], normalized so the top bit is set
+// and truncated to 128 bits, high half first. Negative powers are rounded up.
+static constexpr uint64_t kPow5Table[] =
+{
+  0x86ccbb52ea94baea, 0x98e947129fc2b4e9, // 5^-65
+  0xa87fea27a539e9a5, 0x3f2398d747b36224, // 5^-64
+  0xd29fe4b18e88640e, 0x8eec7f0d19a03aad, // 5^-63
+  0x83a3eeeef9153e89, 0x1953cf68300424ac, // 5^-62
+  0xa48ceaaab75a8e2b, 0x5fa8c3423c052dd7, // 5^-61
+  0xcdb02555653131b6, 0x3792f412cb06794d, // 5^-60
+  0x808e17555f3ebf11, 0xe2bbd88bbee40bd0, // 5^-59
+  0xa0b19d2ab70e6ed6, 0x5b6aceaeae9d0ec4, // 5^-58
+  0xc8de047564d20a8b, 0xf245825a5a445275, // 5^-57
+  0xfb158592be068d2e, 0xeed6e2f0f0d56712, // 5^-56
+  0x9ced737bb6c4183d, 0x55464dd69685606b, // 5^-55
+  0xc428d05aa4751e4c, 0xaa97e14c3c26b886, // 5^-54
+  0xf53304714d9265df, 0xd53dd99f4b3066a8, // 5^-53
+  0x993fe2c6d07b7fab, 0xe546a8038efe4029, // 5^-52
+  0xbf8fdb78849a5f96, 0xde98520472bdd033, // 5^-51
+  0xef73d256a5c0f77c, 0x963e66858f6d4440, // 5^-50
+  0x95a8637627989aad, 0xdde7001379a44aa8, // 5^-49
+  0xbb127c53b17ec159, 0x5560c018580d5d52, // 5^-48
+  0xe9d71b689dde71af, 0xaab8f01e6e10b4a6, // 5^-47
+  0x9226712162ab070d, 0xcab3961304ca70e8, // 5^-46
+  0xb6b00d69bb55c8d1, 0x3d607b97c5fd0d22, // 5^-45
+  0xe45c10c42a2b3b05, 0x8cb89a7db77c506a, // 5^-44
+  0x8eb98a7a9a5b04e3, 0x77f3608e92adb242, // 5^-43
+  0xb267ed1940f1c61c, 0x55f038b237591ed3, // 5^-42
+  0xdf01e85f912e37a3, 0x6b6c46dec52f6688, // 5^-41
+  0x8b61313bbabce2c6, 0x2323ac4b3b3da015, // 5^-40
+  0xae397d8aa96c1b77, 0xabec975e0a0d081a, // 5^-39
+  0xd9c7dced53c72255, 0x96e7bd358c904a21, // 5^-38
+  0x881cea14545c7575, 0x7e50d64177da2e54, // 5^-37
+  0xaa242499697392d2, 0xdde50bd1d5d0b9e9, // 5^-36
+  0xd4ad2dbfc3d07787, 0x955e4ec64b44e864, // 5^-35
+  0x84ec3c97da624ab4, 0xbd5af13bef0b113e, // 5^-34
+  0xa6274bbdd0fadd61, 0xecb1ad8aeacdd58e, // 5^-33
+  0xcfb11ead453994ba, 0x67de18eda5814af2, // 5^-32
+  0x81ceb32c4b43fcf4, 0x80eacf948770ced7, // 5^-31
+  0xa2425ff75e14fc31, 0xa1258379a94d028d, // 5^-30
+  0xcad2f7f5359a3b3e, 0x096ee45813a04330, // 5^-29
+  0xfd87b5f28300ca0d, 0x8bca9d6e188853fc, // 5^-28
+  0x9e74d1b791e07e48, 0x775ea264cf55347e, // 5^-27
+  0xc612062576589dda, 0x95364afe032a819e, // 5^-26
+  0xf79687aed3eec551, 0x3a83ddbd83f52205, // 5^-25
+  0x9abe14cd44753b52, 0xc4926a9672793543, // 5^-24
+  0xc16d9a0095928a27, 0x75b7053c0f178294, // 5^-23
+  0xf1c90080baf72cb1, 0x5324c68b12dd6339, // 5^-22
+  0x971da05074da7bee, 0xd3f6fc16ebca5e04, // 5^-21
+  0xbce5086492111aea, 0x88f4bb1ca6bcf585, // 5^-20
+  0xec1e4a7db69561a5, 0x2b31e9e3d06c32e6, // 5^-19
+  0x9392ee8e921d5d07, 0x3aff322e62439fd0, // 5^-18
+  0xb877aa3236a4b449, 0x09befeb9fad487c3, // 5^-17
+  0xe69594bec44de15b, 0x4c2ebe687989a9b4, // 5^-16
+  0x901d7cf73ab0acd9, 0x0f9d37014bf60a11, // 5^-15
+  0xb424dc35095cd80f, 0x538484c19ef38c95, // 5^-14
+  0xe12e13424bb40e13, 0x2865a5f206b06fba, // 5^-13
+  0x8cbccc096f5088cb, 0xf93f87b7442e45d4, // 5^-12
+  0xafebff0bcb24aafe, 0xf78f69a51539d749, // 5^-11
+  0xdbe6fecebdedd5be, 0xb573440e5a884d1c, // 5^-10
+  0x89705f4136b4a597, 0x31680a88f8953031, // 5^-9
+  0xabcc77118461cefc, 0xfdc20d2b36ba7c3e, // 5^-8
+  0xd6bf94d5e57a42bc, 0x3d32907604691b4d, // 5^-7
+  0x8637bd05af6c69b5, 0xa63f9a49c2c1b110, // 5^-6
+  0xa7c5ac471b478423, 0x0fcf80dc33721d54, // 5^-5
+  0xd1b71758e219652b, 0xd3c36113404ea4a9, // 5^-4
+  0x83126e978d4fdf3b, 0x645a1cac083126ea, // 5^-3
+  0xa3d70a3d70a3d70a, 0x3d70a3d70a3d70a4, // 5^-2
+  0xcccccccccccccccc, 0xcccccccccccccccd, // 5^-1
+  0x8000000000000000, 0x0000000000000000, // 5^0
+  0xa000000000000000, 0x0000000000000000, // 5^1
+  0xc800000000000000, 0x0000000000000000, // 5^2
+  0xfa00000000000000, 0x0000000000000000, // 5^3
+  0x9c40000000000000, 0x0000000000000000, // 5^4
+  0xc350000000000000, 0x0000000000000000, // 5^5
+  0xf424000000000000, 0x0000000000000000, // 5^6
+  0x9896800000000000, 0x0000000000000000, // 5^7
+  0xbebc200000000000, 0x0000000000000000, // 5^8
+  0xee6b280000000000, 0x0000000000000000, // 5^9
+  0x9502f90000000000, 0x0000000000000000, // 5^10
+  0xba43b74000000000, 0x0000000000000000, // 5^11
+  0xe8d4a51000000000, 0x0000000000000000, // 5^12
+  0x9184e72a00000000, 0x0000000000000000, // 5^13
+  0xb5e620f480000000, 0x0000000000000000, // 5^14
+  0xe35fa931a0000000, 0x0000000000000000, // 5^15
+  0x8e1bc9bf04000000, 0x0000000000000000, // 5^16
+  0xb1a2bc2ec5000000, 0x0000000000000000, // 5^17
+  0xde0b6b3a76400000, 0x0000000000000000, // 5^18
+  0x8ac7230489e80000, 0x0000000000000000, // 5^19
+  0xad78ebc5ac620000, 0x0000000000000000, // 5^20
+  0xd8d726b7177a8000, 0x0000000000000000, // 5^21
+  0x878678326eac9000, 0x0000000000000000, // 5^22
+  0xa968163f0a57b400, 0x0000000000000000, // 5^23
+  0xd3c21bcecceda100, 0x0000000000000000, // 5^24
+  0x84595161401484a0, 0x0000000000000000, // 5^25
+  0xa56fa5b99019a5c8, 0x0000000000000000, // 5^26
+  0xcecb8f27f4200f3a, 0x0000000000000000, // 5^27
+  0x813f3978f8940984, 0x4000000000000000, // 5^28
+  0xa18f07d736b90be5, 0x5000000000000000, // 5^29
+  0xc9f2c9cd04674ede, 0xa400000000000000, // 5^30
+  0xfc6f7c4045812296, 0x4d00000000000000, // 5^31
+  0x9dc5ada82b70b59d, 0xf020000000000000, // 5^32
+  0xc5371912364ce305, 0x6c28000000000000, // 5^33
+  0xf684df56c3e01bc6, 0xc732000000000000, // 5^34
+  0x9a130b963a6c115c, 0x3c7f400000000000, // 5^35
+  0xc097ce7bc90715b3, 0x4b9f100000000000, // 5^36
+  0xf0bdc21abb48db20, 0x1e86d40000000000, // 5^37
+  0x96769950b50d88f4, 0x1314448000000000, // 5^38
+};
+static_assert( sizeof( kPow5Table ) / sizeof( *kPow5Table ) == ( kFloatMaxExp10 - kFloatMinExp10 + 1 ) * 2, "The must stay in sync" );
+
+//---------------------------------------------------------------------------------
+// powers of ten that are exact as floats
+static constexpr float kFloatPow10[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+
+//---------------------------------------------------------------------------------
+// true if all eight characters are ascii digits
+inline bool gj_isEightDigits( uint64_t chars )
+{
+  return ( ( ( chars + 0x4646464646464646 ) | ( chars - 0x3030303030303030 ) ) & 0x8080808080808080 ) == 0;
+}
+
+//---------------------------------------------------------------------------------
+// converts eight ascii digits, loaded little endian, to their value
+inline uint32_t gj_parseEightDigits( uint64_t chars )
+{
+  const uint64_t mask = 0x000000ff000000ff;
+  const uint64_t mul1 = 0x000f424000000064; // 100 + ( 1000000 << 32 )
+  const uint64_t mul2 = 0x0000271000000001; // 1   + ( 10000   << 32 )
+
+  chars -= 0x3030303030303030;
+  chars  = ( chars * 10 ) + ( chars >> 8 ); // pairs of digits
+  chars  = ( ( ( chars & mask ) * mul1 ) + ( ( ( chars >> 16 ) & mask ) * mul2 ) ) >> 32;
+  return (uint32_t)chars;
+}
+
+//---------------------------------------------------------------------------------
+// Accumulates a run of digits into *io_value, which wraps if the run is long enough.
+// returns the cursor after the run
+const char* gj_parseDigits( const char* cursor, const char* end, uint64_t* io_value )
+{
+  uint64_t value = *io_value;
+  while ( end - cursor >= 8 )
+  {
+    uint64_t chars;
+    memcpy( &chars, cursor, sizeof( chars ) );
+    if ( gj_isEightDigits( chars ) == false )
+    {
+      break;
+    }
+
+    value   = value * 100000000 + gj_parseEightDigits( chars );
+    cursor += 8;
+  }
+
+  while ( cursor < end && gj_isDigit( *cursor ) )
+  {
+    value = value * 10 + (uint64_t)( *cursor - '0' );
+    cursor++;
+  }
+
+  *io_value = value;
+  return cursor;
+}
+
+//---------------------------------------------------------------------------------
+// Eisel-Lemire. Finds the float nearest to w * 10^q.
+// returns the float's bits, without the sign
+uint32_t gj_decimalToFloatBits( uint64_t w, int64_t q )
+{
+  if ( w == 0 || q < kFloatMinExp10 )
+  {
+    return 0;
+  }
+
+  if ( q > kFloatMaxExp10 )
+  {
+    return (uint32_t)kFloatInfiniteExp2 << kFloatMantissaBits;
+  }
+
+  const uint32_t leading_zeros = 63 - gj_Bsr( w );
+  w <<= leading_zeros;
+
+  // the top 64 bits of w * 5^q, refined with the low half of 5^q only when the
+  // bits that decide the rounding could have been carried into
+  const uint64_t* pow5           = &kPow5Table[ ( q - kFloatMinExp10 ) * 2 ];
+  const uint64_t  precision_mask = 0xffffffffffffffff >> ( kFloatMantissaBits + 3 );
+  uint64_t        product_hi;
+  uint64_t        product_lo     = gj_Mul128( w, pow5[ 0 ], &product_hi );
+  if ( ( product_hi & precision_mask ) == precision_mask )
+  {
+    uint64_t       second_hi;
+    gj_Mul128( w, pow5[ 1 ], &second_hi );
+    product_lo += second_hi;
+    product_hi += second_hi > product_lo;
+  }
+
+  const uint32_t upper_bit = (uint32_t)( product_hi >> 63 );
+  const uint32_t shift     = upper_bit + 64 - kFloatMantissaBits - 3;
+  uint64_t       mantissa  = product_hi >> shift;
+  int32_t        exp2      = (int32_t)( ( ( ( 152170 + 65536 ) * q ) >> 16 ) + 63 ) + (int32_t)upper_bit - (int32_t)leading_zeros - kFloatMinExp2;
+
+  if ( exp2 <= 0 )
+  {
+    // subnormal
+    if ( -exp2 + 1 >= 64 )
+    {
+      return 0;
+    }
+
+    mantissa >>= -exp2 + 1;
+    mantissa  += mantissa & 1;
+    mantissa >>= 1;
+    exp2       = mantissa < ( 1ull << kFloatMantissaBits ) ? 0 : 1;
+    return ( (uint32_t)exp2 << kFloatMantissaBits ) | (uint32_t)( mantissa & ( ( 1ull << kFloatMantissaBits ) - 1 ) );
+  }
+
+  // exactly halfway between two floats, so round to even rather than up
+  if ( product_lo <= 1 && q >= -17 && q <= 10 && ( mantissa & 3 ) == 1 && ( mantissa << shift ) == product_hi )
+  {
+    mantissa &= ~1ull;
+  }
+
+  mantissa  += mantissa & 1;
+  mantissa >>= 1;
+  if ( mantissa >= ( 2ull << kFloatMantissaBits ) )
+  {
+    mantissa = 1ull << kFloatMantissaBits;
+    exp2++;
+  }
+
+  if ( exp2 >= kFloatInfiniteExp2 )
+  {
+    return (uint32_t)kFloatInfiniteExp2 << kFloatMantissaBits;
+  }
+
+  return ( (uint32_t)exp2 << kFloatMantissaBits ) | (uint32_t)( mantissa & ( ( 1ull << kFloatMantissaBits ) - 1 ) );
+}
+
+//---------------------------------------------------------------------------------
+// Just enough of a big unsigned integer to compare a long decimal against a float
+// halfway point exactly. 2048 bits covers every float exponent at kMaxExactDigitCount.
+static constexpr uint32_t kBigIntLimbCount = 64;
+struct _gjBigInt
+{
+  uint32_t m_Limbs[ kBigIntLimbCount ]; // least significant first
+  uint32_t m_LimbCount;
+};
+
+//---------------------------------------------------------------------------------
+void gj_bigIntMulAdd( _gjBigInt* big, uint32_t mul, uint32_t add )
+{
+  uint64_t carry = add;
+  for ( uint32_t i_limb = 0; i_limb < big->m_LimbCount; ++i_limb )
+  {
+    const uint64_t limb = (uint64_t)big->m_Limbs[ i_limb ] * mul + carry;
+    big->m_Limbs[ i_limb ] = (uint32_t)limb;
+    carry = limb >> 32;
+  }
+
+  if ( carry != 0 && big->m_LimbCount < kBigIntLimbCount )
+  {
+    big->m_Limbs[ big->m_LimbCount++ ] = (uint32_t)carry;
+  }
+}
+
+//---------------------------------------------------------------------------------
+void gj_bigIntMulPow5( _gjBigInt* big, uint32_t exp5 )
+{
+  static constexpr uint32_t kPow5Limb    = 1220703125; // 5^13, the largest that fits a limb
+  static constexpr uint32_t kPow5LimbExp = 13;
+
+  for ( ; exp5 >= kPow5LimbExp; exp5 -= kPow5LimbExp )
+  {
+    gj_bigIntMulAdd( big, kPow5Limb, 0 );
+  }
+
+  uint32_t remainder = 1;
+  for ( ; exp5 > 0; --exp5 )
+  {
+    remainder *= 5;
+  }
+  gj_bigIntMulAdd( big, remainder, 0 );
+}
+
+//---------------------------------------------------------------------------------
+void gj_bigIntShiftLeft( _gjBigInt* big, uint32_t bits )
+{
+  const uint32_t limb_shift = bits / 32;
+  const uint32_t bit_shift  = bits % 32;
+
+  if ( big->m_LimbCount == 0 || big->m_LimbCount + limb_shift + 1 > kBigIntLimbCount )
+  {
+    return;
+  }
+
+  big->m_Limbs[ big->m_LimbCount ] = 0;
+  for ( uint32_t i_limb = big->m_LimbCount + 1; i_limb-- > 0; )
+  {
+    uint32_t limb = big->m_Limbs[ i_limb ] << bit_shift;
+    if ( bit_shift != 0 && i_limb > 0 )
+    {
+      limb |= big->m_Limbs[ i_limb - 1 ] >> ( 32 - bit_shift );
+    }
+    big->m_Limbs[ i_limb + limb_shift ] = limb;
+  }
+
+  for ( uint32_t i_limb = 0; i_limb < limb_shift; ++i_limb )
+  {
+    big->m_Limbs[ i_limb ] = 0;
+  }
+
+  big->m_LimbCount += limb_shift + 1;
+  while ( big->m_LimbCount > 0 && big->m_Limbs[ big->m_LimbCount - 1 ] == 0 )
+  {
+    big->m_LimbCount--;
+  }
+}
+
+//---------------------------------------------------------------------------------
+int gj_bigIntCompare( const _gjBigInt* a, const _gjBigInt* b )
+{
+  if ( a->m_LimbCount != b->m_LimbCount )
+  {
+    return a->m_LimbCount < b->m_LimbCount ? -1 : 1;
+  }
+
+  for ( uint32_t i_limb = a->m_LimbCount; i_limb-- > 0; )
+  {
+    if ( a->m_Limbs[ i_limb ] != b->m_Limbs[ i_limb ] )
+    {
+      return a->m_Limbs[ i_limb ] < b->m_Limbs[ i_limb ] ? -1 : 1;
+    }
+  }
+
+  return 0;
+}
+
+//---------------------------------------------------------------------------------
+// Decides between the float with bits lower_bits and the next float up, given every
+// digit of the number. The digits are int_digits followed by frac_digits, scaled by
+// 10^exp10.
+// returns true if the number rounds to the upper float
+bool gj_isAboveFloatHalfway( const char* int_digits, size_t int_len, const char* frac_digits, size_t frac_len, int64_t exp10, uint32_t lower_bits )
+{
+  _gjBigInt digits;
+  digits.m_LimbCount = 0;
+
+  // past kMaxExactDigitCount, any non zero digit only matters when the rest tie
+  size_t kept_count = 0;
+  size_t drop_count = 0;
+  bool   sticky     = false;
+  for ( size_t i_digit = 0; i_digit < int_len + frac_len; ++i_digit )
+  {
+    const char digit = i_digit < int_len ? int_digits[ i_digit ] : frac_digits[ i_digit - int_len ];
+    if ( kept_count < kMaxExactDigitCount )
+    {
+      kept_count += ( kept_count != 0 || digit != '0' );
+      gj_bigIntMulAdd( &digits, 10, (uint32_t)( digit - '0' ) );
+    }
+    else
+    {
+      sticky |= digit != '0';
+      drop_count++;
+    }
+  }
+
+  const int64_t digits_exp10 = exp10 - (int64_t)frac_len + (int64_t)drop_count;
+
+  // the halfway point is ( 2 * mantissa + 1 ) * 2^( exp2 - 1 )
+  const uint32_t lower_exp  = lower_bits >> kFloatMantissaBits;
+  const uint32_t lower_mant = lower_bits & ( ( 1u << kFloatMantissaBits ) - 1 );
+  const uint64_t mantissa   = lower_exp == 0 ? lower_mant : ( lower_mant | ( 1u << kFloatMantissaBits ) );
+  const int64_t  exp2       = lower_exp == 0 ? -149 : (int64_t)lower_exp - 150;
+
+  _gjBigInt halfway;
+  halfway.m_Limbs[ 0 ] = (uint32_t)( mantissa * 2 + 1 );
+  halfway.m_LimbCount  = 1;
+
+  // compare digits * 5^e * 2^e against halfway, keeping both sides integers
+  if ( digits_exp10 >= 0 )
+  {
+    gj_bigIntMulPow5( &digits, (uint32_t)digits_exp10 );
+  }
+  else
+  {
+    gj_bigIntMulPow5( &halfway, (uint32_t)-digits_exp10 );
+  }
+
+  const int64_t exp2_diff = digits_exp10 - ( exp2 - 1 );
+  if ( exp2_diff >= 0 )
+  {
+    gj_bigIntShiftLeft( &digits, (uint32_t)exp2_diff );
+  }
+  else
+  {
+    gj_bigIntShiftLeft( &halfway, (uint32_t)-exp2_diff );
+  }
+
+  const int comparison = gj_bigIntCompare( &digits, &halfway );
+  if ( comparison == 0 )
+  {
+    return sticky || ( mantissa & 1 ) != 0;
+  }
+
+  return comparison > 0;
+}
+
+//---------------------------------------------------------------------------------
+struct _gjNumber
+{
+  union
+  {
+    int      m_Int;
+    uint64_t m_U64;
+    float    m_Float;
+  };
+  gjSubValueType m_SubType;
+};
+
+//---------------------------------------------------------------------------------
+// Numbers with a fraction or exponent become floats. Integers become ints when they
+// fit, then u64s, and floats past that.
+bool gj_readNumber( _gjParseContext* ctx, _gjNumber* out_number )
+{
+  const char* cursor   = ctx->m_Cursor;
+  const char* end      = ctx->m_End;
+  const bool  negative = cursor < end && *cursor == '-';
+  cursor += negative;
+
+  uint64_t    w          = 0;
+  const char* int_digits = cursor;
+  cursor = gj_parseDigits( cursor, end, &w );
+
+  const size_t int_len = (size_t)( cursor - int_digits );
+  if ( int_len == 0 )
+  {
+    gj_assert( "unrecognized format!" );
+    return false;
+  }
+
+  if ( int_len > 1 && *int_digits == '0' )
+  {
+    gj_assert( "error parsing number: leading zeros aren't allowed" );
+    return false;
+  }
+
+  bool        is_float    = false;
+  const char* frac_digits = cursor;
+  size_t      frac_len    = 0;
+  if ( cursor < end && *cursor == '.' )
+  {
+    is_float    = true;
+    frac_digits = ++cursor;
+    cursor      = gj_parseDigits( cursor, end, &w );
+    frac_len    = (size_t)( cursor - frac_digits );
+    if ( frac_len == 0 )
+    {
+      gj_assert( "error parsing number: expected digits after the decimal point" );
+      return false;
+    }
+  }
+
+  int64_t exp10 = 0;
+  if ( cursor < end && ( *cursor == 'e' || *cursor == 'E' ) )
+  {
+    is_float = true;
+    cursor++;
+
+    const bool exp_negative = cursor < end && *cursor == '-';
+    cursor += ( cursor < end && ( *cursor == '-' || *cursor == '+' ) );
+    if ( cursor == end || gj_isDigit( *cursor ) == false )
+    {
+      gj_assert( "error parsing number: expected digits in the exponent" );
+      return false;
+    }
+
+    // far past where every float is zero or infinity, so stop counting
+    while ( cursor < end && gj_isDigit( *cursor ) )
+    {
+      if ( exp10 < 0x10000000 )
+      {
+        exp10 = exp10 * 10 + ( *cursor - '0' );
+      }
+      cursor++;
+    }
+    exp10 = exp_negative ? -exp10 : exp10;
+  }
+
+  ctx->m_Cursor = cursor;
+
+  // More than 19 significant digits may have wrapped w. Start over and keep only
+  // the first 19, remembering that the number was cut short.
+  size_t digit_count = int_len + frac_len;
+  for ( const char* digit = int_digits; digit_count > 19 && digit < int_digits + int_len + 1 + frac_len && ( *digit == '0' || *digit == '.' ); ++digit )
+  {
+    digit_count -= *digit == '0';
+  }
+
+  const bool truncated = digit_count > 19;
+  int64_t    q         = exp10 - (int64_t)frac_len;
+  if ( truncated )
+  {
+    w = 0;
+    const char* digit = int_digits;
+    while ( w < kMinNineteenDigits && digit < int_digits + int_len )
+    {
+      w = w * 10 + (uint64_t)( *digit++ - '0' );
+    }
+
+    if ( w >= kMinNineteenDigits )
+    {
+      q = exp10 + ( int_digits + int_len - digit );
+    }
+    else
+    {
+      digit = frac_digits;
+      while ( w < kMinNineteenDigits && digit < frac_digits + frac_len )
+      {
+        w = w * 10 + (uint64_t)( *digit++ - '0' );
+      }
+      q = exp10 - ( digit - frac_digits );
+    }
+  }
+
+  if ( is_float == false )
+  {
+    if ( truncated == false )
+    {
+      if ( negative && w <= (uint64_t)INT32_MAX + 1 )
+      {
+        out_number->m_Int     = (int)( 0 - (int64_t)w );
+        out_number->m_SubType = kGjSubValueTypeInt;
+        return true;
+      }
+
+      if ( negative == false && w <= (uint64_t)INT32_MAX )
+      {
+        out_number->m_Int     = (int)w;
+        out_number->m_SubType = kGjSubValueTypeInt;
+        return true;
+      }
+
+      if ( negative == false )
+      {
+        out_number->m_U64     = w;
+        out_number->m_SubType = kGjSubValueTypeU64;
+        return true;
+      }
+    }
+    else if ( negative == false && int_len == 20 )
+    {
+      // w holds the first 19 digits, see if the 20th still fits
+      const uint64_t last_digit = (uint64_t)( int_digits[ 19 ] - '0' );
+      if ( w < UINT64_MAX / 10 || ( w == UINT64_MAX / 10 && last_digit <= UINT64_MAX % 10 ) )
+      {
+        out_number->m_U64     = w * 10 + last_digit;
+        out_number->m_SubType = kGjSubValueTypeU64;
+        return true;
+      }
+    }
+  }
+
+  uint32_t float_bits;
+  if ( truncated == false && w <= kFloatMaxExactInt && q >= -10 && q <= 10 )
+  {
+    // both w and 10^q are exact, so one multiply or divide rounds correctly
+    const float float_w = (float)w;
+    const float value   = q < 0 ? float_w / kFloatPow10[ -q ] : float_w * kFloatPow10[ q ];
+    memcpy( &float_bits, &value, sizeof( float_bits ) );
+  }
+  else
+  {
+    float_bits = gj_decimalToFloatBits( w, q );
+
+    // the number lies between w and w + 1, so if they round differently every
+    // digit is needed to decide
+    if ( truncated && gj_decimalToFloatBits( w + 1, q ) != float_bits )
+    {
+      float_bits += gj_isAboveFloatHalfway( int_digits, int_len, frac_digits, frac_len, exp10, float_bits );
+    }
+  }
+
+  float_bits |= (uint32_t)negative << 31;
+
+  memcpy( &out_number->m_Float, &float_bits, sizeof( out_number->m_Float ) );
+  out_number->m_SubType = kGjSubValueTypeFloat;
+  return true;
+}
+
+//---------------------------------------------------------------------------------
+bool gj_parseNumber( _gjParseContext* ctx, gjValue* out_value )
+{
+  _gjNumber number;
+  if ( gj_readNumber( ctx, &number ) == false )
+  {
+    return false;
+  }
+
+  switch ( number.m_SubType )
+  {
+    case kGjSubValueTypeInt:
+    {
+      *out_value = gjValue( number.m_Int );
+    }
+    break;
+    case kGjSubValueTypeU64:
+    {
+      *out_value = gjValue( number.m_U64 );
+    }
+    break;
+    default:
+    {
+      *out_value = gjValue( number.m_Float );
+    }
+  }
+
+  return true;
+}
+
+//---------------------------------------------------------------------------------
+// makes a string value that takes ownership of str, or borrows it when parsing in place
+gjValue gj_makeParsedString( const _gjParseContext* ctx, char* str )
+{
+  gjValue handle_val{};
+  if ( _gjValue* val = gj_allocValue( &handle_val.idx ) )
+  {
+    handle_val.gen = val->m_Gen;
+    ASSIGN_VAL_TYPE( val, gjValueType::kString );
+    ASSIGN_VAL_SUBTYPE( val, kGjSubValueTypeInvalid );
+    val->m_Str   = str;
+    val->m_Flags = ctx->m_Insitu ? kValueFlagBorrowedStr : 0;
+  }
+  else
+  {
+    gj_freeParsedString( ctx, str );
+  }
+  return handle_val;
+}
+
+//---------------------------------------------------------------------------------
+gjValue gj_makeParsedNull()
+{
+  gjValue handle_val{};
+  if ( _gjValue* val = gj_allocValue( &handle_val.idx ) )
+  {
+    handle_val.gen = val->m_Gen;
+    ASSIGN_VAL_TYPE( val, gjValueType::kNull );
+    ASSIGN_VAL_SUBTYPE( val, kGjSubValueTypeInvalid );
+  }
+  return handle_val;
+}
+
+//---------------------------------------------------------------------------------
+// Checked before a container is made, so a document that's too deep stops before
+// anything more is allocated for it
+bool gj_checkParseDepth( const _gjParseContext* ctx )
+{
+  if ( s_Config.max_depth != 0 && ctx->m_BaseDepth + ctx->m_Depth >= s_Config.max_depth )
+  {
+    gj_assert( "json data is nested deeper than the max_depth it was configured with" );
+    return false;
+  }
+  return true;
+}
+
+//---------------------------------------------------------------------------------
+// Parses the value at the cursor. Objects and arrays come back empty, with the
+// cursor just inside them
+bool gj_parseValue( _gjParseContext* ctx, gjValue* out_value )
+{
+  switch ( gj_peekChar( ctx ) )
+  {
+    case '{':
+    {
+      if ( gj_checkParseDepth( ctx ) == false )
+      {
+        return false;
+      }
+      ctx->m_Cursor++;
+      *out_value = gj_makeObject();
+      if ( ctx->m_Insitu && gj_isValueAlloced( out_value->idx, out_value->gen ) )
+      {
+        gj_getValueSlot( out_value->idx )->m_Flags = kValueFlagBorrowedKeys;
+      }
+    }
+    break;
+    case '[':
+    {
+      if ( gj_checkParseDepth( ctx ) == false )
+      {
+        return false;
+      }
+      ctx->m_Cursor++;
+      *out_value = gj_makeArray();
+    }
+    break;
+    case '"':
+    {
+      uint32_t str_len;
+      char*    str = gj_parseString( ctx, &str_len );
+      if ( str == nullptr )
+      {
+        return false;
+      }
+      *out_value = gj_makeParsedString( ctx, str );
+    }
+    break;
+    case 't':
+    {
+      if ( gj_parseLiteral( ctx, "true", 4 ) == false )
+      {
+        return false;
+      }
+      *out_value = gjValue( true );
+    }
+    break;
+    case 'f':
+    {
+      if ( gj_parseLiteral( ctx, "false", 5 ) == false )
+      {
+        return false;
+      }
+      *out_value = gjValue( false );
+    }
+    break;
+    case 'n':
+    {
+      if ( gj_parseLiteral( ctx, "null", 4 ) == false )
+      {
+        return false;
+      }
+      *out_value = gj_makeParsedNull();
+    }
+    break;
+    default:
+    {
+      if ( gj_parseNumber( ctx, out_value ) == false )
+      {
+        return false;
+      }
+    }
+  }
+
+  // the pools have already asserted if they ran out
+  return gj_isValueAlloced( out_value->idx, out_value->gen );
+}
+
+//---------------------------------------------------------------------------------
+// Adds a newly parsed value to a container. An object member takes ownership of
+// key_str, or borrows it when parsing in place, but only when this succeeds.
+// returns false if the array or member pool is full
+bool gj_attachParsedValue( uint32_t container_idx, char* key_str, uint32_t key_hash, gjValue value )
+{
+  _gjValue* container = gj_getValueSlot( container_idx );
+  if ( VAL_TYPE( container ) == gjValueType::kObject )
+  {
+    _gjMember* member = gj_allocMember( container, key_hash );
+    if ( member == nullptr )
+    {
+      gj_assertPoolFull( "Attempting to create object member, but the  member pool is full. You may be out of memory" );
+      return false;
+    }
+
+    member->m_KeyStr = key_str;
+    member->m_Value  = value;
+    return true;
+  }
+
+  _gjArrayElem* elems = gj_reserveArrayElem( container );
+  if ( elems == nullptr )
+  {
+    gj_assertPoolFull( "Attempting to create array element, but the array pool is full. You may be out of memory" );
+    return false;
+  }
+
+  elems[ container->m_Array.m_Count++ ].m_Value = value;
+  return true;
+}
+
+//---------------------------------------------------------------------------------
+// Parses one document into *out_root. Each container is attached to its parent as
+// soon as it's opened, so on failure deleting *out_root frees everything parsed so far.
+bool gj_parseDocument( _gjParseContext* ctx, gjValue* out_root )
+{
+  char*    key_str  = nullptr;
+  uint32_t key_hash = 0;
+
+  while ( true )
+  {
+    gj_skipWhitespace( ctx );
+    const char open_char = gj_peekChar( ctx );
+
+    gjValue value{};
+    if ( gj_parseValue( ctx, &value ) == false )
+    {
+      gj_freeParsedString( ctx, key_str );
+      return false;
+    }
+
+    if ( ctx->m_Depth == 0 )
+    {
+      *out_root = value;
+    }
+    else if ( gj_attachParsedValue( ctx->m_Stack[ ctx->m_Depth - 1 ], key_str, key_hash, value ) == false )
+    {
+      gj_freeParsedString( ctx, key_str );
+      gj_deleteValue( value );
+      return false;
+    }
+    key_str = nullptr;
+
+    if ( open_char == '{' || open_char == '[' )
+    {
+      if ( gj_pushParseContainer( ctx, value.idx ) == false )
+      {
+        return false;
+      }
+
+      gj_skipWhitespace( ctx );
+      if ( gj_peekChar( ctx ) == ( open_char == '{' ? '}' : ']' ) )
+      {
+        ctx->m_Cursor++;
+        ctx->m_Depth--;
+      }
+      else if ( open_char == '{' )
+      {
+        if ( gj_parseKey( ctx, &key_str, &key_hash ) == false )
+        {
+          return false;
+        }
+        continue;
+      }
+      else
+      {
+        continue;
+      }
+    }
+
+    // the value is complete, so close containers until one has another value to come
+    bool has_next_value = false;
+    while ( ctx->m_Depth > 0 && has_next_value == false )
+    {
+      gj_skipWhitespace( ctx );
+
+      const bool in_object = VAL_TYPE( gj_getValueSlot( ctx->m_Stack[ ctx->m_Depth - 1 ] ) ) == gjValueType::kObject;
+      const char next_char = gj_peekChar( ctx );
+      if ( next_char == ',' )
+      {
+        ctx->m_Cursor++;
+        if ( in_object && gj_parseKey( ctx, &key_str, &key_hash ) == false )
+        {
+          return false;
+        }
+        has_next_value = true;
+      }
+      else if ( next_char == ( in_object ? '}' : ']' ) )
+      {
+        ctx->m_Cursor++;
+        ctx->m_Depth--;
+      }
+      else
+      {
+        gj_assert( "Unexpected token!" );
+        return false;
+      }
+    }
+
+    if ( has_next_value == false )
+    {
+      break;
+    }
+  }
+
+  gj_skipWhitespace( ctx );
+  if ( gj_peekChar( ctx ) != '\0' )
+  {
+    gj_assert( "Unexpected token after the end of the json data!" );
+    return false;
+  }
+
+  return true;
+}
+
+//---------------------------------------------------------------------------------
+// Parsing stops at string_len or at a null terminator, whichever comes first.
+// base_depth is how many containers the text sits inside of, counted against max_depth
+gjValue gj_parseBuffer( const char* json_string, size_t string_len, bool insitu, uint32_t base_depth )
+{
+  _gjParseContext ctx;
+  ctx.m_Cursor        = json_string;
+  ctx.m_End           = json_string + string_len;
+  ctx.m_Stack         = ctx.m_InlineStack;
+  ctx.m_Depth         = 0;
+  ctx.m_BaseDepth     = base_depth;
+  ctx.m_StackCapacity = kParseInlineStackDepth;
+  ctx.m_Insitu        = insitu;
+
+  gjValue value{};
+  if ( gj_parseDocument( &ctx, &value ) == false )
+  {
+    gj_deleteValue( value );
+    value = gjValue{};
+  }
+
+  if ( ctx.m_Stack != ctx.m_InlineStack )
+  {
+    gj_free( ctx.m_Stack );
+  }
+
+  return value;
+}
+
+//---------------------------------------------------------------------------------
+gjValue gj_parse( const char* json_string, size_t string_len )
+{
+  return gj_parseBuffer( json_string, string_len, false, 0 );
+}
+
+//---------------------------------------------------------------------------------
+gjValue gj_parseInsitu( char* json_buffer, size_t buffer_len )
+{
+  return gj_parseBuffer( json_buffer, buffer_len, true, 0 );
+}
+
+//---------------------------------------------------------------------------------
+// Parsing is bounded by the file's size, so the mapping doesn't need a null terminator.
+// Strings are copied out of it, so it can go as soon as parsing is done
+gjValue gj_parseFile( const char* path )
+{
+  size_t      file_size;
+  const char* file_data = gj_mapFile( path, &file_size );
+  if ( file_data == nullptr )
+  {
+    gj_assert( "Failed to open the json file" );
+    return gjValue();
+  }
+
+  const gjValue value = gj_parseBuffer( file_data, file_size, false, 0 );
+  gj_unmapFile( file_data, file_size );
+  return value;
+}
+
+//---------------------------------------------------------------------------------
+// The stream parser runs the same steps as gj_parseDocument, but as a state machine
+// it can leave at the end of each chunk. Punctuation is handled as it arrives. A token
+// that runs off the end of a chunk is copied into the carry buffer and parsed from
+// there once the rest of it arrives, so the only memory that grows is the carry, and
+// that's bounded by the longest string or number rather than by the document.
+static constexpr uint32_t kStreamInlineCarrySize = 64;
+
+//---------------------------------------------------------------------------------
+enum _gjStreamPhase : uint8_t
+{
+  kStreamPhaseValue,      // expecting a value
+  kStreamPhaseFirstElem,  // just inside a '[', expecting a value or ']'
+  kStreamPhaseFirstKey,   // just inside a '{', expecting a key or '}'
+  kStreamPhaseKey,        // after a ',' in an object, expecting a key
+  kStreamPhaseColon,      // after a key, expecting ':'
+  kStreamPhaseNext,       // after a value in a container, expecting ',' or its closing bracket
+  kStreamPhaseDone,       // the root value is complete
+  kStreamPhaseTerminated, // a null terminator followed the root value, so the rest is ignored
+  kStreamPhaseFailed,
+};
+
+//---------------------------------------------------------------------------------
+struct _gjStreamParser
+{
+  _gjParseContext m_Ctx;
+  gjValue         m_Root;
+  char*           m_KeyStr; // key of the member whose value comes next
+  uint32_t        m_KeyHash;
+  _gjStreamPhase  m_Phase;
+  bool            m_CarryInEscape; // the carried string stops between a backslash and what it escapes
+  char*           m_Carry;         // the start of a token that ran off the end of a chunk
+  uint32_t        m_CarryLen;
+  uint32_t        m_CarryCapacity;
+  char            m_InlineCarry[ kStreamInlineCarrySize ];
+};
+
+//---------------------------------------------------------------------------------
+// Frees everything the parser holds except the root, and readies it for a new document
+void gj_resetStreamParser( _gjStreamParser* parser )
+{
+  _gjParseContext* ctx = &parser->m_Ctx;
+  if ( ctx->m_Stack != ctx->m_InlineStack )
+  {
+    gj_free( ctx->m_Stack );
+  }
+
+  if ( parser->m_Carry != parser->m_InlineCarry )
+  {
+    gj_free( parser->m_Carry );
+  }
+
+  gj_freeParsedString( ctx, parser->m_KeyStr );
+
+  ctx->m_Cursor        = nullptr;
+  ctx->m_End           = nullptr;
+  ctx->m_Stack         = ctx->m_InlineStack;
+  ctx->m_Depth         = 0;
+  ctx->m_BaseDepth     = 0;
+  ctx->m_StackCapacity = kParseInlineStackDepth;
+  ctx->m_Insitu        = false;
+
+  parser->m_Root          = gjValue();
+  parser->m_KeyStr        = nullptr;
+  parser->m_KeyHash       = 0;
+  parser->m_Phase         = kStreamPhaseValue;
+  parser->m_CarryInEscape = false;
+  parser->m_Carry         = parser->m_InlineCarry;
+  parser->m_CarryLen      = 0;
+  parser->m_CarryCapacity = kStreamInlineCarrySize;
+}
+
+//---------------------------------------------------------------------------------
+// Throws away the partly parsed document. returns false, for convenience
+bool gj_failStreamParser( _gjStreamParser* parser )
+{
+  gj_deleteValue( parser->m_Root );
+  parser->m_Root = gjValue();
+
+  gj_freeParsedString( &parser->m_Ctx, parser->m_KeyStr );
+  parser->m_KeyStr = nullptr;
+
+  parser->m_Phase = kStreamPhaseFailed;
+  return false;
+}
+
+//---------------------------------------------------------------------------------
+bool gj_appendStreamCarry( _gjStreamParser* parser, const char* data, size_t data_len )
+{
+  if ( parser->m_CarryLen + data_len >= kUnreasonablyLargeStringSize )
+  {
+    gj_assert( "error parsing string literal: string is unreasonably large" );
+    return false;
+  }
+
+  const uint32_t needed_len = parser->m_CarryLen + (uint32_t)data_len;
+  if ( needed_len > parser->m_CarryCapacity )
+  {
+    uint32_t new_capacity = parser->m_CarryCapacity * 2;
+    while ( new_capacity < needed_len )
+    {
+      new_capacity *= 2;
+    }
+
+    char* new_carry = (char*)gj_malloc( new_capacity, "Stream parser carry" );
+    if ( new_carry == nullptr )
+    {
+      gj_assert( "Ran out of memory for the stream parser. You may be out of memory" );
+      return false;
+    }
+
+    memcpy( new_carry, parser->m_Carry, parser->m_CarryLen );
+    if ( parser->m_Carry != parser->m_InlineCarry )
+    {
+      gj_free( parser->m_Carry );
+    }
+
+    parser->m_Carry         = new_carry;
+    parser->m_CarryCapacity = new_capacity;
+  }
+
+  memcpy( parser->m_Carry + parser->m_CarryLen, data, data_len );
+  parser->m_CarryLen = needed_len;
+  return true;
+}
+
+//---------------------------------------------------------------------------------
+// Finds where a string or scalar token ends. For a string, cursor is inside the quotes.
+// returns nullptr if the token runs past end
+const char* gj_findStreamTokenEnd( const char* cursor, const char* end, bool is_string, bool* io_in_escape )
+{
+  if ( is_string == false )
+  {
+    while ( cursor < end && gj_isWhitespace( *cursor ) == false && *cursor != ',' && *cursor != ']' && *cursor != '}' && *cursor != '\0' )
+    {
+      cursor++;
+    }
+    return cursor < end ? cursor : nullptr;
+  }
+
+  if ( *io_in_escape )
+  {
+    if ( cursor == end )
+    {
+      return nullptr;
+    }
+    cursor++;
+    *io_in_escape = false;
+  }
+
+  while ( true )
+  {
+    cursor = s_FindStringStopFn( cursor, end );
+    if ( cursor == end )
+    {
+      return nullptr;
+    }
+
+    // a null terminator ends the token too, and gj_parseString reports it
+    if ( *cursor != '\\' )
+    {
+      return *cursor == '"' ? cursor + 1 : cursor;
+    }
+
+    if ( end - cursor < 2 )
+    {
+      *io_in_escape = true;
+      return nullptr;
+    }
+    cursor += 2;
+  }
+}
+
+//---------------------------------------------------------------------------------
+void gj_closeStreamContainer( _gjStreamParser* parser )
+{
+  parser->m_Ctx.m_Cursor++;
+  parser->m_Ctx.m_Depth--;
+  parser->m_Phase = parser->m_Ctx.m_Depth == 0 ? kStreamPhaseDone : kStreamPhaseNext;
+}
+
+//---------------------------------------------------------------------------------
+// Parses the single whole token between the context's cursor and end, which is a key
+// or a value depending on the phase
+bool gj_parseStreamToken( _gjStreamParser* parser )
+{
+  _gjParseContext* ctx = &parser->m_Ctx;
+  if ( parser->m_Phase == kStreamPhaseFirstKey || parser->m_Phase == kStreamPhaseKey )
+  {
+    if ( gj_peekChar( ctx ) != '"' )
+    {
+      gj_assert( "Unexpected token! Expected a member key" );
+      return gj_failStreamParser( parser );
+    }
+
+    uint32_t key_len;
+    parser->m_KeyStr = gj_parseString( ctx, &key_len );
+    if ( parser->m_KeyStr == nullptr )
+    {
+      return gj_failStreamParser( parser );
+    }
+
+    parser->m_KeyHash = gj_crc32( parser->m_KeyStr, key_len );
+    parser->m_Phase   = kStreamPhaseColon;
+  }
+  else
+  {
+    const char open_char = gj_peekChar( ctx );
+
+    gjValue value{};
+    if ( gj_parseValue( ctx, &value ) == false )
+    {
+      return gj_failStreamParser( parser );
+    }
+
+    if ( ctx->m_Depth == 0 )
+    {
+      parser->m_Root = value;
+    }
+    else if ( gj_attachParsedValue( ctx->m_Stack[ ctx->m_Depth - 1 ], parser->m_KeyStr, parser->m_KeyHash, value ) == false )
+    {
+      gj_deleteValue( value );
+      return gj_failStreamParser( parser );
+    }
+    parser->m_KeyStr = nullptr;
+
+    if ( open_char == '{' || open_char == '[' )
+    {
+      if ( gj_pushParseContainer( ctx, value.idx ) == false )
+      {
+        return gj_failStreamParser( parser );
+      }
+      parser->m_Phase = open_char == '{' ? kStreamPhaseFirstKey : kStreamPhaseFirstElem;
+    }
+    else
+    {
+      parser->m_Phase = ctx->m_Depth == 0 ? kStreamPhaseDone : kStreamPhaseNext;
+    }
+  }
+
+  if ( ctx->m_Cursor != ctx->m_End )
+  {
+    gj_assert( "Unexpected token!" );
+    return gj_failStreamParser( parser );
+  }
+
+  return true;
+}
+
+//---------------------------------------------------------------------------------
+bool gj_parseStreamCarry( _gjStreamParser* parser )
+{
+  parser->m_Ctx.m_Cursor = parser->m_Carry;
+  parser->m_Ctx.m_End    = parser->m_Carry + parser->m_CarryLen;
+  parser->m_CarryLen     = 0;
+  return gj_parseStreamToken( parser );
+}
+
+//---------------------------------------------------------------------------------
+bool gj_feedStreamParser( _gjStreamParser* parser, const char* chunk, size_t chunk_len )
+{
+  _gjParseContext* ctx = &parser->m_Ctx;
+  const char*      end = chunk + chunk_len;
+
+  // finish the token the last chunk stopped in the middle of
+  if ( parser->m_CarryLen > 0 )
+  {
+    const char* token_end = gj_findStreamTokenEnd( chunk, end, parser->m_Carry[ 0 ] == '"', &parser->m_CarryInEscape );
+    if ( gj_appendStreamCarry( parser, chunk, (size_t)( ( token_end != nullptr ? token_end : end ) - chunk ) ) == false )
+    {
+      return gj_failStreamParser( parser );
+    }
+
+    if ( token_end == nullptr )
+    {
+      return true;
+    }
+
+    if ( gj_parseStreamCarry( parser ) == false )
+    {
+      return false;
+    }
+    chunk = token_end;
+  }
+
+  ctx->m_Cursor = chunk;
+  ctx->m_End    = end;
+  while ( true )
+  {
+    gj_skipWhitespace( ctx );
+    if ( ctx->m_Cursor == end )
+    {
+      return true;
+    }
 
-      val_copy->m_TypeGroup = val->m_TypeGroup;
-      switch ( VAL_TYPE( val ) )
+    const char next_char = *ctx->m_Cursor;
+    if ( parser->m_Phase == kStreamPhaseDone )
+    {
+      if ( next_char != '\0' )
       {
-      case gjValueType::kBool:
+        gj_assert( "Unexpected token after the end of the json data!" );
+        return gj_failStreamParser( parser );
+      }
+
+      parser->m_Phase = kStreamPhaseTerminated;
+      return true;
+    }
+
+    if ( parser->m_Phase == kStreamPhaseColon )
+    {
+      if ( next_char != ':' )
       {
-        val_copy->m_Bool = val->m_Bool;
+        gj_assert( "Unexpected token! Expected a ':' after the member key" );
+        return gj_failStreamParser( parser );
       }
-      break;
-      case gjValueType::kString:
+
+      ctx->m_Cursor++;
+      parser->m_Phase = kStreamPhaseValue;
+      continue;
+    }
+
+    if ( parser->m_Phase == kStreamPhaseNext )
+    {
+      const bool in_object = VAL_TYPE( gj_getValueSlot( ctx->m_Stack[ ctx->m_Depth - 1 ] ) ) == gjValueType::kObject;
+      if ( next_char == ',' )
       {
-        size_t sz = gj_StrLen( val->m_Str ) + 1;
-        val_copy->m_Str = (char*)gj_malloc( sz, "string value" );
-        memcpy( val_copy->m_Str, val->m_Str, sz );
+        ctx->m_Cursor++;
+        parser->m_Phase = in_object ? kStreamPhaseKey : kStreamPhaseValue;
       }
-      break;
-      case gjValueType::kNumber:
+      else if ( next_char == ( in_object ? '}' : ']' ) )
       {
-        switch ( VAL_SUBTYPE( val ) )
-        {
-          case kGjSubValueTypeInt:
-          {
-            val_copy->m_Int = val->m_Int;
-          }
-          break;
-          case kGjSubValueTypeU64:
-          {
-            val_copy->m_U64 = val->m_U64;
-          }
-          break;
-          case kGjSubValueTypeFloat:
-          {
-            val_copy->m_Float = val->m_Float;
-          }
-          break;
-        }
+        gj_closeStreamContainer( parser );
       }
-      break;
-      case gjValueType::kArray:
+      else
       {
-        val_copy->m_ArrayStart.m_Idx = kArrayIdxTail;
-        const _gjArrayHandle arr_handle_start = val->m_ArrayStart;
-        
-        if ( arr_handle_start.m_Idx != kArrayIdxTail )
+        gj_assert( "Unexpected token!" );
+        return gj_failStreamParser( parser );
+      }
+      continue;
+    }
+
+    if ( ( parser->m_Phase == kStreamPhaseFirstElem && next_char == ']' ) ||
+         ( parser->m_Phase == kStreamPhaseFirstKey  && next_char == '}' ) )
+    {
+      gj_closeStreamContainer( parser );
+      continue;
+    }
+
+    // everything else starts a token, so find its end before parsing it
+    const char* token_start = ctx->m_Cursor;
+    const char* token_end   = token_start + 1;
+    if ( next_char != '{' && next_char != '[' )
+    {
+      const bool is_string = next_char == '"';
+      token_end = gj_findStreamTokenEnd( token_start + is_string, end, is_string, &parser->m_CarryInEscape );
+    }
+
+    if ( token_end == nullptr )
+    {
+      if ( gj_appendStreamCarry( parser, token_start, (size_t)( end - token_start ) ) == false )
+      {
+        return gj_failStreamParser( parser );
+      }
+      return true;
+    }
+
+    ctx->m_End = token_end;
+    if ( gj_parseStreamToken( parser ) == false )
+    {
+      return false;
+    }
+    ctx->m_End = end;
+  }
+}
+
+//---------------------------------------------------------------------------------
+gjStreamParser::gjStreamParser()
+{
+  m_Parser = (_gjStreamParser*)gj_malloc( sizeof( _gjStreamParser ), "Stream parser" );
+  if ( m_Parser == nullptr )
+  {
+    gj_assert( "Ran out of memory for the stream parser. You may be out of memory" );
+    return;
+  }
+
+  m_Parser->m_Ctx.m_Stack  = m_Parser->m_Ctx.m_InlineStack;
+  m_Parser->m_Ctx.m_Insitu = false;
+  m_Parser->m_Carry        = m_Parser->m_InlineCarry;
+  m_Parser->m_KeyStr       = nullptr;
+  gj_resetStreamParser( m_Parser );
+}
+
+//---------------------------------------------------------------------------------
+gjStreamParser::~gjStreamParser()
+{
+  if ( m_Parser != nullptr )
+  {
+    gj_deleteValue( m_Parser->m_Root );
+    gj_resetStreamParser( m_Parser );
+    gj_free( m_Parser );
+  }
+}
+
+//---------------------------------------------------------------------------------
+bool gjStreamParser::feed( const char* chunk, size_t chunk_len )
+{
+  if ( m_Parser == nullptr || m_Parser->m_Phase == kStreamPhaseFailed )
+  {
+    return false;
+  }
+
+  if ( m_Parser->m_Phase == kStreamPhaseTerminated )
+  {
+    return true;
+  }
+
+  return gj_feedStreamParser( m_Parser, chunk, chunk_len );
+}
+
+//---------------------------------------------------------------------------------
+gjValue gjStreamParser::finish()
+{
+  if ( m_Parser == nullptr )
+  {
+    return gjValue();
+  }
+
+  // a token still being carried ended with the input
+  if ( m_Parser->m_CarryLen > 0 && m_Parser->m_Phase != kStreamPhaseFailed )
+  {
+    gj_parseStreamCarry( m_Parser );
+  }
+
+  gjValue root = m_Parser->m_Root;
+  if ( m_Parser->m_Phase != kStreamPhaseDone && m_Parser->m_Phase != kStreamPhaseTerminated )
+  {
+    if ( m_Parser->m_Phase != kStreamPhaseFailed )
+    {
+      gj_assert( "Unexpected end of the json data!" );
+    }
+    gj_deleteValue( root );
+    root = gjValue();
+  }
+
+  gj_resetStreamParser( m_Parser );
+  return root;
+}
+
+//---------------------------------------------------------------------------------
+// Lazy documents read the text in place, only as far as is needed to answer each
+// call. Containers that are stepped over are skipped by matching brackets, so they're
+// never decoded or allocated, and only the values that are actually read are checked
+// against the full grammar.
+void gj_initLazyContext( _gjParseContext* ctx, const gjLazyValue* val )
+{
+  ctx->m_Cursor        = val->cursor;
+  ctx->m_End           = val->end;
+  ctx->m_Stack         = nullptr;
+  ctx->m_Depth         = 0;
+  ctx->m_BaseDepth     = 0;
+  ctx->m_StackCapacity = 0;
+  ctx->m_Insitu        = false;
+}
+
+//---------------------------------------------------------------------------------
+gjLazyValue gj_makeLazyValue( const _gjParseContext* ctx )
+{
+  gjLazyValue val;
+  val.cursor = ctx->m_Cursor;
+  val.end    = ctx->m_End;
+  return val;
+}
+
+//---------------------------------------------------------------------------------
+// Moves the cursor past the value at the cursor
+bool gj_skipLazyValue( _gjParseContext* ctx )
+{
+  switch ( gj_peekChar( ctx ) )
+  {
+    case '{':
+    case '[':
+    {
+      // strings are the only place a bracket doesn't count, so they're skipped whole
+      const char* cursor = ctx->m_Cursor;
+      uint32_t    depth  = 0;
+      while ( true )
+      {
+        cursor = s_FindStructuralFn( cursor, ctx->m_End );
+        if ( cursor == ctx->m_End || *cursor == '\0' )
         {
-          if ( arr_handle_start.m_Gen == s_ArrayPool[ arr_handle_start.m_Idx ].m_Gen )
-          {
-            if ( arr_handle_start.m_Idx != kArrayIdxTail )
-            {
-              const _gjArrayElem* elem = &s_ArrayPool[ arr_handle_start.m_Idx ];
-          
-              _gjArrayElem* new_elem = gj_allocArrayElem( &val_copy->m_ArrayStart.m_Idx );
-              val_copy->m_ArrayStart.m_Gen = new_elem->m_Gen;
-          
-              new_elem->m_Value = elem->m_Value.makeDeepCopy();
-          
-              while ( elem->m_Next != kArrayIdxTail )
-              {
-                elem = &s_ArrayPool[ elem->m_Next ];
-                new_elem = gj_allocArrayElem( &val_copy->m_ArrayStart.m_Idx );
-                new_elem->m_Value = elem->m_Value.makeDeepCopy();
-              }
-            }
-          }
+          gj_assert( "Unexpected end of the json data!" );
+          return false;
         }
-        break;
-        case gjValueType::kObject:
-        {
-          val_copy->m_ObjectStart.m_Idx = kMemberIdxTail;
-          val_copy->m_ObjectStart.m_Gen = (uint32_t)-1;
 
-          if ( val->m_ObjectStart.m_Idx != kMemberIdxTail )
+        if ( *cursor == '"' )
+        {
+          uint32_t escape_count;
+          cursor = gj_findClosingQuote( ctx, cursor + 1, &escape_count );
+          if ( cursor == nullptr )
           {
-            const _gjMemberHandle member_handle_start = val->m_ObjectStart;
-            if ( member_handle_start.m_Gen == s_MemberPool[ member_handle_start.m_Idx ].m_Gen )
-            {
-              if ( member_handle_start.m_Idx != kMemberIdxTail )
-              {
-                const _gjMember* member = &s_MemberPool[ member_handle_start.m_Idx ];
-
-                _gjMember* new_member   = gj_allocMember( &val_copy->m_ObjectStart.m_Idx );
-                val_copy->m_ObjectStart.m_Gen = new_member->m_Gen;
-
-                {
-                  new_member->m_KeyHash = member->m_KeyHash;
-                  new_member->m_Value   = member->m_Value.makeDeepCopy();
-                  const size_t str_len  = gj_StrLen( member->m_KeyStr ) + 1;
-                  new_member->m_KeyStr  = (char*)gj_malloc( str_len, "Object Member Key" );
-                  memcpy( new_member->m_KeyStr, member->m_KeyStr, str_len );
-                }
-
-                while ( member->m_Next != kMemberIdxTail )
-                {
-                  member = &s_MemberPool[ member->m_Next ];
-
-                  new_member            = gj_allocMember( &val_copy->m_ObjectStart.m_Idx );
-
-                  new_member->m_KeyHash = member->m_KeyHash;
-                  new_member->m_Value   = member->m_Value.makeDeepCopy();
-                  const size_t str_len  = gj_StrLen( member->m_KeyStr ) + 1;
-                  new_member->m_KeyStr  = (char*)gj_malloc( str_len, "Object Member Key" );
-                  memcpy( new_member->m_KeyStr, member->m_KeyStr, str_len );
-                }
-              }
-            }
+            return false;
           }
         }
-        break;
+        else if ( *cursor == '{' || *cursor == '[' )
+        {
+          depth++;
+        }
+        else if ( --depth == 0 )
+        {
+          ctx->m_Cursor = cursor + 1;
+          return true;
+        }
+        cursor++;
       }
-      break;
+    }
+    case '"':
+    {
+      uint32_t    escape_count;
+      const char* close_quote = gj_findClosingQuote( ctx, ctx->m_Cursor + 1, &escape_count );
+      if ( close_quote == nullptr )
+      {
+        return false;
       }
+      ctx->m_Cursor = close_quote + 1;
+      return true;
+    }
+    case 't':
+    {
+      return gj_parseLiteral( ctx, "true", 4 );
+    }
+    case 'f':
+    {
+      return gj_parseLiteral( ctx, "false", 5 );
+    }
+    case 'n':
+    {
+      return gj_parseLiteral( ctx, "null", 4 );
+    }
+  }
+
+  _gjNumber number;
+  return gj_readNumber( ctx, &number );
+}
+
+//---------------------------------------------------------------------------------
+// Moves the cursor from the opening bracket of a container to its first value, or
+// past the closing bracket if it's empty
+void gj_enterLazyContainer( _gjParseContext* ctx, char close_char, bool* out_has_value )
+{
+  ctx->m_Cursor++;
+  gj_skipWhitespace( ctx );
+  *out_has_value = gj_peekChar( ctx ) != close_char;
+  if ( *out_has_value == false )
+  {
+    ctx->m_Cursor++;
+  }
+}
+
+//---------------------------------------------------------------------------------
+// Moves the cursor from just past a container's value to the next one, or past the
+// closing bracket if that was the last
+bool gj_readLazySeparator( _gjParseContext* ctx, char close_char, bool* out_has_value )
+{
+  gj_skipWhitespace( ctx );
+  const char next_char = gj_peekChar( ctx );
+  if ( next_char != ',' && next_char != close_char )
+  {
+    gj_assert( "Unexpected token!" );
+    return false;
+  }
+
+  ctx->m_Cursor++;
+  *out_has_value = next_char == ',';
+  if ( *out_has_value )
+  {
+    gj_skipWhitespace( ctx );
+  }
+  return true;
+}
+
+//---------------------------------------------------------------------------------
+// Moves the cursor from a container's value to the next one, or past the closing
+// bracket if that was the last
+bool gj_nextLazyContainerValue( _gjParseContext* ctx, char close_char, bool* out_has_value )
+{
+  return gj_skipLazyValue( ctx ) && gj_readLazySeparator( ctx, close_char, out_has_value );
+}
+
+//---------------------------------------------------------------------------------
+// Reads `"key" :` at the cursor, leaving the cursor on the member's value.
+// The key is left escaped, between *out_key_str and *out_key_end
+bool gj_readLazyKey( _gjParseContext* ctx, const char** out_key_str, const char** out_key_end, uint32_t* out_escape_count )
+{
+  if ( gj_peekChar( ctx ) != '"' )
+  {
+    gj_assert( "Unexpected token! Expected a member key" );
+    return false;
+  }
+
+  const char* key_str = ctx->m_Cursor + 1;
+  const char* key_end = gj_findClosingQuote( ctx, key_str, out_escape_count );
+  if ( key_end == nullptr )
+  {
+    return false;
+  }
+
+  ctx->m_Cursor = key_end + 1;
+  gj_skipWhitespace( ctx );
+  if ( gj_peekChar( ctx ) != ':' )
+  {
+    gj_assert( "Unexpected token! Expected a ':' after the member key" );
+    return false;
+  }
+  ctx->m_Cursor++;
+  gj_skipWhitespace( ctx );
+
+  *out_key_str = key_str;
+  *out_key_end = key_end;
+  return true;
+}
+
+//---------------------------------------------------------------------------------
+// compares an escaped key from the json text against a c string, without decoding it
+bool gj_lazyKeyEquals( const char* key_str, const char* key_end, uint32_t escape_count, const char* c_string, size_t c_string_len )
+{
+  // a key with escapes decodes to at most this many chars
+  const size_t max_len = (size_t)( key_end - key_str ) - escape_count;
+  if ( escape_count == 0 || max_len < c_string_len )
+  {
+    return max_len == c_string_len && memcmp( key_str, c_string, c_string_len ) == 0;
+  }
+
+  size_t i_char = 0;
+  while ( key_str < key_end )
+  {
+    char     chars[ 4 ] = { *key_str++ };
+    uint32_t char_count = 1;
+    if ( chars[ 0 ] == '\\' )
+    {
+      char_count = gj_unescapeSequence( key_str, key_end, chars, &key_str );
+    }
+
+    if ( char_count == 0 || c_string_len - i_char < char_count || memcmp( c_string + i_char, chars, char_count ) != 0 )
+    {
+      return false;
+    }
+    i_char += char_count;
+  }
+
+  return i_char == c_string_len;
+}
+
+//---------------------------------------------------------------------------------
+// Walks the object's members looking for key. returns an invalid value if there
+// isn't one, asserting only if assert_if_missing is set
+gjLazyValue gj_findLazyMember( const gjLazyValue* obj, const char* key, bool assert_if_missing )
+{
+  if ( obj->cursor == nullptr )
+  {
+    gj_assert( "Attempting to get member from a lazy value that does not exist" );
+    return gjLazyValue();
+  }
+
+  if ( obj->getType() != gjValueType::kObject )
+  {
+    gj_assert( "Attempting to get member from a value that isn't an object" );
+    return gjLazyValue();
+  }
+
+  _gjParseContext ctx;
+  gj_initLazyContext( &ctx, obj );
+
+  const size_t key_len = strlen( key );
+  bool         has_member;
+  gj_enterLazyContainer( &ctx, '}', &has_member );
+  while ( has_member )
+  {
+    const char* key_str;
+    const char* key_end;
+    uint32_t    escape_count;
+    if ( gj_readLazyKey( &ctx, &key_str, &key_end, &escape_count ) == false )
+    {
+      return gjLazyValue();
+    }
+
+    if ( gj_lazyKeyEquals( key_str, key_end, escape_count, key, key_len ) )
+    {
+      return gj_makeLazyValue( &ctx );
+    }
+
+    if ( gj_nextLazyContainerValue( &ctx, '}', &has_member ) == false )
+    {
+      return gjLazyValue();
+    }
+  }
+
+  if ( assert_if_missing )
+  {
+    gj_assert( "Attempting to get member that does not exist in object" );
+  }
+  return gjLazyValue();
+}
+
+//---------------------------------------------------------------------------------
+// Reads the number at the value, reporting not_number_message if it isn't one
+bool gj_readLazyNumber( const gjLazyValue* val, _gjNumber* out_number, const char* not_number_message )
+{
+  if ( val->getType() != gjValueType::kNumber )
+  {
+    gj_assert( val->cursor == nullptr ? "Attempting to get a number from a lazy value that does not exist" : not_number_message );
+    return false;
+  }
+
+  _gjParseContext ctx;
+  gj_initLazyContext( &ctx, val );
+  return gj_readNumber( &ctx, out_number );
+}
+
+//---------------------------------------------------------------------------------
+gjLazyDoc::gjLazyDoc( const char* json_string, size_t string_len )
+  : m_Json( json_string )
+  , m_End ( json_string + string_len )
+{
+}
+
+//---------------------------------------------------------------------------------
+gjLazyValue gjLazyDoc::getRoot() const
+{
+  _gjParseContext ctx;
+  gjLazyValue     doc;
+  doc.cursor = m_Json;
+  doc.end    = m_End;
+  gj_initLazyContext( &ctx, &doc );
+
+  gj_skipWhitespace( &ctx );
+  if ( gj_peekChar( &ctx ) == '\0' )
+  {
+    gj_assert( "Unexpected end of the json data!" );
+    return gjLazyValue();
+  }
+
+  return gj_makeLazyValue( &ctx );
+}
+
+//---------------------------------------------------------------------------------
+gjLazyValue::gjLazyValue()
+  : cursor( nullptr )
+  , end   ( nullptr )
+{
+}
+
+//---------------------------------------------------------------------------------
+gjLazyValue gjLazyValue::operator[]( uint32_t elem_idx ) const
+{
+  return getElement( elem_idx );
+}
+
+//---------------------------------------------------------------------------------
+gjLazyValue gjLazyValue::operator[]( const char* key ) const
+{
+  return getMember( key );
+}
+
+//---------------------------------------------------------------------------------
+bool gjLazyValue::isValid() const
+{
+  return cursor != nullptr;
+}
+
+//---------------------------------------------------------------------------------
+gjValueType gjLazyValue::getType() const
+{
+  if ( cursor == nullptr || cursor >= end )
+  {
+    return gjValueType::kInvalid;
+  }
+
+  switch ( *cursor )
+  {
+    case '{':
+    {
+      return gjValueType::kObject;
+    }
+    case '[':
+    {
+      return gjValueType::kArray;
+    }
+    case '"':
+    {
+      return gjValueType::kString;
     }
-    else
+    case 't':
+    case 'f':
+    {
+      return gjValueType::kBool;
+    }
+    case 'n':
     {
-      gj_assert( "backing data is not large enough to make deep copy" );
+      return gjValueType::kNull;
     }
   }
 
-  return copy_val;
+  return ( *cursor == '-' || gj_isDigit( *cursor ) ) ? gjValueType::kNumber : gjValueType::kInvalid;
 }
 
 //---------------------------------------------------------------------------------
-//
-// Array operations
-//
-//---------------------------------------------------------------------------------
-uint32_t gjValue::getElementCount() const
+int gjLazyValue::getInt() const
 {
-  if ( gj_isValueAlloced( idx, gen ) )
+  _gjNumber number;
+  if ( gj_readLazyNumber( this, &number, "Attempting to get int for json value that is not a number" ) )
   {
-    const _gjValue* val = &s_ValuePool[ idx ];
-    if ( VAL_TYPE( val ) == gjValueType::kArray )
+    switch ( number.m_SubType )
     {
-      const _gjArrayHandle arr_handle_start = val->m_ArrayStart;
-      if ( arr_handle_start.m_Idx == kArrayIdxTail )
-      {
-        return 0;
-      }
-      if ( arr_handle_start.m_Gen == s_ArrayPool[ arr_handle_start.m_Idx ].m_Gen )
-      {
-        uint32_t count = 0;
-
-        uint32_t elem_idx = arr_handle_start.m_Idx;
-        while ( elem_idx != kArrayIdxTail )
-        {
-          elem_idx = s_ArrayPool[ elem_idx ].m_Next;
-          count++;
-        }
-
-        return count;
-      }
-      else
-      {
-        gj_assert( "Attempting to get element count for an array that has been freed" );
-      }
-
+    case kGjSubValueTypeInt:
+    {
+      return number.m_Int;
     }
-    else
+    break;
+    case kGjSubValueTypeU64:
     {
-      gj_assert( "Attempting to get element count for json value that is not a array" );
+      return (int)number.m_U64;
+    }
+    break;
+    case kGjSubValueTypeFloat:
+    {
+      return (int)number.m_Float;
+    }
+    break;
     }
-  }
-  else
-  {
-    gj_assert( "Attempting to get element count for deallocated json value" );
   }
 
   return 0;
 }
 
 //---------------------------------------------------------------------------------
-gjValue gjValue::getElement( uint32_t elem_idx ) const
+uint64_t gjLazyValue::getU64() const
 {
-  if ( gj_isValueAlloced( idx, gen ) )
+  _gjNumber number;
+  if ( gj_readLazyNumber( this, &number, "Attempting to get u64 for json value that is not a number" ) )
   {
-    const _gjValue* val = &s_ValuePool[ idx ];
-    if ( VAL_TYPE( val ) == gjValueType::kArray )
+    switch ( number.m_SubType )
     {
-      const _gjArrayHandle arr_handle_start = val->m_ArrayStart;
-      if ( arr_handle_start.m_Gen == s_ArrayPool[ arr_handle_start.m_Idx ].m_Gen )
-      {
-        if ( arr_handle_start.m_Idx != kArrayIdxTail )
-        {
-          uint32_t cur_idx = 0;
-          const _gjArrayElem* elem = &s_ArrayPool[ arr_handle_start.m_Idx ];
-          while ( cur_idx != elem_idx && elem->m_Next != kArrayIdxTail )
-          {
-            cur_idx++;
-            elem = &s_ArrayPool[ elem->m_Next ];
-          }
-          return cur_idx != elem_idx ? gjValue() : elem->m_Value;
-        }
-        return gjValue();
-      }
-      else
-      {
-        gj_assert( "Attempting to get element for an array that has been freed" );
-      }
-
+    case kGjSubValueTypeInt:
+    {
+      return (uint64_t)number.m_Int;
     }
-    else
+    break;
+    case kGjSubValueTypeU64:
     {
-      gj_assert( "Attempting to get element for json value that is not a array" );
+      return number.m_U64;
+    }
+    break;
+    case kGjSubValueTypeFloat:
+    {
+      return (uint64_t)number.m_Float;
+    }
+    break;
     }
-  }
-  else
-  {
-    gj_assert( "Attempting to get element for deallocated json value" );
   }
 
-  return gjValue{};
+  return 0;
 }
 
 //---------------------------------------------------------------------------------
-gjValue gjValue::operator[]( uint32_t elem_idx ) const
+float gjLazyValue::getFloat() const
 {
-  return getElement( elem_idx );
+  _gjNumber number;
+  if ( gj_readLazyNumber( this, &number, "Attempting to get float for json value that is not a number" ) )
+  {
+    switch ( number.m_SubType )
+    {
+    case kGjSubValueTypeInt:
+    {
+      return (float)number.m_Int;
+    }
+    break;
+    case kGjSubValueTypeU64:
+    {
+      return (float)number.m_U64;
+    }
+    break;
+    case kGjSubValueTypeFloat:
+    {
+      return number.m_Float;
+    }
+    break;
+    }
+  }
+
+  return 0;
 }
 
 //---------------------------------------------------------------------------------
-void gjValue::insertElement( gjValue value, uint32_t insert_idx )
+bool gjLazyValue::getBool() const
 {
-  if ( gj_isValueAlloced( idx, gen ) )
+  if ( getType() == gjValueType::kBool )
   {
-    _gjValue* val = &s_ValuePool[ idx ];
-    if ( VAL_TYPE( val ) == gjValueType::kArray )
-    {
-      uint32_t arr_head_idx = val->m_ArrayStart.m_Idx;
-      _gjArrayElem* elem = gj_allocArrayElem( &arr_head_idx, insert_idx );
-
-      if ( elem != nullptr )
-      {
-        if ( arr_head_idx != val->m_ArrayStart.m_Idx )
-        {
-          val->m_ArrayStart.m_Idx = arr_head_idx;
-          val->m_ArrayStart.m_Gen = elem->m_Gen;
-        }
+    _gjParseContext ctx;
+    gj_initLazyContext( &ctx, this );
 
-        elem->m_Value = value;
-      }
-      else
-      {
-        gj_assert( "Attempting to create array element, but the array pool is full. You may be out of memory" );
-      }
-    }
-    else
+    const bool value = *cursor == 't';
+    if ( gj_parseLiteral( &ctx, value ? "true" : "false", value ? 4 : 5 ) )
     {
-      gj_assert( "Attempting to insert element into a value that isn't an array" );
+      return value;
     }
   }
+  else if ( cursor == nullptr )
+  {
+    gj_assert( "Attempting to get bool for a lazy value that does not exist" );
+  }
   else
   {
-    gj_assert( "Attempting to insert element into a value that has been freed" );
+    gj_assert( "Attempting to get bool for json value that is not a bool" );
   }
+
+  return false;
 }
 
 //---------------------------------------------------------------------------------
-void gjValue::removeElement( uint32_t remove_idx )
+uint32_t gjLazyValue::copyString( char* out_str, uint32_t out_str_len ) const
 {
-  if ( gj_isValueAlloced( idx, gen ) )
+  if ( out_str_len > 0 )
   {
-    _gjValue* val = &s_ValuePool[ idx ];
-    if ( VAL_TYPE( val ) == gjValueType::kArray)
-    {
-      const _gjArrayElem* freed_elem  = gj_freeArrayElem( &val->m_ArrayStart, remove_idx );
-      if ( freed_elem )
-      {
-        _gjValue* freed_value = &s_ValuePool[ freed_elem->m_Value.idx ];
-        gj_freeValueData( freed_value );
-        gj_freeValue    ( freed_elem->m_Value.idx );
-      }
-    }
-    else
-    {
-      gj_assert( "Attempting to remove element into a value that isn't an array" );
-    }
+    out_str[ 0 ] = '\0';
   }
-  else
+
+  if ( getType() != gjValueType::kString )
   {
-    gj_assert( "Attempting to remove element from a value that has been freed" );
+    gj_assert( cursor == nullptr ? "Attempting to get string for a lazy value that does not exist" : "Attempting to get string for json value that is not a string" );
+    return 0;
+  }
+
+  _gjParseContext ctx;
+  gj_initLazyContext( &ctx, this );
+
+  const char* json_str = cursor + 1;
+  uint32_t    escape_count;
+  const char* close_quote = gj_findClosingQuote( &ctx, json_str, &escape_count );
+  if ( close_quote == nullptr )
+  {
+    return 0;
   }
+
+  return gj_unescapeString( json_str, (size_t)( close_quote - json_str ), out_str, out_str_len );
 }
 
 //---------------------------------------------------------------------------------
-gjValue gjValue::detachElement( uint32_t detach_idx )
+gjValue gjLazyValue::materialize() const
 {
-  if ( gj_isValueAlloced( idx, gen ) )
+  if ( cursor == nullptr )
   {
-    _gjValue* val = &s_ValuePool[ idx ];
-    if ( VAL_TYPE( val ) == gjValueType::kArray)
-    {
-      const _gjArrayElem* freed_elem  = gj_freeArrayElem( &val->m_ArrayStart, detach_idx );
-      if ( freed_elem )
-      {
-        return freed_elem->m_Value;
-      }
-    }
-    else
-    {
-      gj_assert( "Attempting to remove element into a value that isn't an array" );
-    }
+    gj_assert( "Attempting to materialize a lazy value that does not exist" );
+    return gjValue();
   }
-  else
+
+  _gjParseContext ctx;
+  gj_initLazyContext( &ctx, this );
+  if ( gj_skipLazyValue( &ctx ) == false )
   {
-    gj_assert( "Attempting to remove element from a value that has been freed" );
+    return gjValue();
   }
 
-  return gjValue{};
+  return gj_parseBuffer( cursor, (size_t)( ctx.m_Cursor - cursor ), false, 0 );
 }
 
 //---------------------------------------------------------------------------------
-void gjValue::clearArray()
+uint32_t gjLazyValue::getElementCount() const
 {
-  if ( gj_isValueAlloced( idx, gen ) )
+  if ( getType() != gjValueType::kArray )
   {
-    _gjValue* val = &s_ValuePool[ idx ];
-    if ( VAL_TYPE( val ) == gjValueType::kArray)
-    {
-      gj_freeValueData( val );
-      val->m_ArrayStart.m_Idx = (uint32_t)-1;
-      val->m_ArrayStart.m_Gen = (uint32_t)-1;
-    }
-    else
+    gj_assert( cursor == nullptr ? "Attempting to get element count for a lazy value that does not exist" : "Attempting to get element count for a value that isn't an array" );
+    return 0;
+  }
+
+  _gjParseContext ctx;
+  gj_initLazyContext( &ctx, this );
+
+  uint32_t count = 0;
+  bool     has_elem;
+  gj_enterLazyContainer( &ctx, ']', &has_elem );
+  while ( has_elem )
+  {
+    count++;
+    if ( gj_nextLazyContainerValue( &ctx, ']', &has_elem ) == false )
     {
-      gj_assert( "Attempting to clear array on a value that isn't an array" );
+      return 0;
     }
   }
-  else
+
+  return count;
+}
+
+//---------------------------------------------------------------------------------
+gjLazyValue gjLazyValue::getElement( uint32_t elem_idx ) const
+{
+  if ( getType() != gjValueType::kArray )
   {
-    gj_assert( "Attempting to clear array on a value that has been freed" );
+    gj_assert( cursor == nullptr ? "Attempting to get element from a lazy value that does not exist" : "Attempting to get element from a value that isn't an array" );
+    return gjLazyValue();
   }
+
+  _gjParseContext ctx;
+  gj_initLazyContext( &ctx, this );
+
+  bool has_elem;
+  gj_enterLazyContainer( &ctx, ']', &has_elem );
+  for ( uint32_t i_elem = 0; has_elem; ++i_elem )
+  {
+    if ( i_elem == elem_idx )
+    {
+      return gj_makeLazyValue( &ctx );
+    }
+
+    if ( gj_nextLazyContainerValue( &ctx, ']', &has_elem ) == false )
+    {
+      return gjLazyValue();
+    }
+  }
+
+  gj_assert( "Attempting to get element past the end of the array" );
+  return gjLazyValue();
 }
 
 //---------------------------------------------------------------------------------
-//
-// Object operations
-//
-//---------------------------------------------------------------------------------
-uint32_t gjValue::getMemberCount() const
+gjLazyValue gjLazyValue::getNextElement() const
 {
-  if ( gj_isValueAlloced( idx, gen ) )
+  if ( cursor == nullptr )
   {
-    const _gjValue* val = &s_ValuePool[ idx ];
-    if ( VAL_TYPE( val ) == gjValueType::kObject )
-    {
-      const _gjMemberHandle obj_handle_start = val->m_ObjectStart;
-      if ( obj_handle_start.m_Idx == kMemberIdxTail )
-      {
-        return 0;
-      }
+    gj_assert( "Attempting to get next element after a lazy value that does not exist" );
+    return gjLazyValue();
+  }
 
-      if ( obj_handle_start.m_Gen == s_MemberPool[ obj_handle_start.m_Idx ].m_Gen )
-      {
-        uint32_t count = 0;
+  _gjParseContext ctx;
+  gj_initLazyContext( &ctx, this );
 
-        uint32_t member_idx = obj_handle_start.m_Idx;
-        while ( member_idx != kMemberIdxTail )
-        {
-          member_idx = s_MemberPool[ member_idx ].m_Next;
-          count++;
-        }
+  bool has_elem;
+  if ( gj_nextLazyContainerValue( &ctx, ']', &has_elem ) == false || has_elem == false )
+  {
+    return gjLazyValue();
+  }
 
-        return count;
-      }
-      else
-      {
-        gj_assert( "Attempting to get member count for an object that has been freed" );
-      }
+  return gj_makeLazyValue( &ctx );
+}
 
-    }
-    else
-    {
-      gj_assert( "Attempting to get member count for json value that is not an object" );
-    }
+//---------------------------------------------------------------------------------
+uint32_t gjLazyValue::getMemberCount() const
+{
+  if ( getType() != gjValueType::kObject )
+  {
+    gj_assert( cursor == nullptr ? "Attempting to get member count for a lazy value that does not exist" : "Attempting to get member count for a value that isn't an object" );
+    return 0;
   }
-  else
+
+  _gjParseContext ctx;
+  gj_initLazyContext( &ctx, this );
+
+  uint32_t count = 0;
+  bool     has_member;
+  gj_enterLazyContainer( &ctx, '}', &has_member );
+  while ( has_member )
   {
-    gj_assert( "Attempting to get member count for deallocated json value" );
+    const char* key_str;
+    const char* key_end;
+    uint32_t    escape_count;
+    if ( gj_readLazyKey( &ctx, &key_str, &key_end, &escape_count ) == false ||
+         gj_nextLazyContainerValue( &ctx, '}', &has_member ) == false )
+    {
+      return 0;
+    }
+    count++;
   }
 
-  return 0;
+  return count;
 }
 
 //---------------------------------------------------------------------------------
-gjValue gjValue::operator[]( const char* key ) const
+gjLazyValue gjLazyValue::getMember( const char* key ) const
 {
-  return getMember( key );
+  return gj_findLazyMember( this, key, true );
 }
 
 //---------------------------------------------------------------------------------
-gjValue gjValue::getMember( const char* key ) const
+bool gjLazyValue::hasMember( const char* key ) const
 {
-  return getMember( gj_crc32( key ) );
+  return gj_findLazyMember( this, key, false ).isValid();
 }
 
 //---------------------------------------------------------------------------------
-gjValue gjValue::getMember( uint32_t key_crc32 ) const
+// The event parser walks the document the same way gj_parseDocument does, but it
+// reports each token instead of building values. With nothing to allocate, the only
+// record of the containers it's inside of is one bit per level saying whether it's
+// an object, which is what caps the nesting.
+static constexpr uint32_t kEventStackWords = kGjMaxEventDepth / 64;
+
+//---------------------------------------------------------------------------------
+inline bool gj_sendEvent( gjEventFn event_fn, const char* text, size_t text_len, void* user_data )
 {
-  if ( gj_isValueAlloced( idx, gen ) )
+  return event_fn == nullptr || event_fn( text, text_len, user_data );
+}
+
+//---------------------------------------------------------------------------------
+// Strings are reported without being decoded, but they still have to hold escapes
+// gj_parse would accept
+bool gj_checkEscapes( const char* str, const char* str_end, uint32_t escape_count )
+{
+  // a surrogate pair is two escapes but one sequence, so the count only says if there are any
+  const char* cursor = escape_count > 0 ? str : str_end;
+  while ( ( cursor = (const char*)memchr( cursor, '\\', (size_t)( str_end - cursor ) ) ) != nullptr )
   {
-    const _gjValue* val = &s_ValuePool[ idx ];
-    if ( VAL_TYPE( val ) == gjValueType::kObject )
+    char chars[ 4 ];
+    if ( gj_unescapeSequence( cursor + 1, str_end, chars, &cursor ) == 0 )
     {
-      const _gjMemberHandle member_handle_start = val->m_ObjectStart;
-      if ( member_handle_start.m_Idx != kMemberIdxTail )
-      {
-        if ( member_handle_start.m_Gen == s_MemberPool[ member_handle_start.m_Idx ].m_Gen )
-        {
-          uint32_t cur_idx = member_handle_start.m_Idx;
-          const _gjMember* member = &s_MemberPool[ cur_idx ];
-          while ( member->m_KeyHash != key_crc32 && member->m_Next != kMemberIdxTail )
-          {
-            cur_idx = member->m_Next;
-            member = &s_MemberPool[ cur_idx ];
-          }
-
-          if ( member->m_KeyHash == key_crc32 )
-          {
-            return member->m_Value;
-          }
-          else
-          {
-            gj_assert( "Attempting to get member that does not exist in object" );
-          }
-        }
-        else
-        {
-          gj_assert( "Attempting to get member for an object that has been freed" );
-        }
-      }
-      else
-      {
-        gj_assert( "Attempting to get member in an empty object" );
-      }
+      gj_assert( "error parsing string literal: unrecognized escape sequence" );
+      return false;
     }
-    else
+  }
+
+  return true;
+}
+
+//---------------------------------------------------------------------------------
+// Reads `"key" :` at the cursor and reports the key
+bool gj_parseEventKey( _gjParseContext* ctx, const gjEventHandler* handler )
+{
+  gj_skipWhitespace( ctx );
+
+  const char* key_str;
+  const char* key_end;
+  uint32_t    escape_count;
+  return gj_readLazyKey( ctx, &key_str, &key_end, &escape_count ) &&
+         gj_checkEscapes( key_str, key_end, escape_count ) &&
+         gj_sendEvent( handler->onKey, key_str, (size_t)( key_end - key_str ), handler->user_data );
+}
+
+//---------------------------------------------------------------------------------
+// Reads the string, number or literal at the cursor and reports it
+bool gj_parseEventScalar( _gjParseContext* ctx, const gjEventHandler* handler )
+{
+  // the input isn't null terminated, so the end has to be checked before the token is looked at
+  const char  first_char = gj_peekChar( ctx );
+  const char* token      = ctx->m_Cursor;
+  if ( first_char == '\0' )
+  {
+    gj_assert( "Unexpected end of the json data!" );
+    return false;
+  }
+
+  if ( first_char == '"' )
+  {
+    uint32_t    escape_count;
+    const char* close_quote = gj_findClosingQuote( ctx, token + 1, &escape_count );
+    if ( close_quote == nullptr || gj_checkEscapes( token + 1, close_quote, escape_count ) == false )
     {
-      gj_assert( "Attempting to get member from a value that isn't an object" );
+      return false;
     }
+
+    ctx->m_Cursor = close_quote + 1;
+    return gj_sendEvent( handler->onString, token + 1, (size_t)( close_quote - token - 1 ), handler->user_data );
   }
-  else
+
+  if ( gj_skipLazyValue( ctx ) == false )
   {
-    gj_assert( "Attempting to get member from a value that has been freed" );
+    return false;
   }
 
-  return gjValue();
-}
+  const size_t token_len = (size_t)( ctx->m_Cursor - token );
+  switch ( first_char )
+  {
+    case 't':
+    case 'f':
+    {
+      return gj_sendEvent( handler->onBool, token, token_len, handler->user_data );
+    }
+    case 'n':
+    {
+      return gj_sendEvent( handler->onNull, token, token_len, handler->user_data );
+    }
+  }
 
-//---------------------------------------------------------------------------------
-bool gjValue::hasMember( const char* key ) const
-{
-  return hasMember( gj_crc32( key ) );
+  return gj_sendEvent( handler->onNumber, token, token_len, handler->user_data );
 }
 
 //---------------------------------------------------------------------------------
-bool gjValue::hasMember( uint32_t key_crc32 ) const
+bool gj_parseEvents( const char* json_string, size_t string_len, const gjEventHandler* handler )
 {
-  if ( gj_isValueAlloced( idx, gen ) )
+  gjLazyValue     doc;
+  _gjParseContext ctx;
+  doc.cursor = json_string;
+  doc.end    = json_string + string_len;
+  gj_initLazyContext( &ctx, &doc );
+
+  uint64_t in_object[ kEventStackWords ];
+  uint32_t depth = 0;
+
+  while ( true )
   {
-    const _gjValue* val = &s_ValuePool[ idx ];
-    if ( VAL_TYPE( val ) == gjValueType::kObject )
+    gj_skipWhitespace( &ctx );
+    const char open_char = gj_peekChar( &ctx );
+
+    if ( open_char == '{' || open_char == '[' )
     {
-      const _gjMemberHandle member_handle_start = val->m_ObjectStart;
-      if ( member_handle_start.m_Idx == kMemberIdxTail )
+      if ( depth == kGjMaxEventDepth )
+      {
+        gj_assert( "json data is nested too deeply to parse events for" );
+        return false;
+      }
+
+      const uint64_t level_bit = 1ull << ( depth % 64 );
+      if ( open_char == '{' )
+      {
+        in_object[ depth / 64 ] |= level_bit;
+      }
+      else
+      {
+        in_object[ depth / 64 ] &= ~level_bit;
+      }
+      depth++;
+
+      const gjEventFn start_fn = open_char == '{' ? handler->onStartObject : handler->onStartArray;
+      const gjEventFn end_fn   = open_char == '{' ? handler->onEndObject   : handler->onEndArray;
+      if ( gj_sendEvent( start_fn, ctx.m_Cursor++, 1, handler->user_data ) == false )
       {
         return false;
       }
 
-      if ( member_handle_start.m_Gen == s_MemberPool[ member_handle_start.m_Idx ].m_Gen )
+      gj_skipWhitespace( &ctx );
+      if ( gj_peekChar( &ctx ) == ( open_char == '{' ? '}' : ']' ) )
       {
-        uint32_t cur_idx = member_handle_start.m_Idx;
-        const _gjMember* member = &s_MemberPool[ cur_idx ];
-        while ( member->m_KeyHash != key_crc32 && member->m_Next != kMemberIdxTail )
+        depth--;
+        if ( gj_sendEvent( end_fn, ctx.m_Cursor++, 1, handler->user_data ) == false )
         {
-          cur_idx = member->m_Next;
-          member = &s_MemberPool[ cur_idx ];
+          return false;
         }
-
-        return member->m_KeyHash == key_crc32;
+      }
+      else if ( open_char == '{' )
+      {
+        if ( gj_parseEventKey( &ctx, handler ) == false )
+        {
+          return false;
+        }
+        continue;
       }
       else
       {
-        gj_assert( "Attempting to get member for an object that has been freed" );
+        continue;
       }
     }
-    else
+    else if ( gj_parseEventScalar( &ctx, handler ) == false )
     {
-      gj_assert( "Attempting to get member from a value that isn't an object" );
+      return false;
     }
-  }
-  else
-  {
-    gj_assert( "Attempting to get member from a value that has been freed" );
-  }
-
-  return false;
-}
 
-//---------------------------------------------------------------------------------
-void gjValue::addMember( const char* key, gjValue value )
-{
-  if ( gj_isValueAlloced( idx, gen ) )
-  {
-    _gjValue* val = &s_ValuePool[ idx ];
-    if ( VAL_TYPE( val ) == gjValueType::kObject )
+    // the value is complete, so close containers until one has another value to come
+    bool has_next_value = false;
+    while ( depth > 0 && has_next_value == false )
     {
-      uint32_t head_idx = val->m_ObjectStart.m_Idx;
-      _gjMember* member = gj_allocMember( &head_idx );
+      gj_skipWhitespace( &ctx );
 
-      if ( member != nullptr )
+      const bool is_object = ( in_object[ ( depth - 1 ) / 64 ] >> ( ( depth - 1 ) % 64 ) ) & 1;
+      const char next_char = gj_peekChar( &ctx );
+      if ( next_char == ',' )
       {
-        if ( head_idx != val->m_ObjectStart.m_Idx )
+        ctx.m_Cursor++;
+        if ( is_object && gj_parseEventKey( &ctx, handler ) == false )
         {
-          val->m_ObjectStart.m_Idx = head_idx;
-          val->m_ObjectStart.m_Gen = member->m_Gen;
+          return false;
+        }
+        has_next_value = true;
+      }
+      else if ( next_char == ( is_object ? '}' : ']' ) )
+      {
+        depth--;
+        if ( gj_sendEvent( is_object ? handler->onEndObject : handler->onEndArray, ctx.m_Cursor++, 1, handler->user_data ) == false )
+        {
+          return false;
         }
-
-        const size_t key_str_size = gj_StrLen( key );
-        member->m_KeyStr = (char*)gj_malloc( key_str_size + 1, "Object Key String" );
-        memcpy( member->m_KeyStr, key, key_str_size );
-        member->m_KeyStr[ key_str_size ] = '\0';
-        member->m_KeyHash = gj_crc32( key );
-        member->m_Value   = value;
       }
       else
       {
-        gj_assert( "Attempting to create object member, but the  member pool is full. You may be out of memory" );
+        gj_assert( "Unexpected token!" );
+        return false;
       }
     }
-    else
+
+    if ( has_next_value == false )
     {
-      gj_assert( "Attempting to add member to a value that isn't an object" );
+      break;
     }
   }
-  else
+
+  gj_skipWhitespace( &ctx );
+  if ( gj_peekChar( &ctx ) != '\0' )
   {
-    gj_assert( "Attempting to add member to a value that has been freed" );
+    gj_assert( "Unexpected token after the end of the json data!" );
+    return false;
   }
+
+  return true;
 }
 
 //---------------------------------------------------------------------------------
-void gjValue::removeMember( const char* key )
-{
-  removeMember( gj_crc32( key ) );
-}
+// Batches of documents are parsed on several threads, each allocating from its own
+// partition of the pools (see kPartitionBlockSize). The first few are parsed up front
+// to see how much of each pool the rest are likely to need, so the pools can grow
+// before the workers start and stay put while they run.
+static constexpr uint32_t kMaxParseThreads     = 64;
+static constexpr uint32_t kBatchRecordsPerTake = 16; // records a worker takes at a time
+static constexpr uint32_t kBatchSampleFraction = 32; // parses 1/32 of the bytes up front
 
 //---------------------------------------------------------------------------------
-void gjValue::removeMember( uint32_t key_crc32 )
+struct _gjBatchRecord
 {
-  if ( gj_isValueAlloced( idx, gen ) )
-  {
-    _gjValue* val = &s_ValuePool[ idx ];
-    if ( VAL_TYPE( val ) == gjValueType::kObject )
-    {
-      const _gjMember* freed_elem  = gj_freeMember( &val->m_ObjectStart, key_crc32 );
-      if ( freed_elem != nullptr )
-      {
-        _gjValue* freed_value = &s_ValuePool[ freed_elem->m_Value.idx ];
-        gj_freeValueData( freed_value );
-        gj_freeValue    ( freed_elem->m_Value.idx );
-      }
-    }
-    else
-    {
-      gj_assert( "Attempting to remove member from a value that isn't an object" );
-    }
-  }
-  else
-  {
-    gj_assert( "Attempting to remove member from a value that has been freed" );
-  }
-}
+  const char* m_Json;
+  size_t      m_JsonLen;
+  gjValue     m_Value;
+  bool        m_OutOfRoom; // no worker had room to parse it, so it's parsed once the workers are done
+};
 
 //---------------------------------------------------------------------------------
-gjValue gjValue::detachMember( const char* key )
+struct _gjBatch
 {
-  return detachMember( gj_crc32( key ) );
-}
+  _gjBatchRecord*         m_Records;
+  uint32_t                m_RecordCount;
+  uint32_t                m_BaseDepth;
+  std::atomic< uint32_t > m_NextRecord;
+};
 
 //---------------------------------------------------------------------------------
-gjValue gjValue::detachMember( uint32_t key_crc32 )
+// returns how many chunks a pool has to grow by so count entries fit, given free_count free ones
+uint32_t gj_getPoolGrowChunks( const _gjPool* pool, uint32_t free_count, uint64_t count )
 {
-  if ( gj_isValueAlloced( idx, gen ) )
-  {
-    _gjValue* val = &s_ValuePool[ idx ];
-    if ( VAL_TYPE( val ) == gjValueType::kObject )
-    {
-      const _gjMember* freed_elem  = gj_freeMember( &val->m_ObjectStart, key_crc32 );
-      if ( freed_elem != nullptr )
-      {
-        return freed_elem->m_Value;
-      }
-    }
-    else
-    {
-      gj_assert( "Attempting to remove member from a value that isn't an object" );
-    }
-  }
-  else
+  if ( count <= free_count )
   {
-    gj_assert( "Attempting to remove member from a value that has been freed" );
+    return 0;
   }
 
-  return gjValue{};
+  const uint64_t grow_count = ( count - free_count + pool->m_ChunkMask ) >> pool->m_ChunkShift;
+  return grow_count < kPoolMaxCapacity ? (uint32_t)grow_count : (uint32_t)kPoolMaxCapacity;
 }
 
 //---------------------------------------------------------------------------------
-void gjValue::clearObject()
+// Grows the pools by what the workers are estimated to need beyond what's free. Workers
+// use the entries that were never handed out and then recycle the free lists, so both count
+void gj_reserveForWorkers( uint64_t value_count, uint64_t array_elem_count, uint64_t member_count )
 {
-  if ( gj_isValueAlloced( idx, gen ) )
+  if ( s_Config.growth_policy != gjPoolGrowthPolicy::kGrowInChunks )
   {
-    _gjValue* val = &s_ValuePool[ idx ];
-    if ( VAL_TYPE( val ) == gjValueType::kObject)
-    {
-      gj_freeValueData( val );
-      val->m_ObjectStart.m_Idx = (uint32_t)-1;
-      val->m_ObjectStart.m_Gen = (uint32_t)-1;
-    }
-    else
-    {
-      gj_assert( "Attempting to clear array on a value that isn't an array" );
-    }
+    return;
   }
-  else
+
+  // running short only means some records are parsed again later, so failing to grow is fine
+  if ( const uint32_t chunk_count = gj_getPoolGrowChunks( &s_ValuePool, s_ValuePool.m_Capacity - s_ValuePool.m_UsedCount, value_count ) )
   {
-    gj_assert( "Attempting to clear array on a value that has been freed" );
+    gj_growValuePool( chunk_count );
   }
-}
-
-//---------------------------------------------------------------------------------
-//
-// member iterators
-// 
-//---------------------------------------------------------------------------------
-gjMembers gjValue::members()
-{
-  gjMembers members;
-  members.value = *this;
-  return members;
-}
-
-//---------------------------------------------------------------------------------
-const gjMembers gjValue::members() const
-{
-  gjMembers members;
-  members.value = this;
-  return members;
-}
 
-//---------------------------------------------------------------------------------
-gjMembers::iterator gjMembers::begin()
-{
-  iterator it;
-  it.idx = kMemberIdxTail;
-  it.gen = (uint32_t)-1;
-  if ( gj_isValueAlloced( value.idx, value.gen ) )
+  if ( const uint32_t chunk_count = gj_getPoolGrowChunks( &s_MemberPool, s_MemberPool.m_Capacity - s_MemberPool.m_UsedCount, member_count ) )
   {
-    it.idx = s_ValuePool[ value.idx ].m_ObjectStart.m_Idx;
-    it.gen = s_ValuePool[ value.idx ].m_ObjectStart.m_Gen;
+    gj_growPool( &s_MemberPool, chunk_count, "gj: member pool chunk" );
   }
-  return it;
-}
-
-//---------------------------------------------------------------------------------
-gjMembers::iterator gjMembers::end()
-{
-  iterator it;
-  it.idx = kMemberIdxTail;
-  it.gen = (uint32_t)-1;
-  return it;
-}
 
-//---------------------------------------------------------------------------------
-gjMembers::const_iterator gjMembers::begin() const
-{
-  const_iterator it;
-  it.idx = kMemberIdxTail;
-  it.gen = (uint32_t)-1;
-  if ( gj_isValueAlloced( value.idx, value.gen ) )
+  // the arena's new block only has to cover the shortfall, what's left of its old one is freed
+  const uint32_t free_elem_count = s_ArrayPool.m_Capacity - s_ArrayPool.m_UsedCount;
+  if ( free_elem_count < array_elem_count && array_elem_count - free_elem_count < kPoolMaxCapacity )
   {
-    it.idx = s_ValuePool[ value.idx ].m_ObjectStart.m_Idx;
-    it.gen = s_ValuePool[ value.idx ].m_ObjectStart.m_Gen;
+    gj_growArrayArena( &s_ArrayArena, array_elem_count - free_elem_count );
   }
-  return it;
-}
-
-//---------------------------------------------------------------------------------
-gjMembers::const_iterator gjMembers::end() const
-{
-  const_iterator it;
-  it.idx = kMemberIdxTail;
-  it.gen = (uint32_t)-1;
-  return it;
 }
 
 //---------------------------------------------------------------------------------
-gjObjectMember gjMemberIterator::operator*()
+// Deals up to value_count values off the free list to the workers, keeping the values
+// that share a bitset word together
+void gj_dealSharedValues( _gjPartition* partitions, uint32_t partition_count, uint64_t value_count )
 {
-  if ( idx < s_Config.max_value_count && s_MemberPool[ idx ].m_Gen == gen )
+  for ( uint64_t i_value = 0; i_value < value_count && s_ValuePoolHead != kValueIdxTail; ++i_value )
   {
-    _gjMember* member = &s_MemberPool[ idx ];
-    return { member->m_KeyStr, member->m_Value };
+    const uint32_t idx       = s_ValuePoolHead;
+    _gjValue*      val       = gj_getValueSlot( idx );
+    _gjPartition*  partition = &partitions[ ( idx >> 6 ) % partition_count ];
+    s_ValuePoolHead = val->m_NextFree;
+    val->m_NextFree = partition->m_Values.m_FreeHead;
+    partition->m_Values.m_FreeHead = idx;
   }
-
-  return { nullptr, gjValue() };
 }
 
 //---------------------------------------------------------------------------------
-bool gjMemberIterator::operator==( const gjMemberIterator& other ) const
+void gj_initPartition( _gjPartition* partition )
 {
-  return idx == other.idx && gen == other.gen;
+  partition->m_Values.m_FreeHead  = kValueIdxTail;
+  partition->m_Values.m_BumpIdx   = 0;
+  partition->m_Values.m_EndIdx    = 0;
+  partition->m_Members.m_FreeHead = kMemberIdxTail;
+  partition->m_Members.m_BumpIdx  = 0;
+  partition->m_Members.m_EndIdx   = 0;
+  for ( uint32_t i_class = 0; i_class < kArrayRunClassCount; ++i_class )
+  {
+    partition->m_Arrays.m_RunHeads[ i_class ] = kArrayIdxTail;
+  }
+  partition->m_Arrays.m_BumpIdx     = 0;
+  partition->m_Arrays.m_EndIdx      = 0;
+  partition->m_Arrays.m_RegionStart = 0;
+  partition->m_UsedValues     = 0;
+  partition->m_UsedArrayElems = 0;
+  partition->m_UsedMembers    = 0;
+  partition->m_OutOfRoom      = false;
 }
 
 //---------------------------------------------------------------------------------
-gjMemberIterator& gjMemberIterator::operator++()
+// Hands back the entries a worker took but didn't use, and adds its counts to the pools
+void gj_returnPartition( _gjPartition* partition )
 {
-  if ( idx < s_Config.max_value_count && s_MemberPool[ idx ].m_Gen == gen && s_MemberPool[ idx ].m_Next != kMemberIdxTail )
+  while ( partition->m_Values.m_FreeHead != kValueIdxTail )
   {
-    _gjMember* next = &s_MemberPool[ s_MemberPool[ idx ].m_Next ];
-    idx = s_MemberPool[ idx ].m_Next;
-    gen = next->m_Gen;
+    _gjValue* val = gj_getValueSlot( partition->m_Values.m_FreeHead );
+    const uint32_t next_idx = val->m_NextFree;
+    val->m_NextFree = s_ValuePoolHead;
+    s_ValuePoolHead = partition->m_Values.m_FreeHead;
+    partition->m_Values.m_FreeHead = next_idx;
   }
-  else
+
+  for ( uint32_t idx = partition->m_Values.m_BumpIdx; idx < partition->m_Values.m_EndIdx; ++idx )
   {
-    idx = kMemberIdxTail;
-    gen = (uint32_t)-1;
+    _gjValue* val = gj_getValueSlot( idx );
+    val->m_Gen      = 0;
+    val->m_NextFree = s_ValuePoolHead;
+    s_ValuePoolHead = idx;
   }
 
-  return *this;
-}
-
-//---------------------------------------------------------------------------------
-const gjObjectMember gjConstMemberIterator::operator*()
-{
-  if ( idx < s_Config.max_value_count && s_MemberPool[ idx ].m_Gen == gen )
+  while ( partition->m_Members.m_FreeHead != kMemberIdxTail )
   {
-    _gjMember* member = &s_MemberPool[ idx ];
-    return { member->m_KeyStr, member->m_Value };
+    _gjMember* member = gj_getMemberSlot( partition->m_Members.m_FreeHead );
+    const uint32_t next_idx = member->m_Next;
+    member->m_Next   = s_MemberPoolHead;
+    s_MemberPoolHead = partition->m_Members.m_FreeHead;
+    partition->m_Members.m_FreeHead = next_idx;
   }
 
-  return { nullptr, gjValue() };
-}
-
-//---------------------------------------------------------------------------------
-bool gjConstMemberIterator::operator==( const gjConstMemberIterator& other ) const
-{
-  return idx == other.idx && gen == other.gen;
-}
+  for ( uint32_t idx = partition->m_Members.m_BumpIdx; idx < partition->m_Members.m_EndIdx; ++idx )
+  {
+    _gjMember* member = gj_getMemberSlot( idx );
+    member->m_Gen    = 0;
+    member->m_Next   = s_MemberPoolHead;
+    s_MemberPoolHead = idx;
+  }
 
-//---------------------------------------------------------------------------------
-gjConstMemberIterator& gjConstMemberIterator::operator++()
-{
-  if ( idx < s_Config.max_value_count && s_MemberPool[ idx ].m_Gen == gen && s_MemberPool[ idx ].m_Next != kMemberIdxTail )
+  _gjArrayArena* arena = &partition->m_Arrays;
+  for ( uint32_t i_class = 0; i_class < kArrayRunClassCount; ++i_class )
   {
-    _gjMember* next = &s_MemberPool[ s_MemberPool[ idx ].m_Next ];
-    idx = s_MemberPool[ idx ].m_Next;
-    gen = next->m_Gen;
+    while ( arena->m_RunHeads[ i_class ] != kArrayIdxTail )
+    {
+      const uint32_t run_idx = arena->m_RunHeads[ i_class ];
+      gj_unlinkArrayRun ( arena, run_idx );
+      gj_releaseArrayRun( &s_ArrayArena, run_idx, gj_getArrayElemSlot( run_idx )->m_Value.idx );
+    }
   }
-  else
+
+  if ( arena->m_EndIdx - arena->m_BumpIdx >= 2 )
   {
-    idx = kMemberIdxTail;
-    gen = (uint32_t)-1;
+    gj_releaseArrayRun( &s_ArrayArena, arena->m_BumpIdx, arena->m_EndIdx - arena->m_BumpIdx );
   }
 
-  return *this;
+  gj_notePoolAlloc( &s_ValuePool,  partition->m_UsedValues     );
+  gj_notePoolAlloc( &s_ArrayPool,  partition->m_UsedArrayElems );
+  gj_notePoolAlloc( &s_MemberPool, partition->m_UsedMembers    );
 }
 
 //---------------------------------------------------------------------------------
-//
-// sorting
-//
-//---------------------------------------------------------------------------------
-int gj_strcmp( const char* a, const char* b )
+// A worker whose partition runs out stops taking records and leaves them to the others
+void gj_parseBatchWorker( _gjBatch* batch, _gjPartition* partition )
 {
-  uint32_t idx = 0;
-  while ( a[ idx ] != '\0' && b[ idx ] != '\0' )
+  const uint32_t base_depth = batch->m_BaseDepth;
+  s_Partition = partition;
+
+  while ( partition->m_OutOfRoom == false )
   {
-    int cmp = (int)a[ idx ] - (int)b[ idx ];
-    if ( cmp != 0 )
+    const uint32_t first_record = batch->m_NextRecord.fetch_add( kBatchRecordsPerTake );
+    if ( first_record >= batch->m_RecordCount )
     {
-      return cmp;
+      break;
     }
-    idx++;
-  }
-  return 0;
-}
 
-//---------------------------------------------------------------------------------
-void gj_swap( uint32_t* a, uint32_t* b )
-{
-  uint32_t tmp = *a;
-  *a = *b;
-  *b = tmp;
+    const uint32_t end_record = batch->m_RecordCount - first_record > kBatchRecordsPerTake ? first_record + kBatchRecordsPerTake : batch->m_RecordCount;
+    for ( uint32_t i_record = first_record; i_record < end_record && partition->m_OutOfRoom == false; ++i_record )
+    {
+      _gjBatchRecord* record = &batch->m_Records[ i_record ];
+      record->m_Value     = gj_parseBuffer( record->m_Json, record->m_JsonLen, false, base_depth );
+      record->m_OutOfRoom = partition->m_OutOfRoom;
+    }
+  }
+
+  s_Partition = nullptr;
 }
 
 //---------------------------------------------------------------------------------
-uint32_t gj_quicksortPivot( uint32_t* key_idcs, uint32_t len )
+// Parses each record into its m_Value, spread over thread_count threads. base_depth is
+// how many containers the records sit inside of, as with gj_parseBuffer
+void gj_parseBatch( _gjBatchRecord* records, uint32_t record_count, uint32_t thread_count, uint32_t base_depth )
 {
-  uint32_t  low_idx  = 0;
-  uint32_t* pivot_a  = &key_idcs[ len - 1 ];
+  if ( thread_count == 0 )
+  {
+    thread_count = std::thread::hardware_concurrency();
+  }
+  thread_count = thread_count == 0 ? 1 : thread_count < kMaxParseThreads ? thread_count : kMaxParseThreads;
 
-  for ( uint32_t upper_idx = 0; upper_idx < len - 1; ++upper_idx)
+  size_t total_bytes = 0;
+  for ( uint32_t i_record = 0; i_record < record_count; ++i_record )
   {
-    uint32_t* pivot_b = &key_idcs[ upper_idx ];
-    _gjMember* member_a = &s_MemberPool[*pivot_a];
-    _gjMember* member_b = &s_MemberPool[*pivot_b];
+    total_bytes += records[ i_record ].m_JsonLen;
+  }
 
-    if ( gj_strcmp( member_a->m_KeyStr, member_b->m_KeyStr ) >= 0 )
-    {
-      gj_swap( &key_idcs[ low_idx ], &key_idcs[ upper_idx ] );
-      low_idx++;
-    }
+  // the sample is parsed here, and is all of it on one thread
+  const uint32_t used_values_before  = s_ValuePool.m_UsedCount;
+  const uint32_t used_elems_before   = s_ArrayPool.m_UsedCount;
+  const uint32_t used_members_before = s_MemberPool.m_UsedCount;
+
+  uint32_t sampled_count = 0;
+  size_t   sampled_bytes = 0;
+  while ( sampled_count < record_count && ( thread_count == 1 || sampled_count == 0 || sampled_bytes * kBatchSampleFraction < total_bytes ) )
+  {
+    _gjBatchRecord* record = &records[ sampled_count++ ];
+    record->m_Value     = gj_parseBuffer( record->m_Json, record->m_JsonLen, false, base_depth );
+    record->m_OutOfRoom = false;
+    sampled_bytes      += record->m_JsonLen;
   }
-  gj_swap( &key_idcs[ low_idx ], &key_idcs[ len - 1 ] );
 
-  return low_idx;
-}
+  if ( sampled_count == record_count )
+  {
+    return;
+  }
 
+  // leave room for each worker's partially used blocks on top of the estimate
+  const double   scale = 1.5 * (double)( total_bytes - sampled_bytes ) / (double)( sampled_bytes > 0 ? sampled_bytes : 1 );
+  const uint64_t slack = (uint64_t)thread_count * kPartitionBlockSize * 2;
+  const uint64_t value_count = (uint64_t)( ( s_ValuePool.m_UsedCount - used_values_before ) * scale ) + slack;
+  gj_reserveForWorkers( value_count,
+                        (uint64_t)( ( s_ArrayPool.m_UsedCount  - used_elems_before   ) * scale ) + slack,
+                        (uint64_t)( ( s_MemberPool.m_UsedCount - used_members_before ) * scale ) + slack );
+
+  // value blocks start on a bitset word
+  const uint32_t values_bump    = s_ValuePool.m_BumpIdx;
+  const uint64_t aligned_start  = ( (uint64_t)values_bump + 63 ) & ~63ull;
+  const uint32_t values_start   = aligned_start < s_ValuePool.m_Capacity ? (uint32_t)aligned_start : s_ValuePool.m_Capacity;
+  s_ValueSource.m_NextIdx  = values_start;
+  s_ValueSource.m_EndIdx   = s_ValuePool.m_Capacity;
+  s_MemberSource.m_NextIdx = s_MemberPool.m_BumpIdx;
+  s_MemberSource.m_EndIdx  = s_MemberPool.m_Capacity;
+  s_ArraySource.m_NextIdx  = s_ArrayArena.m_BumpIdx;
+  s_ArraySource.m_EndIdx   = s_ArrayArena.m_EndIdx;
+  s_ValuePool.m_BumpIdx    = s_ValuePool.m_Capacity;
+  s_MemberPool.m_BumpIdx   = s_MemberPool.m_Capacity;
+  s_ArrayArena.m_BumpIdx   = s_ArrayArena.m_EndIdx;
+
+  _gjBatch batch;
+  batch.m_Records     = records + sampled_count;
+  batch.m_RecordCount = record_count - sampled_count;
+  batch.m_BaseDepth   = base_depth;
+  batch.m_NextRecord  = 0;
+
+  // stays set for records nobody gets to
+  for ( uint32_t i_record = sampled_count; i_record < record_count; ++i_record )
+  {
+    records[ i_record ].m_OutOfRoom = true;
+  }
 
-//---------------------------------------------------------------------------------
-void gj_quickSortKeys( uint32_t* key_idcs, uint32_t count )
-{
-  if (count > 0)
+  _gjPartition partitions[ kMaxParseThreads ];
+  std::thread  threads   [ kMaxParseThreads ];
+  for ( uint32_t i_thread = 0; i_thread < thread_count; ++i_thread )
   {
-    uint32_t pivot_point = gj_quicksortPivot( key_idcs, count );
-    gj_quickSortKeys(  key_idcs, pivot_point );
-    gj_quickSortKeys( &key_idcs[ pivot_point + 1 ], count - pivot_point - 1 );
+    gj_initPartition( &partitions[ i_thread ] );
   }
-}
 
-//---------------------------------------------------------------------------------
-void gjValue::sortMembersByKeys()
-{
-  if ( gj_isValueAlloced( idx, gen ) )
+  const uint32_t unused_value_count = s_ValueSource.m_EndIdx - s_ValueSource.m_NextIdx;
+  if ( value_count > unused_value_count )
   {
-    _gjValue* val = &s_ValuePool[ idx ];
-    if ( VAL_TYPE( val ) == gjValueType::kObject)
-    {
-      // count the number of members
-      uint32_t member_count = 0;
-      if ( val->m_ObjectStart.m_Idx != kMemberIdxTail && val->m_ObjectStart.m_Gen == s_MemberPool[ val->m_ObjectStart.m_Idx ].m_Gen )
-      {
-        uint32_t member_idx = val->m_ObjectStart.m_Idx;
-        while ( member_idx != kMemberIdxTail )
-        {
-          _gjMember* member = &s_MemberPool[ member_idx ];
-          member_count++;
-          member_idx = member->m_Next;
-        }
-      }
-      
-      // place their indices in an array
-      uint32_t* tmp_idcs = (uint32_t*)gj_malloc( sizeof( *tmp_idcs ) * member_count, "member sort temp buffer" );
-      if ( val->m_ObjectStart.m_Idx != kMemberIdxTail && val->m_ObjectStart.m_Gen == s_MemberPool[ val->m_ObjectStart.m_Idx ].m_Gen )
-      {
-        uint32_t member_idx = val->m_ObjectStart.m_Idx;
-        uint32_t tmp_idx = 0;
-        while ( member_idx != kMemberIdxTail )
-        {
-          tmp_idcs[ tmp_idx++ ] = member_idx;
-          _gjMember* member = &s_MemberPool[ member_idx ];
-          member_idx = member->m_Next;
-        }
-      }
+    gj_dealSharedValues( partitions, thread_count, value_count - unused_value_count );
+  }
 
-      // sort the array by key name
-      gj_quickSortKeys( tmp_idcs, member_count );
+  for ( uint32_t i_thread = 1; i_thread < thread_count; ++i_thread )
+  {
+    threads[ i_thread ] = std::thread( gj_parseBatchWorker, &batch, &partitions[ i_thread ] );
+  }
+  gj_parseBatchWorker( &batch, &partitions[ 0 ] );
 
-      // relink
-      val->m_ObjectStart.m_Idx = tmp_idcs[ 0 ];
-      val->m_ObjectStart.m_Gen = s_MemberPool[ val->m_ObjectStart.m_Idx ].m_Gen;
+  for ( uint32_t i_thread = 1; i_thread < thread_count; ++i_thread )
+  {
+    threads[ i_thread ].join();
+  }
 
-      for ( uint32_t i_idc = 0; i_idc < member_count - 1; ++i_idc)
-      {
-        const uint32_t member_idx = tmp_idcs[ i_idc ];
-        s_MemberPool[ member_idx ].m_Next = tmp_idcs[ i_idc + 1 ];
-      }
+  // what nobody took goes back to never having been handed out
+  s_ValuePool.m_BumpIdx  = s_ValueSource.m_NextIdx;
+  s_MemberPool.m_BumpIdx = s_MemberSource.m_NextIdx;
+  s_ArrayArena.m_BumpIdx = s_ArraySource.m_NextIdx;
+  for ( uint32_t idx = values_bump; idx < values_start; ++idx )
+  {
+    gj_getValueSlot( idx )->m_Gen      = 0;
+    gj_getValueSlot( idx )->m_NextFree = s_ValuePoolHead;
+    s_ValuePoolHead = idx;
+  }
 
-      s_MemberPool[ tmp_idcs[ member_count - 1 ] ].m_Next = kMemberIdxTail;
+  for ( uint32_t i_thread = 0; i_thread < thread_count; ++i_thread )
+  {
+    gj_returnPartition( &partitions[ i_thread ] );
+  }
 
-      gj_free( tmp_idcs );
-    }
-    else
+  for ( uint32_t i_record = sampled_count; i_record < record_count; ++i_record )
+  {
+    _gjBatchRecord* record = &records[ i_record ];
+    if ( record->m_OutOfRoom )
     {
-      gj_assert( "Attempting to clear array on a value that isn't an array" );
+      record->m_Value = gj_parseBuffer( record->m_Json, record->m_JsonLen, false, base_depth );
     }
   }
-  else
-  {
-    gj_assert( "Attempting to clear array on a value that has been freed" );
-  }
 }
 
 //---------------------------------------------------------------------------------
-//
-// General controls
-// 
-//---------------------------------------------------------------------------------
-gjValue gj_makeArray()
+// Makes the array the records go into before they're parsed, so its run is taken while
+// the pool is least fragmented. Returns an invalid value if there's no room for it
+gjValue gj_makeBatchArray( uint32_t record_count )
 {
-  gjValue handle_val{};
-  if ( _gjValue* val = gj_allocValue( &handle_val.idx ) )
+  gjValue array = gj_makeArray();
+  if ( gj_isValueAlloced( array.idx, array.gen ) == false || record_count == 0 )
   {
-    handle_val.gen = val->m_Gen;
-    ASSIGN_VAL_TYPE( val, gjValueType::kArray );
-    ASSIGN_VAL_SUBTYPE( val, kGjSubValueTypeInvalid );
-    val->m_ArrayStart.m_Gen = (uint32_t)-1;
-    val->m_ArrayStart.m_Idx = (uint32_t)-1;
+    return array;
   }
-  return handle_val;
-}
 
-//---------------------------------------------------------------------------------
-gjValue gj_makeObject()
-{
-  gjValue handle_val{};
-  if ( _gjValue* val = gj_allocValue( &handle_val.idx ) )
+  const uint32_t run_idx = gj_allocArrayRun( (uint64_t)record_count + 1 );
+  if ( run_idx == kArrayIdxTail )
   {
-    handle_val.gen = val->m_Gen;
-    ASSIGN_VAL_TYPE( val, gjValueType::kObject );
-    ASSIGN_VAL_SUBTYPE( val, kGjSubValueTypeInvalid );
-    val->m_ObjectStart.m_Gen = (uint32_t)-1;
-    val->m_ObjectStart.m_Idx = (uint32_t)-1;
+    gj_assert( "Attempting to create array element, but the array pool is full. You may be out of memory" );
+    gj_deleteValue( array );
+    return gjValue();
   }
-  return handle_val;
+
+  gj_getValueSlot( array.idx )->m_Array.m_Idx = run_idx;
+  return array;
 }
 
 //---------------------------------------------------------------------------------
-void gj_deleteValue( gjValue val )
+// Moves the parsed records into the array, with null for the ones that failed
+void gj_fillBatchArray( gjValue array, const _gjBatchRecord* records, uint32_t record_count )
 {
-  if ( val.idx < s_Config.max_value_count && val.gen == s_ValuePool[val.idx].m_Gen )
+  _gjValue*     val   = gj_getValueSlot( array.idx );
+  _gjArrayElem* elems = gj_getArrayElems( val->m_Array );
+  for ( uint32_t i_record = 0; i_record < record_count; ++i_record )
   {
-    _gjValue* internal_val = &s_ValuePool[ val.idx ];
-    gj_freeValueData( internal_val );
-    gj_freeValue( val.idx );
+    const gjValue value = records[ i_record ].m_Value;
+    elems[ i_record ].m_Value = gj_isValueAlloced( value.idx, value.gen ) ? value : gj_makeParsedNull();
   }
+  val->m_Array.m_Count = record_count;
 }
 
 //---------------------------------------------------------------------------------
-uint32_t gj_getArrayElemFreeCount()
+gjValue gj_parseLines( const char* json_lines, size_t lines_len, uint32_t thread_count )
 {
-  uint32_t count = 0;
-  uint32_t idx = s_ArrayPoolHead;
-  while ( idx != kArrayIdxTail )
+  const char* end        = json_lines + lines_len;
+  size_t      line_count = 1;
+  for ( const char* cursor = json_lines; ( cursor = (const char*)memchr( cursor, '\n', (size_t)( end - cursor ) ) ) != nullptr; ++cursor )
   {
-    count++;
-    idx = s_ArrayPool[ idx ].m_Next;
+    line_count++;
   }
 
-  return count;
-}
+  if ( line_count > kPoolMaxCapacity )
+  {
+    gj_assert( "Attempting to parse more lines than an array can hold" );
+    return gjValue();
+  }
 
-//---------------------------------------------------------------------------------
-uint32_t gj_getObjectMemberFreeCount()
-{
-  uint32_t count = 0;
-  uint32_t idx = s_MemberPoolHead;
-  while ( idx != kMemberIdxTail )
+  _gjBatchRecord* records = (_gjBatchRecord*)gj_malloc( line_count * sizeof( _gjBatchRecord ), "gj: batch records" );
+  if ( records == nullptr )
   {
-    count++;
-    idx = s_MemberPool[ idx ].m_Next;
+    gj_assert( "Ran out of memory for the batch of lines. You may be out of memory" );
+    return gjValue();
   }
 
-  return count;
-}
+  // blank lines, including a trailing terminator, aren't records
+  uint32_t record_count = 0;
+  for ( const char* line = json_lines; line < end; )
+  {
+    const char* line_end = (const char*)memchr( line, '\n', (size_t)( end - line ) );
+    line_end = line_end != nullptr ? line_end : end;
 
-//---------------------------------------------------------------------------------
-uint32_t gj_getValueAllocedCount()
-{
-  uint32_t count = 0;
-  for ( uint32_t i_word = 0; i_word < s_ValueBitsetWordCount; ++i_word )
+    const char* first_char = s_SkipWhitespaceFn( line, line_end );
+    if ( first_char < line_end && *first_char != '\0' )
+    {
+      _gjBatchRecord* record = &records[ record_count++ ];
+      record->m_Json    = first_char;
+      record->m_JsonLen = (size_t)( line_end - first_char );
+    }
+    line = line_end + 1;
+  }
+
+  const gjValue lines = gj_makeBatchArray( record_count );
+  if ( gj_isValueAlloced( lines.idx, lines.gen ) && record_count > 0 )
   {
-    count += (uint32_t)__popcnt64( s_ValueBitset[i_word] );
+    gj_parseBatch( records, record_count, thread_count, 0 );
+    gj_fillBatchArray( lines, records, record_count );
   }
-  return count;
+
+  gj_free( records );
+  return lines;
 }
 
 //---------------------------------------------------------------------------------
-gjUsageStats gj_getUsageStats()
+bool gj_pushBatchRecord( _gjBatchRecord** io_records, uint32_t* io_record_count, uint32_t* io_record_capacity, const char* json, size_t json_len )
 {
-  gjUsageStats stats;
-  stats.m_FreeArrayElements = gj_getArrayElemFreeCount();
-  stats.m_UsedArrayElements = s_Config.max_value_count - stats.m_FreeArrayElements;
-  stats.m_FreeObjectMembers = gj_getObjectMemberFreeCount();
-  stats.m_UsedObjectMembers = s_Config.max_value_count - stats.m_FreeObjectMembers;
-  stats.m_UsedValues        = gj_getValueAllocedCount();
-  stats.m_FreeValues        = s_Config.max_value_count - stats.m_UsedValues;
+  if ( *io_record_count == *io_record_capacity )
+  {
+    const uint64_t new_capacity = (uint64_t)*io_record_capacity * 2;
+    if ( new_capacity > kPoolMaxCapacity )
+    {
+      gj_assert( "Attempting to parse more elements than an array can hold" );
+      return false;
+    }
 
-  return stats;
+    _gjBatchRecord* new_records = (_gjBatchRecord*)gj_malloc( new_capacity * sizeof( _gjBatchRecord ), "gj: batch records" );
+    if ( new_records == nullptr )
+    {
+      gj_assert( "Ran out of memory for the batch of elements. You may be out of memory" );
+      return false;
+    }
+
+    memcpy( new_records, *io_records, *io_record_count * sizeof( _gjBatchRecord ) );
+    gj_free( *io_records );
+    *io_records         = new_records;
+    *io_record_capacity = (uint32_t)new_capacity;
+  }
 
+  _gjBatchRecord* record = &( *io_records )[ ( *io_record_count )++ ];
+  record->m_Json    = json;
+  record->m_JsonLen = json_len;
+  return true;
 }
 
 //---------------------------------------------------------------------------------
-gjSerializeOptions gj_getDefaultSerializeOptions()
+// Splitting a big array has to keep up with several threads parsing it, so the text is
+// classified 64 characters at a time into bitmasks, where bit i stands for character i
+struct _gjBlockMasks
 {
-  gjSerializeOptions options;
-  options.mode          = gjSerializeMode::kPretty;
-  options.newline_style = gjNewlineStyle::kLinux;
-  options.indent_amt    = 2;
+  uint64_t m_Quotes;
+  uint64_t m_Backslashes;
+  uint64_t m_Structurals; // brackets, commas and null terminators
+};
 
-  return options;
-}
+#ifdef GJ_SIMD_X64
 
 //---------------------------------------------------------------------------------
-gjSerializer::gjSerializer( gjValue obj_to_serialize, gjSerializeOptions* options )
-: m_Obj( obj_to_serialize )
-, m_Options( options ? *options : gj_getDefaultSerializeOptions() )
-, m_StringData( nullptr )
+void gj_classifyBlock( const char* block, _gjBlockMasks* out_masks )
 {
+  const __m128i bit5        = _mm_set1_epi8( 0x20 );
+  const __m128i open_brace  = _mm_set1_epi8( '{' );
+  const __m128i close_brace = _mm_set1_epi8( '}' );
+  const __m128i comma       = _mm_set1_epi8( ',' );
+  const __m128i quote       = _mm_set1_epi8( '"' );
+  const __m128i backslash   = _mm_set1_epi8( '\\' );
+  const __m128i zero        = _mm_setzero_si128();
+
+  out_masks->m_Quotes      = 0;
+  out_masks->m_Backslashes = 0;
+  out_masks->m_Structurals = 0;
+  for ( uint32_t i_lane = 0; i_lane < 4; ++i_lane )
+  {
+    const __m128i chars       = _mm_loadu_si128( (const __m128i*)( block + i_lane * 16 ) );
+    const __m128i folded      = _mm_or_si128( chars, bit5 );
+    const __m128i structurals = _mm_or_si128( _mm_or_si128( _mm_cmpeq_epi8( folded, open_brace ), _mm_cmpeq_epi8( folded, close_brace ) ),
+                                              _mm_or_si128( _mm_cmpeq_epi8( chars, comma ), _mm_cmpeq_epi8( chars, zero ) ) );
+
+    const uint32_t shift = i_lane * 16;
+    out_masks->m_Quotes      |= (uint64_t)(uint32_t)_mm_movemask_epi8( _mm_cmpeq_epi8( chars, quote ) ) << shift;
+    out_masks->m_Backslashes |= (uint64_t)(uint32_t)_mm_movemask_epi8( _mm_cmpeq_epi8( chars, backslash ) ) << shift;
+    out_masks->m_Structurals |= (uint64_t)(uint32_t)_mm_movemask_epi8( structurals ) << shift;
+  }
 }
 
+#else
+
 //---------------------------------------------------------------------------------
-gjSerializer::~gjSerializer()
+void gj_classifyBlock( const char* block, _gjBlockMasks* out_masks )
 {
-  if ( m_StringData != nullptr )
+  out_masks->m_Quotes      = 0;
+  out_masks->m_Backslashes = 0;
+  out_masks->m_Structurals = 0;
+  for ( uint32_t i_char = 0; i_char < 64; ++i_char )
   {
-    gj_free( m_StringData );
+    const char     c   = block[ i_char ];
+    const uint64_t bit = 1ull << i_char;
+    out_masks->m_Quotes      |= c == '"'  ? bit : 0;
+    out_masks->m_Backslashes |= c == '\\' ? bit : 0;
+    out_masks->m_Structurals |= ( c | 0x20 ) == '{' || ( c | 0x20 ) == '}' || c == ',' || c == '\0' ? bit : 0;
   }
 }
 
-//---------------------------------------------------------------------------------
-constexpr const char* kNewlineStrings[] = {
-  "\r\n",
-  "\n"
-};
-static_assert( sizeof( kNewlineStrings ) / sizeof( *kNewlineStrings ) == (size_t)gjNewlineStyle::kCount, "The must stay in sync" );
-
-
-//---------------------------------------------------------------------------------
-constexpr size_t kNewlineLens[] = {
-  2,
-  1
-};
-static_assert( sizeof( kNewlineLens ) / sizeof( *kNewlineLens ) == (size_t)gjNewlineStyle::kCount, "The must stay in sync" );
+#endif
 
 //---------------------------------------------------------------------------------
-size_t gj_getJsonSizeforCString( const char* cstring )
+// Returns which characters of a block are inside strings. io_in_string is all ones if
+// the block starts inside a string, and io_escaped is 1 if its first character is
+// escaped by a backslash at the end of the block before. Both are updated for the next.
+uint64_t gj_findStringBits( const _gjBlockMasks* masks, uint64_t* io_in_string, uint64_t* io_escaped )
 {
-  size_t sz = 0;
-  for ( uint32_t i_char = 0; cstring[ i_char ] != '\0'; ++i_char, ++sz )
+  // backslashes are rare, so they're worked through one at a time
+  uint64_t escaped     = *io_escaped;
+  uint64_t backslashes = masks->m_Backslashes;
+  *io_escaped = 0;
+  while ( backslashes != 0 )
   {
-    sz += cstring[i_char + 1] == '\r'
-       || cstring[i_char + 1] == '\n'
-       || cstring[i_char + 1] == '\t'
-       || cstring[i_char + 1] == '\b'
-       || cstring[i_char + 1] == '\f'
-       || cstring[i_char + 1] == '\\'
-       || cstring[i_char + 1] == '/'
-       || cstring[i_char + 1] == '"';
+    const uint64_t backslash = backslashes & ( 0 - backslashes );
+    backslashes ^= backslash;
+    if ( ( escaped & backslash ) == 0 )
+    {
+      escaped    |= backslash << 1;
+      *io_escaped = backslash >> 63;
+    }
   }
 
-  return sz;
+  // a running xor of the quotes is set from each opening quote up to its closing one
+  uint64_t in_string = masks->m_Quotes & ~escaped;
+  in_string ^= in_string << 1;
+  in_string ^= in_string << 2;
+  in_string ^= in_string << 4;
+  in_string ^= in_string << 8;
+  in_string ^= in_string << 16;
+  in_string ^= in_string << 32;
+  in_string ^= *io_in_string;
+
+  *io_in_string = 0 - ( in_string >> 63 );
+  return in_string;
 }
 
 //---------------------------------------------------------------------------------
-size_t gj_getRequiredSerializedSize( gjValue val_handle, gjSerializeOptions* options, size_t indent_amt = 0 )
+// Finds the elements of the array that opens at array_start, each running from just
+// after the '[' or ',' before it to the ',' or ']' after it, whitespace and all. Only
+// brackets and strings are checked here, the elements are checked when they're parsed.
+bool gj_splitArray( const char* array_start, const char* end, _gjBatchRecord** io_records, uint32_t* io_record_count, uint32_t* io_record_capacity, const char** out_array_end )
 {
-  const size_t newline_len    = options->mode == gjSerializeMode::kPretty ? kNewlineLens[ (uint32_t)options->newline_style ] : 0;
-  const size_t new_indent_amt = options->mode == gjSerializeMode::kPretty ? abs( options->indent_amt )                       : 0;
-
-  if ( gj_isValueAlloced( val_handle.idx, val_handle.gen ) )
+  char        tail_block[ 64 ];
+  const char* elem_start = array_start + 1;
+  uint32_t    depth      = 0;
+  uint64_t    in_string  = 0;
+  uint64_t    escaped    = 0;
+  for ( const char* block = array_start; block < end; block += 64 )
   {
-    _gjValue* val = &s_ValuePool[ val_handle.idx ];
-    switch ( VAL_TYPE( val ) )
-    {
-    case gjValueType::kNull:
+    const char* chars = block;
+    if ( end - block < 64 )
     {
-      return 4; // null
+      memset( tail_block, ' ', sizeof( tail_block ) );
+      memcpy( tail_block, block, (size_t)( end - block ) );
+      chars = tail_block;
     }
-    case gjValueType::kObject:
+
+    _gjBlockMasks masks;
+    gj_classifyBlock( chars, &masks );
+
+    uint64_t structurals = masks.m_Structurals & ~gj_findStringBits( &masks, &in_string, &escaped );
+    while ( structurals != 0 )
     {
-      const size_t local_indent_amt = indent_amt + new_indent_amt;
-      size_t sz = 1 + newline_len; // {
+      const uint32_t i_char = gj_Bsr( structurals & ( 0 - structurals ) );
+      const char*    cursor = block + i_char;
+      structurals &= structurals - 1;
 
-      if ( val->m_ObjectStart.m_Idx < s_Config.max_value_count )
+      switch ( chars[ i_char ] )
       {
-        _gjMember* member = &s_MemberPool[ val->m_ObjectStart.m_Idx ];
-        if ( member->m_Gen == val->m_ObjectStart.m_Gen )
+        case ',':
         {
-          while ( member->m_Next != kMemberIdxTail )
+          if ( depth == 1 )
           {
-            sz += local_indent_amt + (options->mode == gjSerializeMode::kMinified ? 3 : 5) + gj_getJsonSizeforCString( member->m_KeyStr ); // "<key>" : 
-            sz += gj_getRequiredSerializedSize( member->m_Value, options, local_indent_amt );
-            sz += 1 + newline_len; // ,
-
-            member = &s_MemberPool[ member->m_Next ];
+            if ( gj_pushBatchRecord( io_records, io_record_count, io_record_capacity, elem_start, (size_t)( cursor - elem_start ) ) == false )
+            {
+              return false;
+            }
+            elem_start = cursor + 1;
           }
-          sz += local_indent_amt + (options->mode == gjSerializeMode::kMinified ? 3 : 5) + gj_getJsonSizeforCString( member->m_KeyStr ); // "<key>" : 
-          sz += gj_getRequiredSerializedSize( member->m_Value, options, local_indent_amt );
-          sz += newline_len;
+          break;
         }
-        else
+        case '{':
+        case '[':
         {
-          gj_assert( "attempting to serialize an object member that has been freed" );
+          // too deep is caught here, before any element is parsed
+          if ( s_Config.max_depth != 0 && depth >= s_Config.max_depth )
+          {
+            gj_assert( "json data is nested deeper than the max_depth it was configured with" );
+            return false;
+          }
+          depth++;
+          break;
         }
-      }
-      sz += indent_amt + 1; // }
-      return sz;
-    }
-    case gjValueType::kArray:
-    {
-      size_t sz = 1; // [
-
-      if ( val->m_ArrayStart.m_Idx == kArrayIdxTail )
-      {
-        sz += 1; // ]
-        return sz;
-      }
-
-      sz += newline_len;
-
-      _gjArrayElem* elem = &s_ArrayPool[ val->m_ArrayStart.m_Idx ];
-      if ( elem->m_Gen == val->m_ArrayStart.m_Gen )
-      {
-        const size_t local_indent_amt = indent_amt + new_indent_amt;
-        while ( elem->m_Next != kArrayIdxTail )
+        case '}':
+        case ']':
         {
-          sz += local_indent_amt + newline_len + 1; // ,
-          sz += gj_getRequiredSerializedSize( elem->m_Value, options, local_indent_amt );
-          elem = &s_ArrayPool[ elem->m_Next ];
-        }
+          if ( --depth > 0 )
+          {
+            break;
+          }
 
-        sz += local_indent_amt + newline_len;
-        sz += gj_getRequiredSerializedSize( elem->m_Value, options, local_indent_amt );
-      }
-      else
-      {
-        gj_assert( "attempting to serialize an array element that has been freed" );
-      }
+          if ( *cursor != ']' )
+          {
+            gj_assert( "Unexpected token!" );
+            return false;
+          }
 
-      sz += indent_amt + newline_len + 1; // ]
-      return sz;
-    }
-    case gjValueType::kString:
-    {
-      return 2 + gj_getJsonSizeforCString( val->m_Str ); // "<string>"
-    }
-    case gjValueType::kNumber:
-    {
-      switch ( VAL_SUBTYPE( val ) )
-      {
-        case kGjSubValueTypeInt:
-        {
-          return 11;
-        }
-        break;
-        case kGjSubValueTypeU64:
-        {
-          return 20;
+          // only an empty array has nothing at all between its brackets
+          const bool is_empty = *io_record_count == 0 && s_SkipWhitespaceFn( elem_start, cursor ) == cursor;
+          if ( is_empty == false && gj_pushBatchRecord( io_records, io_record_count, io_record_capacity, elem_start, (size_t)( cursor - elem_start ) ) == false )
+          {
+            return false;
+          }
+
+          *out_array_end = cursor + 1;
+          return true;
         }
-        break;
-        case kGjSubValueTypeFloat:
+        default:
         {
-          return 20; // todo: this is likely not correct
+          // a null terminator ends the data before the array was closed
+          gj_assert( "Unexpected end of the json data!" );
+          return false;
         }
-        break;
       }
     }
-    case gjValueType::kBool:
-    {
-      return val->m_Bool ? 4 : 5;
-    }
-    default:
-      gj_assert( "Attempt to serialize unknown type!" );
-    }
-  }
-  else
-  {
-    gj_assert( "attempting to serialize freed value" );
   }
 
-  return 0;
+  gj_assert( "Unexpected end of the json data!" );
+  return false;
 }
 
 //---------------------------------------------------------------------------------
-char* gj_addIndent( char* cursor, size_t amt, bool use_tabs )
+// The elements of the top-level array are found by gj_splitArray and parsed as a batch.
+// A document whose root isn't an array is parsed on this thread.
+gjValue gj_parseParallel( const char* json_string, size_t string_len, uint32_t thread_count )
 {
-  for ( size_t i_char = 0; i_char < amt; ++i_char )
+  const char* end         = json_string + string_len;
+  const char* array_start = s_SkipWhitespaceFn( json_string, end );
+  if ( array_start == end || *array_start != '[' )
   {
-    *cursor = use_tabs ? '\t' : ' ';
-    cursor++;
+    return gj_parseBuffer( json_string, string_len, false, 0 );
+  }
+
+  uint32_t        record_count    = 0;
+  uint32_t        record_capacity = 1024;
+  _gjBatchRecord* records         = (_gjBatchRecord*)gj_malloc( record_capacity * sizeof( _gjBatchRecord ), "gj: batch records" );
+  if ( records == nullptr )
+  {
+    gj_assert( "Ran out of memory for the batch of elements. You may be out of memory" );
+    return gjValue();
+  }
+
+  const char* array_end;
+  bool        is_valid = gj_splitArray( array_start, end, &records, &record_count, &record_capacity, &array_end );
+  if ( is_valid )
+  {
+    const char* after_array = s_SkipWhitespaceFn( array_end, end );
+    if ( after_array != end && *after_array != '\0' )
+    {
+      gj_assert( "Unexpected token after the end of the json data!" );
+      is_valid = false;
+    }
+  }
+
+  gjValue array = is_valid ? gj_makeBatchArray( record_count ) : gjValue();
+  if ( gj_isValueAlloced( array.idx, array.gen ) && record_count > 0 )
+  {
+    // the elements are inside the root array
+    gj_parseBatch( records, record_count, thread_count, 1 );
+
+    // like gj_parse, one bad element fails the whole document
+    for ( uint32_t i_record = 0; i_record < record_count && is_valid; ++i_record )
+    {
+      is_valid = gj_isValueAlloced( records[ i_record ].m_Value.idx, records[ i_record ].m_Value.gen );
+    }
+
+    if ( is_valid )
+    {
+      gj_fillBatchArray( array, records, record_count );
+    }
+    else
+    {
+      for ( uint32_t i_record = 0; i_record < record_count; ++i_record )
+      {
+        gj_deleteValue( records[ i_record ].m_Value );
+      }
+      gj_deleteValue( array );
+      array = gjValue();
+    }
   }
-  return cursor;
+
+  gj_free( records );
+  return array;
 }
 
 //---------------------------------------------------------------------------------
-char* gj_addChars( char* cursor, const char* src, size_t len )
+// Projection paths are compiled into a tree of their tokens, so paths that share a
+// prefix share nodes. While the document is read, each value is matched against the set
+// of nodes the paths could be at there. Wildcards and explicit indices or keys can both
+// match the same value, which is why it's a set rather than a single node.
+struct _gjProjectionNode
 {
-  memcpy( cursor, src, len );
-  return cursor + len;
-}
+  const char* m_Token;       // unescaped
+  uint32_t    m_TokenLen;
+  uint32_t    m_Index;       // the token as an array index, or kArrayIndexEnd if it isn't one
+  uint32_t    m_FirstChild;
+  uint32_t    m_NextSibling;
+  bool        m_IsWildcard;
+  bool        m_IsLeaf;      // a path ends here, so the whole value is kept
+};
 
 //---------------------------------------------------------------------------------
-char* gj_addCString( char* cursor, const char* src, size_t src_len )
+static constexpr uint32_t kProjectionNodeNone = (uint32_t)-1;
+
+//---------------------------------------------------------------------------------
+struct _gjProjection
+{
+  _gjProjectionNode* m_Nodes;
+  uint32_t           m_NodeCount;
+  uint32_t*          m_NodeSets; // a set of m_NodeCount entries for each level of the tree
+  void*              m_Allocation;
+};
+
+//---------------------------------------------------------------------------------
+// returns the node under parent_idx for the token, adding it if there isn't one yet
+uint32_t gj_findProjectionChild( _gjProjection* projection, uint32_t parent_idx, const char* token, uint32_t token_len )
 {
-  uint32_t offset = 0;
-  for ( uint32_t i_char = 0; i_char < src_len + offset; ++i_char )
+  _gjProjectionNode* parent    = &projection->m_Nodes[ parent_idx ];
+  uint32_t*          child_ref = &parent->m_FirstChild;
+  while ( *child_ref != kProjectionNodeNone )
   {
-    switch( src[ i_char ] )
-    {
-    case '\\':
-    case '/':
-    case '"':
-    {
-      cursor[ i_char + offset++ ] = '\\';
-      cursor[ i_char + offset   ] = src[ i_char ];
-    }
-    break;
-    case '\n':
-    {
-      cursor[ i_char + offset++ ] = '\\';
-      cursor[ i_char + offset   ] = 'n';
-    }
-    break;
-    case '\r':
+    const _gjProjectionNode* child = &projection->m_Nodes[ *child_ref ];
+    if ( child->m_TokenLen == token_len && memcmp( child->m_Token, token, token_len ) == 0 )
     {
-      cursor[ i_char + offset++ ] = '\\';
-      cursor[ i_char + offset   ] = 'r';
+      return *child_ref;
     }
-    break;
-    case '\b':
-    {
-      cursor[ i_char + offset++ ] = '\\';
-      cursor[ i_char + offset   ] = 'b';
-    }
-    break;
-    case '\f':
-    {
-      cursor[ i_char + offset++ ] = '\\';
-      cursor[ i_char + offset   ] = 'f';
-    }
-    break;
-    case '\t':
+    child_ref = &projection->m_Nodes[ *child_ref ].m_NextSibling;
+  }
+
+  const uint32_t     child_idx = projection->m_NodeCount++;
+  _gjProjectionNode* child     = &projection->m_Nodes[ child_idx ];
+  child->m_Token       = token;
+  child->m_TokenLen    = token_len;
+  child->m_Index       = kArrayIndexEnd;
+  child->m_FirstChild  = kProjectionNodeNone;
+  child->m_NextSibling = kProjectionNodeNone;
+  child->m_IsWildcard  = token_len == 1 && token[ 0 ] == '*';
+  child->m_IsLeaf      = false;
+
+  // indices are plain digits without leading zeros, as in json pointers
+  if ( token_len > 0 && token_len <= 10 && ( token[ 0 ] != '0' || token_len == 1 ) )
+  {
+    uint64_t index = 0;
+    for ( uint32_t i_char = 0; i_char < token_len && index != kArrayIndexEnd; ++i_char )
     {
-      cursor[ i_char + offset++ ] = '\\';
-      cursor[ i_char + offset   ] = 't';
-    }
-    break;
-    default:
-      cursor[ i_char + offset ] =  src[ i_char ];
+      index = gj_isDigit( token[ i_char ] ) ? index * 10 + (uint64_t)( token[ i_char ] - '0' ) : kArrayIndexEnd;
     }
+    child->m_Index = index < kArrayIndexEnd ? (uint32_t)index : kArrayIndexEnd;
   }
 
-  return cursor + src_len + offset;
+  *child_ref = child_idx;
+  return child_idx;
 }
 
 //---------------------------------------------------------------------------------
-char* gj_serialize( char* cursor, gjValue val_handle, gjSerializeOptions* options, size_t indent_amt = 0 )
+bool gj_compileProjection( const char* const* paths, uint32_t path_count, _gjProjection* out_projection )
 {
-  const char*  newline_str    = options->mode == gjSerializeMode::kPretty ? kNewlineStrings[ (uint32_t)options->newline_style ] : "";
-  const size_t newline_len    = options->mode == gjSerializeMode::kPretty ? kNewlineLens   [ (uint32_t)options->newline_style ] : 0;
-  const bool   using_tabs     = options->mode == gjSerializeMode::kPretty ? options->indent_amt == -1                           : 0;
-  const size_t new_indent_amt = options->mode == gjSerializeMode::kPretty ? abs( options->indent_amt )                          : 0;
-
-  if ( gj_isValueAlloced( val_handle.idx, val_handle.gen ) )
+  // every '/' starts a token, so they bound the nodes and the token text
+  size_t total_len   = 0;
+  size_t token_count = 0;
+  for ( uint32_t i_path = 0; i_path < path_count; ++i_path )
   {
-    _gjValue* val = &s_ValuePool[ val_handle.idx ];
-    switch ( VAL_TYPE( val ) )
+    const size_t path_len = strlen( paths[ i_path ] );
+    if ( path_len > 0 && paths[ i_path ][ 0 ] != '/' )
     {
-    case gjValueType::kNull:
-    {
-      return gj_addChars( cursor, "null", 4 );
+      gj_assert( "Projection paths must be empty or start with '/'" );
+      return false;
     }
-    case gjValueType::kObject:
+
+    total_len += path_len;
+    for ( size_t i_char = 0; i_char < path_len; ++i_char )
     {
-      const size_t local_indent_amt = indent_amt + new_indent_amt;
-      cursor = gj_addChars( cursor, "{",          1           );
-      cursor = gj_addChars( cursor,  newline_str, newline_len );
+      token_count += paths[ i_path ][ i_char ] == '/';
+    }
+  }
 
-      if (val->m_ObjectStart.m_Idx < s_Config.max_value_count)
-      {
+  if ( token_count >= kProjectionNodeNone / ( token_count + 2 ) )
+  {
+    gj_assert( "Attempting to project too many paths" );
+    return false;
+  }
+
+  const size_t node_count = token_count + 1;
+  const size_t nodes_size = node_count * sizeof( _gjProjectionNode );
+  const size_t sets_size  = node_count * ( node_count + 1 ) * sizeof( uint32_t );
+  char*        allocation = (char*)gj_malloc( nodes_size + sets_size + total_len, "gj: projection" );
+  if ( allocation == nullptr )
+  {
+    gj_assert( "Ran out of memory for the projection. You may be out of memory" );
+    return false;
+  }
 
-        _gjMember* member = &s_MemberPool[ val->m_ObjectStart.m_Idx ];
-        if ( member->m_Gen == val->m_ObjectStart.m_Gen )
+  out_projection->m_Allocation = allocation;
+  out_projection->m_Nodes      = (_gjProjectionNode*)allocation;
+  out_projection->m_NodeSets   = (uint32_t*)( allocation + nodes_size );
+  out_projection->m_NodeCount  = 1;
+
+  _gjProjectionNode* root = &out_projection->m_Nodes[ 0 ];
+  root->m_Token       = "";
+  root->m_TokenLen    = 0;
+  root->m_Index       = kArrayIndexEnd;
+  root->m_FirstChild  = kProjectionNodeNone;
+  root->m_NextSibling = kProjectionNodeNone;
+  root->m_IsWildcard  = false;
+  root->m_IsLeaf      = false;
+
+  char* token_chars = allocation + nodes_size + sets_size;
+  for ( uint32_t i_path = 0; i_path < path_count; ++i_path )
+  {
+    uint32_t    node_idx = 0;
+    const char* cursor   = paths[ i_path ];
+    while ( *cursor == '/' )
+    {
+      // ~1 and ~0 stand for '/' and '~'
+      char* token = token_chars;
+      for ( cursor++; *cursor != '/' && *cursor != '\0'; ++cursor )
+      {
+        char c = *cursor;
+        if ( c == '~' )
         {
-          while ( member->m_Next != kMemberIdxTail )
+          c = cursor[ 1 ] == '1' ? '/' : cursor[ 1 ] == '0' ? '~' : '\0';
+          if ( c == '\0' )
           {
-            cursor = gj_addIndent ( cursor, local_indent_amt, using_tabs                    );
-            cursor = gj_addChars  ( cursor, "\"",             1                             );
-            cursor = gj_addCString( cursor, member->m_KeyStr, gj_StrLen( member->m_KeyStr ) );
-            cursor = gj_addChars  ( cursor, options->mode == gjSerializeMode::kMinified ? "\":" : "\" : ", 
-                                            options->mode == gjSerializeMode::kMinified ? 2     : 4 );
-
-            cursor = gj_serialize ( cursor, member->m_Value, options, local_indent_amt );
-            cursor = gj_addChars  ( cursor, ",",              1           );
-            cursor = gj_addChars  ( cursor, newline_str,      newline_len );
-
-            member = &s_MemberPool[ member->m_Next ];
+            gj_free( allocation );
+            gj_assert( "Projection paths can only use '~' in ~0 or ~1" );
+            return false;
           }
+          cursor++;
+        }
+        *token_chars++ = c;
+      }
 
-          cursor = gj_addIndent ( cursor, local_indent_amt, using_tabs                    );
-          cursor = gj_addChars  ( cursor, "\"",             1                             );
-          cursor = gj_addCString( cursor, member->m_KeyStr, gj_StrLen( member->m_KeyStr ) );
-          cursor = gj_addChars  ( cursor, options->mode == gjSerializeMode::kMinified ? "\":" : "\" : ", 
-                                          options->mode == gjSerializeMode::kMinified ? 2     : 4 );
+      node_idx = gj_findProjectionChild( out_projection, node_idx, token, (uint32_t)( token_chars - token ) );
+    }
 
-          cursor = gj_serialize ( cursor, member->m_Value, options, local_indent_amt );
-          cursor = gj_addChars  ( cursor, newline_str,      newline_len );
-        }
-        else
-        {
-          gj_assert( "attempting to serialize an object member that has been freed" );
-        }
+    out_projection->m_Nodes[ node_idx ].m_IsLeaf = true;
+  }
 
-      }
+  return true;
+}
 
-      cursor = gj_addIndent( cursor, indent_amt,  using_tabs );
-      cursor = gj_addChars ( cursor, "}",         1          );
-      return cursor;
+//---------------------------------------------------------------------------------
+// Adds the children of the nodes in node_set that match a member key or an element
+// index to out_set. Keys are compared still escaped
+uint32_t gj_matchProjectionNodes( const _gjProjection* projection, const uint32_t* node_set, uint32_t node_count,
+                                  const char* key_str, const char* key_end, uint32_t escape_count, uint32_t elem_idx, uint32_t* out_set )
+{
+  uint32_t match_count = 0;
+  for ( uint32_t i_node = 0; i_node < node_count; ++i_node )
+  {
+    for ( uint32_t child_idx = projection->m_Nodes[ node_set[ i_node ] ].m_FirstChild; child_idx != kProjectionNodeNone; child_idx = projection->m_Nodes[ child_idx ].m_NextSibling )
+    {
+      const _gjProjectionNode* child = &projection->m_Nodes[ child_idx ];
+      const bool is_match = child->m_IsWildcard
+                         || ( key_str != nullptr ? gj_lazyKeyEquals( key_str, key_end, escape_count, child->m_Token, child->m_TokenLen )
+                                                 : child->m_Index == elem_idx );
+      if ( is_match )
+      {
+        out_set[ match_count++ ] = child_idx;
+      }
     }
-    case gjValueType::kArray:
+  }
+  return match_count;
+}
+
+//---------------------------------------------------------------------------------
+// Parses the value at the cursor, keeping only what the paths at node_set reach. A value
+// the paths step into that isn't an object or array becomes null. On failure nothing
+// is left allocated
+bool gj_projectValue( const _gjProjection* projection, _gjParseContext* ctx, const uint32_t* node_set, uint32_t node_count, uint32_t level, gjValue* out_value )
+{
+  const char* value_start = ctx->m_Cursor;
+  for ( uint32_t i_node = 0; i_node < node_count; ++i_node )
+  {
+    if ( projection->m_Nodes[ node_set[ i_node ] ].m_IsLeaf )
     {
-      cursor = gj_addChars( cursor, "[", 1 );
-      if ( val->m_ArrayStart.m_Idx == kArrayIdxTail )
+      if ( gj_skipLazyValue( ctx ) == false )
       {
-        cursor = gj_addChars( cursor, "]", 1 );
-        return cursor;
+        return false;
       }
 
-      cursor = gj_addChars( cursor, newline_str, newline_len );
+      *out_value = gj_parseBuffer( value_start, (size_t)( ctx->m_Cursor - value_start ), false, 0 );
+      return gj_isValueAlloced( out_value->idx, out_value->gen );
+    }
+  }
 
-      _gjArrayElem* elem = &s_ArrayPool[ val->m_ArrayStart.m_Idx ];
-      if ( elem->m_Gen == val->m_ArrayStart.m_Gen )
-      {
-        const size_t local_indent_amt = indent_amt + new_indent_amt;
-        while ( elem->m_Next != kArrayIdxTail )
-        {
-          cursor = gj_addIndent( cursor, local_indent_amt, using_tabs );
-          cursor = gj_serialize( cursor, elem->m_Value, options, local_indent_amt );
-          cursor = gj_addChars ( cursor, ",", 1 );
-          cursor = gj_addChars ( cursor, newline_str, newline_len );
+  const char open_char = gj_peekChar( ctx );
+  if ( open_char != '{' && open_char != '[' )
+  {
+    // the null is only made once the value turns out to be well-formed
+    if ( gj_skipLazyValue( ctx ) == false )
+    {
+      return false;
+    }
 
-          elem = &s_ArrayPool[ elem->m_Next ];
-        }
+    *out_value = gj_makeParsedNull();
+    return gj_isValueAlloced( out_value->idx, out_value->gen );
+  }
 
-        cursor = gj_addIndent( cursor, local_indent_amt, using_tabs );
-        cursor = gj_serialize( cursor, elem->m_Value, options, local_indent_amt );
-        cursor = gj_addChars ( cursor, newline_str, newline_len );
-      }
-      else
-      {
-        gj_assert( "attempting to serialize an array element that has been freed" );
-      }
+  const bool in_object = open_char == '{';
+  *out_value = in_object ? gj_makeObject() : gj_makeArray();
+  if ( gj_isValueAlloced( out_value->idx, out_value->gen ) == false )
+  {
+    return false;
+  }
 
-      cursor = gj_addIndent( cursor, indent_amt, using_tabs );
-      cursor = gj_addChars ( cursor, "]",        1          );
-      return cursor;
-    }
-    case gjValueType::kString:
+  uint32_t* child_set = projection->m_NodeSets + ( level + 1 ) * projection->m_NodeCount;
+  uint32_t  elem_idx  = 0;
+  bool      has_value;
+  gj_enterLazyContainer( ctx, in_object ? '}' : ']', &has_value );
+  while ( has_value )
+  {
+    const char* key_start    = ctx->m_Cursor;
+    const char* key_str      = nullptr;
+    const char* key_end      = nullptr;
+    uint32_t    escape_count = 0;
+    if ( in_object && gj_readLazyKey( ctx, &key_str, &key_end, &escape_count ) == false )
     {
-      cursor = gj_addChars  ( cursor, "\"", 1 );
-      cursor = gj_addCString( cursor, val->m_Str, gj_StrLen( val->m_Str ) );
-      cursor = gj_addChars  ( cursor, "\"", 1 );
-      return cursor;
+      gj_deleteValue( *out_value );
+      return false;
     }
-    case gjValueType::kNumber:
+
+    const uint32_t child_count = gj_matchProjectionNodes( projection, node_set, node_count, key_str, key_end, escape_count, elem_idx++, child_set );
+    if ( child_count > 0 )
     {
-      switch ( VAL_SUBTYPE( val ) )
+      // a key that's kept is read again, to be decoded the way the parser always does
+      char*    kept_key = nullptr;
+      uint32_t key_hash = 0;
+      if ( in_object )
       {
-        case kGjSubValueTypeInt:
-        {
-          snprintf( cursor, 10, "%d", val->m_Int );
-          return cursor + gj_StrLen( cursor );
-        }
-        break;
-        case kGjSubValueTypeU64:
+        ctx->m_Cursor = key_start;
+        if ( gj_parseKey( ctx, &kept_key, &key_hash ) == false )
         {
-          snprintf( cursor, 20, "%llu", val->m_U64 );
-          return cursor + gj_StrLen( cursor );
+          gj_deleteValue( *out_value );
+          return false;
         }
-        break;
-        case kGjSubValueTypeFloat:
+        gj_skipWhitespace( ctx );
+      }
+
+      gjValue child;
+      if ( gj_projectValue( projection, ctx, child_set, child_count, level + 1, &child ) == false )
+      {
+        if ( kept_key != nullptr )
         {
-          snprintf( cursor, 20, "%0.18f", val->m_Float );
-          return cursor + gj_StrLen( cursor );
+          gj_freeParsedString( ctx, kept_key );
         }
-        break;
+        gj_deleteValue( child );
+        gj_deleteValue( *out_value );
+        return false;
       }
-    }
-    case gjValueType::kBool:
-    {
-      if ( val->m_Bool )
+
+      if ( gj_attachParsedValue( out_value->idx, kept_key, key_hash, child ) == false )
       {
-        return gj_addChars( cursor, "true", 4 );
+        if ( kept_key != nullptr )
+        {
+          gj_freeParsedString( ctx, kept_key );
+        }
+        gj_deleteValue( child );
+        gj_deleteValue( *out_value );
+        return false;
       }
-      else
+
+      // the value was already read, so this only moves on to the next one
+      if ( gj_readLazySeparator( ctx, in_object ? '}' : ']', &has_value ) == false )
       {
-        return gj_addChars( cursor, "false", 5 );
+        gj_deleteValue( *out_value );
+        return false;
       }
     }
-    default:
-      gj_assert( "Attempt to serialize unknown type!" );
+    else if ( gj_nextLazyContainerValue( ctx, in_object ? '}' : ']', &has_value ) == false )
+    {
+      gj_deleteValue( *out_value );
+      return false;
     }
   }
-  else
-  {
-    gj_assert( "attempting to serialize freed value" );
-  }
 
-  return nullptr;
+  return true;
 }
 
 //---------------------------------------------------------------------------------
-void gjSerializer::serialize()
+gjValue gj_parseProjected( const char* json_string, size_t string_len, const char* const* paths, uint32_t path_count )
 {
-  // gather the size needed
-  size_t str_sz = gj_getRequiredSerializedSize( m_Obj, &m_Options ) + 1;
-  if ( m_StringData != nullptr )
+  _gjProjection projection;
+  if ( gj_compileProjection( paths, path_count, &projection ) == false )
   {
-    gj_free( m_StringData );
+    return gjValue();
   }
 
-  m_StringData = (char*)gj_malloc( str_sz, "Serialized string data" );
-  char* cursor = m_StringData;
-  cursor = gj_serialize( cursor, m_Obj, &m_Options );
-  *cursor = '\0';
-}
-
-//---------------------------------------------------------------------------------
-const char* gjSerializer::getString()
-{
-  return m_StringData ? m_StringData : "";
-}
-
-//---------------------------------------------------------------------------------
-enum _gjLexSymType : uint16_t
-{
-  kSymOpenBrace,
-  kSymClosedBrace,
-  kSymComma,
-  kSymColon,
-  kSymOpenBracket,
-  kSymClosedBracket,
-  kSymString,
-  kSymFloat,
-  kSymInt,
-  kSymU64,
-  kSymBool,
-  kSymNull,
+  gjLazyValue     root;
+  _gjParseContext ctx;
+  root.cursor = json_string;
+  root.end    = json_string + string_len;
+  gj_initLazyContext( &ctx, &root );
+  gj_skipWhitespace( &ctx );
 
-  kSymCount
-};
+  gjValue value;
+  projection.m_NodeSets[ 0 ] = 0;
+  if ( gj_projectValue( &projection, &ctx, projection.m_NodeSets, 1, 0, &value ) )
+  {
+    gj_skipWhitespace( &ctx );
+    if ( gj_peekChar( &ctx ) != '\0' )
+    {
+      gj_assert( "Unexpected token after the end of the json data!" );
+      gj_deleteValue( value );
+      value = gjValue();
+    }
+  }
+  else
+  {
+    gj_deleteValue( value );
+    value = gjValue();
+  }
 
-//---------------------------------------------------------------------------------
-struct _gjLexSym
-{
-  const char*    m_Str;
-  uint16_t       m_StrLen;
-  _gjLexSymType  m_Type;
-};
+  gj_free( projection.m_Allocation );
+  return value;
+}
 
 //---------------------------------------------------------------------------------
-struct _gjLexContext
+struct _gjValidateContext
 {
   const char* m_Cursor;
-  _gjLexSym*  m_Syms;
-  size_t      m_MaxLen;
-  uint32_t    m_SymCount;
-  uint32_t    m_ReadIdx;
+  const char* m_End;
+  const char* m_Message; // why validation failed, with m_Cursor left on the offending byte
 };
 
 //---------------------------------------------------------------------------------
-bool gj_lexWhitespace( _gjLexContext* ctx )
+bool gj_failValidation( _gjValidateContext* ctx, const char* message )
 {
-  if ( *ctx->m_Cursor == ' '  ||
-       *ctx->m_Cursor == '\r' ||
-       *ctx->m_Cursor == '\n' ||
-       *ctx->m_Cursor == '\t' )
-  {
-    ctx->m_Cursor++;
-    return true;
-  }
-
+  ctx->m_Message = message;
   return false;
 }
 
 //---------------------------------------------------------------------------------
-_gjLexSym* gj_newSym( _gjLexContext* ctx )
+// Reading stops at the end or at a null terminator, so both read as '\0'
+inline char gj_peekValidateChar( const _gjValidateContext* ctx )
 {
-  if ( ctx->m_SymCount == ctx->m_MaxLen )
-  {
-    gj_assert( "ran out of space in lex syms. You may need to provide a larger max count in the initialization config for this data" );
-  }
-  return &ctx->m_Syms[ ctx->m_SymCount++ ];
+  return ctx->m_Cursor < ctx->m_End ? *ctx->m_Cursor : '\0';
 }
 
-
 //---------------------------------------------------------------------------------
-bool gj_lexOpenBrace( _gjLexContext* ctx )
+inline void gj_skipValidateWhitespace( _gjValidateContext* ctx )
 {
-  if ( *ctx->m_Cursor == '{' )
+  if ( ctx->m_Cursor < ctx->m_End && gj_isWhitespace( *ctx->m_Cursor ) )
   {
-    _gjLexSym* sym = gj_newSym( ctx );
-    sym->m_Str     = ctx->m_Cursor;
-    sym->m_StrLen  = 1;
-    sym->m_Type    = kSymOpenBrace;
-    ctx->m_Cursor++;
-    return true;
+    ctx->m_Cursor = s_SkipWhitespaceFn( ctx->m_Cursor + 1, ctx->m_End );
   }
-  return false;
 }
 
 //---------------------------------------------------------------------------------
-bool gj_lexClosedBrace( _gjLexContext* ctx )
+inline bool gj_isHexDigit( char c )
 {
-  if ( *ctx->m_Cursor == '}' )
-  {
-    _gjLexSym* sym = gj_newSym( ctx );
-    sym->m_Str     = ctx->m_Cursor;
-    sym->m_StrLen  = 1;
-    sym->m_Type    = kSymClosedBrace;
-    ctx->m_Cursor++;
-    return true;
-  }
-  return false;
+  return gj_isDigit( c ) || ( ( c | 0x20 ) >= 'a' && ( c | 0x20 ) <= 'f' );
 }
 
 //---------------------------------------------------------------------------------
-bool gj_lexComma( _gjLexContext* ctx )
+// Checks one utf-8 sequence at the cursor, whose lead byte is outside ascii. Overlong
+// forms, surrogates and anything past U+10FFFF are rejected by narrowing the range
+// of the first continuation byte, as in the table in RFC 3629.
+bool gj_validateUtf8( _gjValidateContext* ctx )
 {
-  if ( *ctx->m_Cursor == ',' )
+  const uint8_t* bytes = (const uint8_t*)ctx->m_Cursor;
+  const uint8_t  lead  = bytes[ 0 ];
+
+  uint32_t continuation_count = 0;
+  uint8_t  second_min         = 0x80;
+  uint8_t  second_max         = 0xbf;
+  if ( lead >= 0xc2 && lead <= 0xdf )
   {
-    _gjLexSym* sym   = gj_newSym( ctx );
-    sym->m_Str    = ctx->m_Cursor;
-    sym->m_StrLen = 1;
-    sym->m_Type   = kSymComma;
-    ctx->m_Cursor++;
-    return true;
+    continuation_count = 1;
   }
-  return false;
-}
-
-//---------------------------------------------------------------------------------
-bool gj_lexColon( _gjLexContext* ctx )
-{
-  if ( *ctx->m_Cursor == ':' )
+  else if ( lead >= 0xe0 && lead <= 0xef )
   {
-    _gjLexSym* sym = gj_newSym( ctx );
-    sym->m_Str     = ctx->m_Cursor;
-    sym->m_StrLen  = 1;
-    sym->m_Type    = kSymColon;
-    ctx->m_Cursor++;
-    return true;
+    continuation_count = 2;
+    second_min = lead == 0xe0 ? 0xa0 : 0x80;
+    second_max = lead == 0xed ? 0x9f : 0xbf;
   }
-  return false;
-}
-
-//---------------------------------------------------------------------------------
-bool gj_lexOpenBracket( _gjLexContext* ctx )
-{
-  if ( *ctx->m_Cursor == '[' )
+  else if ( lead >= 0xf0 && lead <= 0xf4 )
   {
-    _gjLexSym* sym = gj_newSym( ctx );
-    sym->m_Str     = ctx->m_Cursor;
-    sym->m_StrLen  = 1;
-    sym->m_Type    = kSymOpenBracket;
-    ctx->m_Cursor++;
-    return true;
+    continuation_count = 3;
+    second_min = lead == 0xf0 ? 0x90 : 0x80;
+    second_max = lead == 0xf4 ? 0x8f : 0xbf;
+  }
+  else
+  {
+    return gj_failValidation( ctx, "Invalid utf-8 lead byte" );
   }
-  return false;
-}
 
-//---------------------------------------------------------------------------------
-bool gj_lexClosedBracket( _gjLexContext* ctx )
-{
-  if ( *ctx->m_Cursor == ']' )
+  if ( (size_t)( ctx->m_End - ctx->m_Cursor ) <= continuation_count )
   {
-    _gjLexSym* sym = gj_newSym( ctx );
-    sym->m_Str     = ctx->m_Cursor;
-    sym->m_StrLen  = 1;
-    sym->m_Type    = kSymClosedBracket;
-    ctx->m_Cursor++;
-    return true;
+    return gj_failValidation( ctx, "Truncated utf-8 sequence" );
   }
-  return false;
-}
 
-//---------------------------------------------------------------------------------
-bool gj_lexString( _gjLexContext* ctx )
-{
-  if ( *ctx->m_Cursor == '"' )
+  if ( bytes[ 1 ] < second_min || bytes[ 1 ] > second_max )
   {
-    _gjLexSym* sym = gj_newSym( ctx );
-    sym->m_Str     = ctx->m_Cursor + 1;
-    sym->m_StrLen  = 0;
-    sym->m_Type    = kSymString;
-    ctx->m_Cursor++;
+    return gj_failValidation( ctx, "Invalid utf-8 sequence" );
+  }
 
-    while ( *ctx->m_Cursor != '"' || *(ctx->m_Cursor - 1) == '\\' )
+  for ( uint32_t i_byte = 2; i_byte <= continuation_count; ++i_byte )
+  {
+    if ( ( bytes[ i_byte ] & 0xc0 ) != 0x80 )
     {
-      sym->m_StrLen++;
-      ctx->m_Cursor++;
+      return gj_failValidation( ctx, "Invalid utf-8 sequence" );
     }
-
-    ctx->m_Cursor++;
-
-    return true;
   }
 
-  return false;
-}
-
-//---------------------------------------------------------------------------------
-bool gj_isDigit( char c )
-{
-  return c >= '0' && c <= '9';
+  ctx->m_Cursor += continuation_count + 1;
+  return true;
 }
 
 //---------------------------------------------------------------------------------
-bool gj_lexFloat( _gjLexContext* ctx )
+bool gj_validateEscape( _gjValidateContext* ctx )
 {
-  const char* cursor = ctx->m_Cursor;
-  if ( gj_isDigit( *ctx->m_Cursor ) || *ctx->m_Cursor == '-' )
+  // the cursor is on the backslash
+  const char* escape = ctx->m_Cursor + 1;
+  const char  code   = escape < ctx->m_End ? *escape : '\0';
+  switch ( code )
   {
-    bool has_point = false;
-    while ( gj_isDigit( *cursor )
-        || *cursor == '-'
-        || *cursor == '.'
-        || *cursor == 'e'
-        || *cursor == 'E' )
+    case '"':
+    case '\\':
+    case '/':
+    case 'b':
+    case 'f':
+    case 'n':
+    case 'r':
+    case 't':
     {
-      has_point |= (*cursor == '.');
-      cursor++;
+      ctx->m_Cursor += 2;
+      return true;
     }
-
-    if ( has_point )
+    case 'u':
     {
-      _gjLexSym* sym = gj_newSym( ctx );
-      sym->m_Str     = ctx->m_Cursor;
-      sym->m_StrLen  = (uint16_t)(cursor - ctx->m_Cursor);
-      sym->m_Type    = kSymFloat;
-      ctx->m_Cursor  = cursor;
+      if ( ctx->m_End - escape <= 4 )
+      {
+        return gj_failValidation( ctx, "Truncated \\u escape" );
+      }
+
+      for ( uint32_t i_digit = 1; i_digit <= 4; ++i_digit )
+      {
+        if ( gj_isHexDigit( escape[ i_digit ] ) == false )
+        {
+          return gj_failValidation( ctx, "Expected 4 hex digits in a \\u escape" );
+        }
+      }
+
+      ctx->m_Cursor += 6;
       return true;
     }
+    default:
+    {
+      return gj_failValidation( ctx, "Invalid escape sequence" );
+    }
   }
-
-  return false;
 }
 
 //---------------------------------------------------------------------------------
-bool gj_lexInt( _gjLexContext* ctx )
+bool gj_validateString( _gjValidateContext* ctx )
 {
-  char*   cursor  = nullptr;
-  int32_t integer = strtol( ctx->m_Cursor, &cursor, 10 );
+  // the cursor is on the opening quote
+  const char* string_start = ctx->m_Cursor++;
 
-  if ( integer != 0 || cursor != ctx->m_Cursor )
+  while ( true )
   {
-    if ( integer != LONG_MAX && integer != LONG_MIN )
+    ctx->m_Cursor = s_FindStringCheckFn( ctx->m_Cursor, ctx->m_End );
+
+    const char stop_char = gj_peekValidateChar( ctx );
+    if ( stop_char == '"' )
     {
-      _gjLexSym* sym = gj_newSym( ctx );
-      sym->m_Str     = ctx->m_Cursor;
-      sym->m_StrLen  = (uint16_t)( cursor - ctx->m_Cursor );
-      sym->m_Type    = kSymInt;
-      ctx->m_Cursor  = cursor;
+      ctx->m_Cursor++;
       return true;
     }
+    else if ( stop_char == '\\' )
+    {
+      if ( gj_validateEscape( ctx ) == false )
+      {
+        return false;
+      }
+    }
+    else if ( stop_char == '\0' )
+    {
+      ctx->m_Cursor = string_start;
+      return gj_failValidation( ctx, "Unterminated string" );
+    }
+    else if ( (uint8_t)stop_char < 0x20 )
+    {
+      return gj_failValidation( ctx, "Control characters in a string have to be escaped" );
+    }
+    else if ( gj_validateUtf8( ctx ) == false )
+    {
+      return false;
+    }
   }
-
-  return false;
 }
 
 //---------------------------------------------------------------------------------
-bool gj_lexU64( _gjLexContext* ctx )
+const char* gj_skipDigits( const char* cursor, const char* end )
 {
-  char*    cursor  = nullptr;
-  uint64_t integer = strtoull( ctx->m_Cursor, &cursor, 10 );
-
-  if ( integer != 0 || cursor != ctx->m_Cursor )
+  while ( cursor < end && gj_isDigit( *cursor ) )
   {
-    if ( integer != LLONG_MAX && integer != LLONG_MIN )
-    {
-      _gjLexSym* sym = gj_newSym( ctx );
-      sym->m_Str     = ctx->m_Cursor;
-      sym->m_StrLen  = (uint16_t)( cursor - ctx->m_Cursor );
-      sym->m_Type    = kSymU64;
-      ctx->m_Cursor  = cursor;
-      return true;
-    }
+    cursor++;
   }
-
-  return false;
+  return cursor;
 }
 
 //---------------------------------------------------------------------------------
-bool gj_lexBool( _gjLexContext* ctx )
+// -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+bool gj_validateNumber( _gjValidateContext* ctx )
 {
-  if ( strncmp( ctx->m_Cursor, "true", 4 ) == 0 )
+  if ( gj_peekValidateChar( ctx ) == '-' )
   {
-    _gjLexSym* sym = gj_newSym( ctx );
-    sym->m_Str     = ctx->m_Cursor;
-    sym->m_StrLen  = 4;
-    sym->m_Type    = kSymBool;
-    ctx->m_Cursor  += 4;
-    return true;
+    ctx->m_Cursor++;
   }
 
-  if ( strncmp( ctx->m_Cursor, "false", 5 ) == 0 )
+  if ( gj_isDigit( gj_peekValidateChar( ctx ) ) == false )
   {
-    _gjLexSym* sym = gj_newSym( ctx );
-    sym->m_Str     = ctx->m_Cursor;
-    sym->m_StrLen  = 5;
-    sym->m_Type    = kSymBool;
-    ctx->m_Cursor  += 5;
-    return true;
+    return gj_failValidation( ctx, "Expected a digit" );
   }
 
-  return false;
-}
-
-//---------------------------------------------------------------------------------
-bool gj_lexNull( _gjLexContext* ctx )
-{
-  if ( strncmp( ctx->m_Cursor, "null", 4 ) == 0 )
+  if ( *ctx->m_Cursor == '0' )
   {
-    _gjLexSym* sym = gj_newSym( ctx );
-    sym->m_Str     = ctx->m_Cursor;
-    sym->m_StrLen  = 4;
-    sym->m_Type    = kSymNull;
-    ctx->m_Cursor  += 4;
-    return true;
+    ctx->m_Cursor++;
+    if ( gj_isDigit( gj_peekValidateChar( ctx ) ) )
+    {
+      return gj_failValidation( ctx, "Numbers can't have leading zeros" );
+    }
   }
-
-  return false;
-}
-
-struct _gjAstNode;
-
-//---------------------------------------------------------------------------------
-struct _gjAstNodeMember
-{
-  char*    m_Key;
-  uint32_t m_ValueIdx;
-};
-
-//---------------------------------------------------------------------------------
-struct _gjAstNode
-{
-  enum NodeType : uint16_t
+  else
   {
-    kTypeObject,
-    kTypeMember,
-    kTypeArray,
-    kTypeString,
-    kTypeInt,
-    kTypeU64,
-    kTypeFloat,
-    kTypeBool,
-    kTypeNull
-  };
+    ctx->m_Cursor = gj_skipDigits( ctx->m_Cursor + 1, ctx->m_End );
+  }
 
-  union
+  if ( gj_peekValidateChar( ctx ) == '.' )
   {
-    uint32_t         m_ObjectStartIdx;
-    _gjAstNodeMember m_Member;
-    uint32_t         m_ArrayStartIdx;
-    char*            m_String;
-    int              m_Int;
-    uint64_t         m_U64;
-    float            m_Float;
-    bool             m_Bool;
-  };
-
-  uint32_t m_Next;
-  NodeType m_Type;
-};
-
-//---------------------------------------------------------------------------------
-static constexpr uint32_t kAstNodeTailIdx = (uint32_t)-1;
-
-//---------------------------------------------------------------------------------
-struct _gjAstContext
-{
-  _gjAstNode* m_Nodes;
-  uint32_t    m_NodeCount;
-  uint32_t    m_NodeHead;
-};
+    ctx->m_Cursor++;
+    if ( gj_isDigit( gj_peekValidateChar( ctx ) ) == false )
+    {
+      return gj_failValidation( ctx, "Expected a digit after the decimal point" );
+    }
+    ctx->m_Cursor = gj_skipDigits( ctx->m_Cursor + 1, ctx->m_End );
+  }
 
-//---------------------------------------------------------------------------------
-_gjAstNode* gj_allocAstNode( _gjAstContext* ctx, uint32_t* out_idx, uint32_t head = kAstNodeTailIdx )
-{
-  if ( ctx->m_NodeHead != kAstNodeTailIdx )
+  if ( ( gj_peekValidateChar( ctx ) | 0x20 ) == 'e' )
   {
-    if ( head == kAstNodeTailIdx )
+    ctx->m_Cursor++;
+    if ( gj_peekValidateChar( ctx ) == '+' || gj_peekValidateChar( ctx ) == '-' )
     {
-      *out_idx = ctx->m_NodeHead;
-      _gjAstNode* node = &ctx->m_Nodes[ ctx->m_NodeHead ];
-      ctx->m_NodeHead = node->m_Next;
-      node->m_Next = kAstNodeTailIdx;
-
-      return node;
+      ctx->m_Cursor++;
     }
-
-    _gjAstNode* prev_node = &ctx->m_Nodes[ head ];
-    while ( prev_node->m_Next != kAstNodeTailIdx )
+    if ( gj_isDigit( gj_peekValidateChar( ctx ) ) == false )
     {
-      prev_node = &ctx->m_Nodes[ prev_node->m_Next ];
+      return gj_failValidation( ctx, "Expected a digit in the exponent" );
     }
-
-    prev_node->m_Next = ctx->m_NodeHead;
-    *out_idx = prev_node->m_Next;
-    _gjAstNode* new_node = &ctx->m_Nodes[ prev_node->m_Next ];
-    ctx->m_NodeHead = new_node->m_Next;
-    new_node->m_Next = kAstNodeTailIdx;
-
-    return new_node;
+    ctx->m_Cursor = gj_skipDigits( ctx->m_Cursor + 1, ctx->m_End );
   }
 
-  return nullptr;
+  return true;
 }
 
 //---------------------------------------------------------------------------------
-uint32_t gj_parse( _gjLexContext* lex, _gjAstContext* ast );
-
-//---------------------------------------------------------------------------------
-uint32_t gj_parseMember( _gjLexContext* lex, _gjAstContext* ast )
+bool gj_validateLiteral( _gjValidateContext* ctx, const char* literal, size_t literal_len )
 {
-  _gjLexSym* key_str_sym = &lex->m_Syms[ lex->m_ReadIdx++ ];
-  if ( key_str_sym->m_Type != kSymString )
-  {
-    gj_assert( "Unexpected token!" );
-    return (uint32_t)-1;
-  }
-
-  uint32_t member_idx;
-  _gjAstNode* member_node = gj_allocAstNode( ast, &member_idx );
-  
-  member_node->m_Member.m_Key = (char*)gj_malloc( key_str_sym->m_StrLen + 1, "AST key string" );
-  memcpy( member_node->m_Member.m_Key, key_str_sym->m_Str, key_str_sym->m_StrLen );
-  member_node->m_Member.m_Key[ key_str_sym->m_StrLen ] = '\0';
-  
-  if ( lex->m_Syms[ lex->m_ReadIdx++ ].m_Type != kSymColon )
+  if ( (size_t)( ctx->m_End - ctx->m_Cursor ) < literal_len || memcmp( ctx->m_Cursor, literal, literal_len ) != 0 )
   {
-    gj_assert( "Unexpected token!" );
-    return (uint32_t)-1;
+    return gj_failValidation( ctx, "Invalid literal" );
   }
-  
-  member_node->m_Member.m_ValueIdx = gj_parse( lex, ast );
-  member_node->m_Next = kAstNodeTailIdx;
 
-  return member_idx;
+  ctx->m_Cursor += literal_len;
+  return true;
 }
 
 //---------------------------------------------------------------------------------
-bool gj_isSymValueType( _gjLexSymType type )
+bool gj_validateScalar( _gjValidateContext* ctx )
 {
-  return type == kSymBool        ||
-         type == kSymFloat       ||
-         type == kSymInt         ||
-         type == kSymU64         ||
-         type == kSymNull        ||
-         type == kSymOpenBrace   ||
-         type == kSymOpenBracket ||
-         type == kSymString;
+  const char first_char = gj_peekValidateChar( ctx );
+  switch ( first_char )
+  {
+    case '"':
+    {
+      return gj_validateString( ctx );
+    }
+    case 't':
+    {
+      return gj_validateLiteral( ctx, "true", 4 );
+    }
+    case 'f':
+    {
+      return gj_validateLiteral( ctx, "false", 5 );
+    }
+    case 'n':
+    {
+      return gj_validateLiteral( ctx, "null", 4 );
+    }
+    case '\0':
+    {
+      return gj_failValidation( ctx, "Unexpected end of the json data" );
+    }
+    default:
+    {
+      if ( first_char == '-' || gj_isDigit( first_char ) )
+      {
+        return gj_validateNumber( ctx );
+      }
+      return gj_failValidation( ctx, "Expected a value" );
+    }
+  }
 }
 
 //---------------------------------------------------------------------------------
-uint32_t gj_cStringLen( const char* json_str, uint32_t json_len )
+bool gj_validateKey( _gjValidateContext* ctx )
 {
-  uint32_t collapse_amt = 0;
-  for ( uint32_t i_char = 0; i_char < json_len; ++i_char )
+  gj_skipValidateWhitespace( ctx );
+  if ( gj_peekValidateChar( ctx ) != '"' )
   {
-    collapse_amt += json_str[ i_char + collapse_amt ] == '\\';
+    return gj_failValidation( ctx, "Expected a string for the member's key" );
   }
 
-  return json_len - collapse_amt;
-}
+  if ( gj_validateString( ctx ) == false )
+  {
+    return false;
+  }
 
-//---------------------------------------------------------------------------------
-// returns 0 for ok
-uint32_t gj_jsonToCString( char* c_string, uint32_t c_string_len, const char* json_str )
-{
-  // todo: vectorizable?
-  uint32_t offset_amt = 0;
-  for ( uint32_t i_char = 0; i_char < c_string_len + 1; ++i_char )
+  gj_skipValidateWhitespace( ctx );
+  if ( gj_peekValidateChar( ctx ) != ':' )
   {
-    const uint32_t i_char_src = i_char + offset_amt;
-    if (json_str[ i_char_src ] == '\\' )
-    {
-      offset_amt++;
-      switch (json_str[ i_char_src + 1 ] )
-      {
-        case '"': // These just grab the next char
-        case '\\':
-        case '/':
-        {
-          c_string[ i_char ] = json_str[ i_char_src + 1 ];
-        }
-        break;
-        case 'n':
-        {
-          c_string[ i_char ] = '\n';
-        }
-        break;
-        case 'r':
-        {
-          c_string[ i_char ] = '\r';
-        }
-        break;
-        case 't':
-        {
-          c_string[ i_char ] = '\t';
-        }
-        break;
-        case 'b':
-        {
-          c_string[ i_char ] = '\b';
-        }
-        break;
-        case 'f':
-        {
-          c_string[ i_char ] = '\f';
-        }
-        break;
-        default:
-        {
-          gj_assert( "error parsing string literal: unrecognized escape sequence" );
-          return (uint32_t)-1;
-        }
-      }
-    }
-    else
-    {
-      c_string[ i_char ] = json_str[ i_char_src ];
-    }
-  } 
+    return gj_failValidation( ctx, "Expected a ':' after the member's key" );
+  }
 
-  return 0;
+  ctx->m_Cursor++;
+  return true;
 }
 
 //---------------------------------------------------------------------------------
-// returns index into ast node array
-uint32_t gj_parse( _gjLexContext* lex, _gjAstContext* ast )
+static constexpr uint32_t kValidateStackWords = kGjMaxValidateDepth / 64;
+
+//---------------------------------------------------------------------------------
+// The same walk as gj_parseEvents, keeping only a bit per open container to say
+// whether it's an object, so the stack it needs doesn't depend on the data.
+bool gj_validateDocument( _gjValidateContext* ctx )
 {
-  if ( lex->m_ReadIdx < lex->m_SymCount )
+  uint64_t in_object[ kValidateStackWords ];
+  uint32_t depth = 0;
+
+  while ( true )
   {
-    _gjLexSym* sym = &lex->m_Syms[ lex->m_ReadIdx++ ];
-    switch ( sym->m_Type )
+    gj_skipValidateWhitespace( ctx );
+    const char open_char = gj_peekValidateChar( ctx );
+
+    if ( open_char == '{' || open_char == '[' )
     {
-      case kSymInt:
+      if ( depth == kGjMaxValidateDepth )
       {
-        uint32_t idx;
-        _gjAstNode* node = gj_allocAstNode( ast, &idx );
-        node->m_Type = _gjAstNode::kTypeInt;
-        node->m_Int  = strtol( sym->m_Str, nullptr, 10 );
-        return idx;
+        return gj_failValidation( ctx, "json data is nested too deeply to validate" );
       }
-      break;
-      case kSymU64:
+
+      const uint64_t level_bit = 1ull << ( depth % 64 );
+      if ( open_char == '{' )
       {
-        uint32_t idx;
-        _gjAstNode* node = gj_allocAstNode( ast, &idx );
-        node->m_Type = _gjAstNode::kTypeU64;
-        node->m_U64  = strtoull( sym->m_Str, nullptr, 10 );
-        return idx;
+        in_object[ depth / 64 ] |= level_bit;
       }
-      break;
-      case kSymFloat:
+      else
       {
-        uint32_t idx;
-        _gjAstNode* node = gj_allocAstNode( ast, &idx );
-        node->m_Type  = _gjAstNode::kTypeFloat;
-        node->m_Float = strtof( sym->m_Str, nullptr );
-        return idx;
+        in_object[ depth / 64 ] &= ~level_bit;
       }
-      break;
-      case kSymBool:
+      depth++;
+      ctx->m_Cursor++;
+
+      gj_skipValidateWhitespace( ctx );
+      if ( gj_peekValidateChar( ctx ) == ( open_char == '{' ? '}' : ']' ) )
       {
-        uint32_t idx;
-        _gjAstNode* node = gj_allocAstNode( ast, &idx );
-        node->m_Type  = _gjAstNode::kTypeBool;
-        node->m_Bool  = strncmp( sym->m_Str, "true", 4 ) == 0;
-        return idx;
+        depth--;
+        ctx->m_Cursor++;
       }
-      break;
-      case kSymString:
+      else if ( open_char == '{' )
       {
-        uint32_t idx;
-        _gjAstNode* node = gj_allocAstNode( ast, &idx );
-        node->m_Type   = _gjAstNode::kTypeString;
-
-      
-        const uint32_t c_string_len = gj_cStringLen( sym->m_Str, sym->m_StrLen );
-
-        node->m_String = (char*)gj_malloc( c_string_len + 1, "AST string value" );
-
-        if ( gj_jsonToCString( node->m_String, c_string_len, sym->m_Str ) != 0 )
+        if ( gj_validateKey( ctx ) == false )
         {
-          gj_free( node->m_String );
-          return (uint32_t)-1;
+          return false;
         }
-
-        node->m_String[ c_string_len ] = '\0';
-
-        return idx;
+        continue;
       }
-      break;
-      case kSymNull:
+      else
       {
-        uint32_t idx;
-        _gjAstNode* node = gj_allocAstNode( ast, &idx );
-        node->m_Type  = _gjAstNode::kTypeNull;
-        return idx;
+        continue;
       }
-      break;
-      case kSymOpenBrace:
-      {
-        uint32_t obj_idx;
-        _gjAstNode* obj_node = gj_allocAstNode( ast, &obj_idx );
-        obj_node->m_Type           = _gjAstNode::kTypeObject;
-        obj_node->m_ObjectStartIdx = kAstNodeTailIdx;
-
-        sym = &lex->m_Syms[ lex->m_ReadIdx ];
-        if (sym->m_Type == kSymString )
-        {
-          obj_node->m_ObjectStartIdx = gj_parseMember( lex, ast );
-          if ( obj_node->m_ObjectStartIdx == kAstNodeTailIdx)
-          {
-            return (uint32_t)-1;
-          }
-          _gjAstNode* prev_node = &ast->m_Nodes[ obj_node->m_ObjectStartIdx ];
+    }
+    else if ( gj_validateScalar( ctx ) == false )
+    {
+      return false;
+    }
 
-          sym = &lex->m_Syms[ lex->m_ReadIdx ];
-          while ( sym->m_Type == kSymComma )
-          {
-            lex->m_ReadIdx++;
-            prev_node->m_Next = gj_parseMember( lex, ast );
-          
-            if ( prev_node->m_Next == kAstNodeTailIdx)
-            {
-              return (uint32_t)-1;
-            }
-            prev_node = &ast->m_Nodes[ prev_node->m_Next ];
-            sym = &lex->m_Syms[ lex->m_ReadIdx ];
-          }
-        }
+    // the value is complete, so close containers until one has another value to come
+    bool has_next_value = false;
+    while ( depth > 0 && has_next_value == false )
+    {
+      gj_skipValidateWhitespace( ctx );
 
-        if ( sym->m_Type != kSymClosedBrace )
+      const bool is_object = ( in_object[ ( depth - 1 ) / 64 ] >> ( ( depth - 1 ) % 64 ) ) & 1;
+      const char next_char = gj_peekValidateChar( ctx );
+      if ( next_char == ',' )
+      {
+        ctx->m_Cursor++;
+        if ( is_object && gj_validateKey( ctx ) == false )
         {
-          gj_assert( "unrecognized token!" );
-          return (uint32_t)-1;
+          return false;
         }
-
-        lex->m_ReadIdx++;
-
-        return obj_idx;
+        has_next_value = true;
       }
-      break;
-      case kSymOpenBracket:
+      else if ( next_char == ( is_object ? '}' : ']' ) )
       {
-        uint32_t arr_idx;
-        _gjAstNode* arr_node      = gj_allocAstNode( ast, &arr_idx );
-        arr_node->m_Type          = _gjAstNode::kTypeArray;
-        arr_node->m_ArrayStartIdx = kAstNodeTailIdx;
-
-        sym = &lex->m_Syms[ lex->m_ReadIdx ];
-        if ( gj_isSymValueType( sym->m_Type ) )
-        {
-          arr_node->m_ArrayStartIdx = gj_parse( lex, ast );
-          _gjAstNode* prev_node = &ast->m_Nodes[ arr_node->m_ArrayStartIdx ];
-          prev_node->m_Next = kAstNodeTailIdx;
-
-          sym = &lex->m_Syms[ lex->m_ReadIdx++ ];
-          while ( sym->m_Type == kSymComma )
-          {
-            if ( gj_isSymValueType( lex->m_Syms[ lex->m_ReadIdx ].m_Type ) == false )
-            {
-              gj_assert( "unrecognized symbol!" );
-              return ( uint32_t )-1;
-            }
-
-            prev_node->m_Next = gj_parse( lex, ast );
-            prev_node = &ast->m_Nodes[ prev_node->m_Next ];
-            prev_node->m_Next = kAstNodeTailIdx;
-
-            sym = &lex->m_Syms[ lex->m_ReadIdx++ ];
-          }
-        }
-        else if ( sym->m_Type == kSymClosedBracket )
-        {
-          lex->m_ReadIdx++;
-        }
-
-        if ( sym->m_Type != kSymClosedBracket )
-        {
-          gj_assert( "unrecognized token!" );
-          return (uint32_t)-1;
-        }
-
-        return arr_idx;
-
+        depth--;
+        ctx->m_Cursor++;
+      }
+      else if ( next_char == '\0' )
+      {
+        return gj_failValidation( ctx, "Unexpected end of the json data" );
+      }
+      else
+      {
+        return gj_failValidation( ctx, is_object ? "Expected a ',' or '}' after the member" : "Expected a ',' or ']' after the element" );
       }
+    }
+
+    if ( has_next_value == false )
+    {
       break;
-      default:
-      gj_assert( "Unexpected token!" );
     }
   }
 
-  return (uint32_t)-1;
+  gj_skipValidateWhitespace( ctx );
+  if ( gj_peekValidateChar( ctx ) != '\0' )
+  {
+    return gj_failValidation( ctx, "Unexpected token after the end of the json data" );
+  }
+
+  return true;
 }
 
 //---------------------------------------------------------------------------------
-gjValue gj_astToValue( _gjAstContext* ast, uint32_t node_idx )
+// Lines are only counted once something has gone wrong, so valid data never pays for it
+void gj_locateParseError( const char* json_string, const char* error_at, const char* message, gjParseError* out_error )
 {
-  _gjAstNode* node = &ast->m_Nodes[ node_idx ];
-  switch ( node->m_Type )
+  size_t      line       = 1;
+  const char* line_start = json_string;
+  while ( const char* newline = (const char*)memchr( line_start, '\n', error_at - line_start ) )
   {
-    case _gjAstNode::kTypeString:
-    {
-      gjValue val = gjValue( node->m_String );
-      gj_free( node->m_String );
-      return val;
-    }
-    break;
-    case _gjAstNode::kTypeInt:
-    {
-      return gjValue( node->m_Int );
-    }
-    break;
-    case _gjAstNode::kTypeU64:
-    {
-      return gjValue( node->m_U64 );
-    }
-    break;
-    case _gjAstNode::kTypeFloat:
-    {
-      return gjValue( node->m_Float );
-    }
-    break;
-    case _gjAstNode::kTypeBool:
-    {
-      return gjValue( node->m_Bool );
-    }
-    break;
-    case _gjAstNode::kTypeNull:
-    {
-      return gjValue();
-    }
-    break;
-    case _gjAstNode::kTypeObject:
-    {
-      gjValue obj = gj_makeObject();
-      if ( node->m_ObjectStartIdx != kAstNodeTailIdx )
-      {
-        _gjAstNode* member_node = &ast->m_Nodes[ node->m_ObjectStartIdx ];
-        while ( member_node->m_Next != kAstNodeTailIdx )
-        {
-          char* key_str = member_node->m_Member.m_Key;
-
-          obj.addMember( key_str, gj_astToValue( ast, member_node->m_Member.m_ValueIdx ) );
-          gj_free( key_str );
-
-          member_node = &ast->m_Nodes[ member_node->m_Next ];
-        }
-
-        char* key_str = member_node->m_Member.m_Key;
-
-        obj.addMember( key_str, gj_astToValue( ast, member_node->m_Member.m_ValueIdx ) );
-        gj_free( key_str );
-      }
-
-      return obj;
-    }
-    break;
-    case _gjAstNode::kTypeMember:
-    {
-      gj_assert( "malformed ast! This is a bug in the library" );
-    }
-    break;
-    case _gjAstNode::kTypeArray:
-    {
-      gjValue arr = gj_makeArray();
-
-      if ( node->m_ArrayStartIdx != kAstNodeTailIdx )
-      {
-        uint32_t    elem_idx  = node->m_ArrayStartIdx;
-        _gjAstNode* elem_node = &ast->m_Nodes[ elem_idx ];
-        while ( elem_node->m_Next != kAstNodeTailIdx )
-        {
-          arr.insertElement( gj_astToValue( ast, elem_idx ) );
-          elem_idx  = elem_node->m_Next;
-          elem_node = &ast->m_Nodes[ elem_idx ];
-        }
-
-        arr.insertElement( gj_astToValue( ast, elem_idx ) );
-      }
-
-      return arr;
-    }
-    break;
+    line++;
+    line_start = newline + 1;
   }
 
-  return gjValue{};
+  out_error->m_Message = message;
+  out_error->m_Offset  = error_at - json_string;
+  out_error->m_Line    = line;
+  out_error->m_Column  = error_at - line_start + 1;
 }
 
 //---------------------------------------------------------------------------------
-gjValue gj_parse( const char* json_string, size_t string_len )
+bool gj_validate( const char* json_string, size_t string_len, gjParseError* out_error )
 {
-  // Start with lexing
-  _gjLexContext lex_ctx;
-  lex_ctx.m_Cursor   = json_string;
-  lex_ctx.m_MaxLen   = string_len;
-  lex_ctx.m_Syms     = (_gjLexSym*)gj_malloc( sizeof( *lex_ctx.m_Syms ) * lex_ctx.m_MaxLen, "Lexer scratch" );
-  lex_ctx.m_SymCount = 0;
-  lex_ctx.m_ReadIdx  = 0;
+  _gjValidateContext ctx;
+  ctx.m_Cursor  = json_string;
+  ctx.m_End     = json_string + string_len;
+  ctx.m_Message = nullptr;
 
-  while ( *lex_ctx.m_Cursor )
+  const bool is_valid = gj_validateDocument( &ctx );
+  if ( out_error != nullptr )
   {
-    const bool valid_lex = 
-       gj_lexWhitespace   ( &lex_ctx ) ||
-       gj_lexOpenBrace    ( &lex_ctx ) ||
-       gj_lexClosedBrace  ( &lex_ctx ) ||
-       gj_lexComma        ( &lex_ctx ) ||
-       gj_lexColon        ( &lex_ctx ) ||
-       gj_lexOpenBracket  ( &lex_ctx ) ||
-       gj_lexClosedBracket( &lex_ctx ) ||
-       gj_lexString       ( &lex_ctx ) ||
-       gj_lexFloat        ( &lex_ctx ) ||
-       gj_lexInt          ( &lex_ctx ) ||
-       gj_lexU64          ( &lex_ctx ) ||
-       gj_lexBool         ( &lex_ctx ) ||
-       gj_lexNull         ( &lex_ctx );
-
-    if ( valid_lex == false )
+    if ( is_valid )
     {
-      gj_free( lex_ctx.m_Syms );
-      gj_assert( "unrecognized format!" );
-      return gjValue{};
+      *out_error = gjParseError();
     }
-  }
-
-  // Now we do parsin
-  _gjAstContext ast_ctx;
-  ast_ctx.m_Nodes     = (_gjAstNode*)gj_malloc( sizeof( *ast_ctx.m_Nodes ) * lex_ctx.m_SymCount, "AST Node Scratch" );
-  ast_ctx.m_NodeCount = lex_ctx.m_SymCount;
-  ast_ctx.m_NodeHead  = 0;
-
-  for ( uint32_t i_node = 0; i_node < ast_ctx.m_NodeCount; ++i_node )
-  {
-    ast_ctx.m_Nodes[ i_node ].m_Next = i_node + 1;
-  }
-
-  if ( ast_ctx.m_NodeCount > 0 )
-  {
-    ast_ctx.m_Nodes[ ast_ctx.m_NodeCount - 1 ].m_Next = kAstNodeTailIdx;
-  }
-
-  if ( gj_parse( &lex_ctx, &ast_ctx ) == (uint32_t)-1 )
-  {
-    gj_free( lex_ctx.m_Syms );
-    for ( uint32_t i_node = 0; i_node < ast_ctx.m_NodeCount; ++i_node )
+    else
     {
-      _gjAstNode* node = &ast_ctx.m_Nodes[ i_node ];
-      if ( node->m_Type == _gjAstNode::kTypeString )
-      {
-        gj_free( node->m_String );
-      }
-      else if ( node->m_Type == _gjAstNode::kTypeMember )
-      {
-        gj_free( node->m_Member.m_Key );
-      }
+      gj_locateParseError( json_string, ctx.m_Cursor, ctx.m_Message, out_error );
     }
-    gj_free( ast_ctx.m_Nodes );
-    return gjValue{};
   }
 
-  gj_free( lex_ctx.m_Syms );
-
-  // Now we put in memory
-  gjValue value = gj_astToValue( &ast_ctx, 0 );
-
-  gj_free( ast_ctx.m_Nodes );
-
-  return value;
+  return is_valid;
 }
\ No newline at end of file
@@ -1,11 +1,32 @@
 #pragma once
 
 #include <stdint.h>
+#include <stdio.h>
 
 //---------------------------------------------------------------------------------
+enum class gjPoolGrowthPolicy : uint32_t
+{
+  kFixed,        // pools are allocated once by gj_init. Running out asserts
+  kGrowInChunks, // pools add growth_chunk_size entries at a time when they run out
+
+  kCount
+};
+
+//---------------------------------------------------------------------------------
+// Each pool is sized independently. Leaving max_array_elem_count or max_member_count
+// at 0 gives that pool max_value_count entries.
+// With kGrowInChunks, these are the initial sizes.
 struct gjConfig
 {
-  uint32_t max_value_count;
+  uint32_t           max_value_count;
+  uint32_t           max_array_elem_count;
+  uint32_t           max_member_count;
+  gjPoolGrowthPolicy growth_policy;
+  uint32_t           growth_chunk_size; // rounded up to a power of two, 64 minimum
+  bool               lazy_pool_init;    // skips clearing the pools in gj_init, so pages are only touched when first used
+  uint32_t           member_index_threshold; // a member lookup that walks past this many members gives the object a hash index. 0 never does
+  uint32_t           max_depth;              // parsing fails on a container nested deeper than this, before making it. 0 allows any depth
+  size_t             serialize_cache_budget; // bytes gjSerializers with cache_subtrees may keep to reuse the text of unchanged subtrees. 0 turns it off
 };
 
 //---------------------------------------------------------------------------------
@@ -36,6 +57,7 @@ enum class gjValueType : uint8_t
 
 //---------------------------------------------------------------------------------
 struct gjObjectMember;
+class  gjMembers;
 
 //---------------------------------------------------------------------------------
 class gjMemberIterator
@@ -133,10 +155,49 @@ struct gjValue
 
 //---------------------------------------------------------------------------------
 gjValue     gj_parse        ( const char* json_string, size_t string_len );
+// Unescapes strings and keys in place in json_buffer, which the values then point
+// into instead of making copies. The buffer must outlive the returned value.
+gjValue     gj_parseInsitu  ( char* json_buffer, size_t buffer_len );
+// Maps the file read-only and parses straight from the mapping, so it's never copied
+// into a buffer of its own. Returns an invalid value if the file can't be opened.
+gjValue     gj_parseFile    ( const char* path );
+// Parses newline-delimited JSON (one document per line) on thread_count threads, or
+// one per core when 0, and returns an array of the documents in input order. Blank
+// lines are skipped and lines that fail to parse become null. The allocator and assert
+// functions are called from every thread, and nothing else may use goodjson until
+// this returns.
+gjValue     gj_parseLines   ( const char* json_lines, size_t lines_len, uint32_t thread_count = 0 );
+// Parses a document whose root is an array on thread_count threads, or one per core
+// when 0, by splitting it into its elements. Builds the same value gj_parse would, and
+// comes with the same threading rules as gj_parseLines. Any other document is parsed
+// on the calling thread.
+gjValue     gj_parseParallel( const char* json_string, size_t string_len, uint32_t thread_count = 0 );
 gjValue     gj_makeArray    ();
 gjValue     gj_makeObject   ();
 void        gj_deleteValue  ( gjValue val );
 
+//---------------------------------------------------------------------------------
+// Parses a document that arrives in pieces into the same values gj_parse builds.
+// Chunks can split the text anywhere. The parser only holds on to its nesting and
+// to the part of a string or number that runs across a chunk boundary, so its memory
+// doesn't grow with the size of the document. Once the last chunk is fed, finish()
+// returns the root, or an invalid value if the data was malformed or incomplete, and
+// the parser is ready for another document.
+class gjStreamParser
+{
+public:
+  gjStreamParser ();
+  ~gjStreamParser();
+
+  bool    feed  ( const char* chunk, size_t chunk_len ); // returns false once the data is known to be malformed
+  gjValue finish();
+private:
+  gjStreamParser            ( const gjStreamParser& ) = delete;
+  gjStreamParser& operator= ( const gjStreamParser& ) = delete;
+
+  struct _gjStreamParser* m_Parser;
+};
+
 //---------------------------------------------------------------------------------
 class gjMembers
 {
@@ -185,6 +246,7 @@ struct gjSerializeOptions
   gjSerializeMode mode;
   gjNewlineStyle  newline_style;
   int             indent_amt;
+  bool            cache_subtrees; // gjSerializer only. Reuses the text of subtrees that haven't changed since its last serialize, see gjConfig::serialize_cache_budget
 };
 
 gjSerializeOptions gj_getDefaultSerializeOptions();
@@ -197,13 +259,209 @@ public:
   ~gjSerializer();
 
   void        serialize();
+  // Makes the same text as serialize() on thread_count threads, or one per core when 0.
+  // It splits the children of the first container down from the root that has more
+  // than one, so it pays off for big arrays and objects. Doesn't use cache_subtrees.
+  // The allocator and assert functions are called from every thread, and the value
+  // must not change until this returns.
+  void        serializeParallel( uint32_t thread_count = 0 );
   const char* getString();
 private:
+  void        serializeCached();
+
   gjValue            m_Obj;
   gjSerializeOptions m_Options;
   char*              m_StringData;
+  size_t             m_StringLen;
+  size_t             m_CacheBytes;  // what m_StringData counts against the cache budget, 0 when the cache can't use it
+  uint32_t           m_CacheOwner;  // tells this serializer's cached text apart from other serializers'
+};
+
+//---------------------------------------------------------------------------------
+// Where a gjStreamSerializer sends its output. write is called each time the buffer
+// fills, and once more with whatever is left at the end. Returning false stops the
+// serialize.
+typedef bool (*gjSinkWriteFn)( const char* data, size_t data_len, void* user_data );
+
+struct gjSink
+{
+  gjSinkWriteFn write;
+  void*         user_data;
+};
+
+//---------------------------------------------------------------------------------
+// Appends to memory you own. A write that doesn't fit in capacity fails, leaving
+// length at what was written before it.
+struct gjMemorySink
+{
+  char*  data;
+  size_t capacity;
+  size_t length;
 };
 
+gjSink gj_makeMemorySink( gjMemorySink* memory );
+gjSink gj_makeFileSink  ( FILE* file );
+gjSink gj_makeFdSink    ( int fd );
+
+//---------------------------------------------------------------------------------
+// Serializes in a single walk of the tree through a fixed size buffer, so memory use
+// is bounded by buffer_size rather than by the size of the output. The output is
+// the same text gjSerializer makes. The buffer is allocated on the first serialize
+// and reused by the ones after it.
+static constexpr size_t kGjDefaultStreamBufferSize = 64 * 1024;
+static constexpr size_t kGjMinStreamBufferSize     = 64;
+class gjStreamSerializer
+{
+public:
+  gjStreamSerializer ( gjSerializeOptions* options = nullptr, size_t buffer_size = kGjDefaultStreamBufferSize );
+  ~gjStreamSerializer();
+
+  // returns false if the sink failed or the value has been freed
+  bool serialize( gjValue value, const gjSink* sink );
+
+  gjStreamSerializer            ( const gjStreamSerializer& ) = delete;
+  gjStreamSerializer& operator= ( const gjStreamSerializer& ) = delete;
+private:
+  gjSerializeOptions m_Options;
+  char*              m_Buffer;
+  size_t             m_BufferSize;
+};
+
+//---------------------------------------------------------------------------------
+//
+// Lazy documents
+//
+//---------------------------------------------------------------------------------
+// A gjLazyValue points into the json text and reads it on demand, so nothing is
+// allocated or decoded until it's asked for. Containers that are stepped over are
+// skipped by matching brackets and aren't checked against the full grammar.
+// The text must outlive the lazy values read from it.
+struct gjLazyValue
+{
+  const char* cursor; // Do not edit these
+  const char* end;    // Do not edit these
+
+              gjLazyValue();
+
+  gjLazyValue operator[]     ( uint32_t elem_idx ) const;
+  gjLazyValue operator[]     ( const char* key ) const;
+
+  bool        isValid        () const; // false for a missing member, element or a parse error
+  gjValueType getType        () const;
+
+  int         getInt         () const;
+  uint64_t    getU64         () const;
+  float       getFloat       () const;
+  bool        getBool        () const;
+  // Copies the unescaped string into out_str, truncating it to fit.
+  // returns the full length of the string, not counting the terminator
+  uint32_t    copyString     ( char* out_str, uint32_t out_str_len ) const;
+
+  // Parses this value and everything under it into the pools
+  gjValue     materialize    () const;
+
+  // This is for arrays, not objects. Each of these walks the array from the start
+  uint32_t    getElementCount() const;
+  gjLazyValue getElement     ( uint32_t elem_idx ) const;
+  // For an array element, returns the element after it, or an invalid value at the end
+  gjLazyValue getNextElement () const;
+
+  // This is for objects, not arrays. Each of these walks the object from the start
+  uint32_t    getMemberCount () const;
+  gjLazyValue getMember      ( const char* key ) const;
+  bool        hasMember      ( const char* key ) const;
+};
+
+//---------------------------------------------------------------------------------
+// Reading stops at string_len or at a null terminator, whichever comes first
+class gjLazyDoc
+{
+public:
+  gjLazyDoc( const char* json_string, size_t string_len );
+
+  gjLazyValue getRoot() const;
+private:
+  const char* m_Json;
+  const char* m_End;
+};
+
+//---------------------------------------------------------------------------------
+//
+// Projection parsing
+//
+//---------------------------------------------------------------------------------
+// Parses only the values the paths lead to, and skips everything else the way lazy
+// documents do, without allocating anything for it. Paths are json pointers, like
+// "/data/items/*/id", where "*" matches every element of an array or member of an
+// object, and "" is the whole document. Objects keep just the members on a path and
+// arrays just the elements, in order. A value a path steps into that isn't an object
+// or array comes back as null. Returns an invalid value if the data was malformed.
+gjValue gj_parseProjected( const char* json_string, size_t string_len, const char* const* paths, uint32_t path_count );
+
+//---------------------------------------------------------------------------------
+//
+// Event parsing
+//
+//---------------------------------------------------------------------------------
+// Each callback gets a pointer into the json text and its length. Strings and keys
+// are the text between the quotes, still escaped, and gj_unescapeString can decode
+// them. Numbers, bools and nulls are the token as written, and the start and end of
+// a container are its bracket. Return false to stop parsing. Callbacks left null are
+// skipped.
+typedef bool (*gjEventFn)( const char* text, size_t text_len, void* user_data );
+
+//---------------------------------------------------------------------------------
+struct gjEventHandler
+{
+  gjEventFn onStartObject;
+  gjEventFn onEndObject;
+  gjEventFn onStartArray;
+  gjEventFn onEndArray;
+  gjEventFn onKey;
+  gjEventFn onString;
+  gjEventFn onNumber;
+  gjEventFn onBool;
+  gjEventFn onNull;
+  void*     user_data;
+};
+
+//---------------------------------------------------------------------------------
+static constexpr uint32_t kGjMaxEventDepth = 1024;
+
+// Reports the document to handler as it's read, without building any values or
+// allocating anything, so it doesn't use the pools. Nesting is limited to
+// kGjMaxEventDepth levels. Reading stops at string_len or at a null terminator.
+// returns false if the data is malformed or a callback stopped it
+bool     gj_parseEvents   ( const char* json_string, size_t string_len, const gjEventHandler* handler );
+// Copies the unescaped string into out_str, truncating it to fit. \u escapes come out
+// as utf-8. returns the full length of the string, not counting the terminator
+uint32_t gj_unescapeString( const char* text, size_t text_len, char* out_str, uint32_t out_str_len );
+
+//---------------------------------------------------------------------------------
+//
+// Validation
+//
+//---------------------------------------------------------------------------------
+// Where and why validation failed. Lines and columns count from 1, and columns are
+// in bytes. Everything is zero and m_Message is null when the data was valid.
+struct gjParseError
+{
+  const char* m_Message;
+  size_t      m_Offset;
+  size_t      m_Line;
+  size_t      m_Column;
+};
+
+//---------------------------------------------------------------------------------
+static constexpr uint32_t kGjMaxValidateDepth = 4096;
+
+// Checks the data is well formed json as RFC 8259 defines it, including that strings
+// are valid utf-8 with valid escapes and no raw control characters. It doesn't
+// allocate, doesn't assert and doesn't use the pools, so it can be called before
+// gj_init, and its stack use is fixed, which limits nesting to kGjMaxValidateDepth
+// levels. Reading stops at string_len or at a null terminator. out_error can be null.
+bool gj_validate( const char* json_string, size_t string_len, gjParseError* out_error );
+
 //---------------------------------------------------------------------------------
 // 
 // Allocator customization
@@ -229,14 +487,20 @@ void gj_setAssertFn ( gjAssertFn assert_fn );
 // Usage stats
 //
 //---------------------------------------------------------------------------------
+// The peak counts are the most entries each pool has had in use at once since gj_init
 struct gjUsageStats
 {
   uint32_t m_UsedValues;
   uint32_t m_FreeValues;
+  uint32_t m_PeakValues;
   uint32_t m_UsedArrayElements;
   uint32_t m_FreeArrayElements;
+  uint32_t m_PeakArrayElements;
   uint32_t m_UsedObjectMembers;
   uint32_t m_FreeObjectMembers;
+  uint32_t m_PeakObjectMembers;
+  size_t   m_SerializeCacheBytes;
+  size_t   m_PeakSerializeCacheBytes;
 };
 
 gjUsageStats gj_getUsageStats();
\ No newline at end of file